@@ -15,14 +15,15 @@
 #include "dogm_7036.h"
 
 #define INITLEN 8
-byte init_DOGM081_3V[INITLEN] = {0x31, 0x14, 0x55, 0x6D, 0x75, 0x30, 0x01, 0x06};
-byte init_DOGM081_5V[INITLEN] = {0x31, 0x1C, 0x51, 0x6A, 0x74, 0x30, 0x01, 0x06};
+// init values in flash, they are only read once
+const byte init_DOGM081_3V[INITLEN] PROGMEM = {0x31, 0x14, 0x55, 0x6D, 0x75, 0x30, 0x01, 0x06};
+const byte init_DOGM081_5V[INITLEN] PROGMEM = {0x31, 0x1C, 0x51, 0x6A, 0x74, 0x30, 0x01, 0x06};
 
-byte init_DOGM162_3V[INITLEN] = {0x39, 0x14, 0x55, 0x6D, 0x78, 0x38, 0x01, 0x06};
-byte init_DOGM162_5V[INITLEN] = {0x39, 0x1C, 0x52, 0x69, 0x74, 0x38, 0x01, 0x06};
+const byte init_DOGM162_3V[INITLEN] PROGMEM = {0x39, 0x14, 0x55, 0x6D, 0x78, 0x38, 0x01, 0x06};
+const byte init_DOGM162_5V[INITLEN] PROGMEM = {0x39, 0x1C, 0x52, 0x69, 0x74, 0x38, 0x01, 0x06};
 
-byte init_DOGM163_3V[INITLEN] = {0x39, 0x15, 0x55, 0x6E, 0x72, 0x38, 0x01, 0x06};
-byte init_DOGM163_5V[INITLEN] = {0x39, 0x1D, 0x50, 0x6C, 0x7C, 0x38, 0x01, 0x06};
+const byte init_DOGM163_3V[INITLEN] PROGMEM = {0x39, 0x15, 0x55, 0x6E, 0x72, 0x38, 0x01, 0x06};
+const byte init_DOGM163_5V[INITLEN] PROGMEM = {0x39, 0x1D, 0x50, 0x6C, 0x7C, 0x38, 0x01, 0x06};
 
 //------------------------------------------------public Functions----------------------------------------------------
 // Please use these functions in your sketch
@@ -33,7 +34,7 @@ Desc: Initializes SPI Hardware/Software and DOG Displays
 Vars: CS-Pin, MOSI-Pin, SCK-Pin (MOSI=SCK Hardware else Software), RS-Pin, Reset-Pin, 5V = true / 3.3V = false, lines
 ------------------------------*/
 void dogm_7036::initialize(byte p_cs, byte p_si, byte p_clk, byte p_rs, byte p_res, boolean sup_5V, byte lines) {
-  byte *ptr_init;   // pointer to the correct init values
+  const byte *ptr_init;   // pointer to the correct init values (PROGMEM)
   byte i;
 
   cursor = 0x0C;   // Display on/off control status at power on reset, needed for cursor on/off and Display on/off
@@ -47,7 +48,7 @@ void dogm_7036::initialize(byte p_cs, byte p_si, byte p_clk, byte p_rs, byte p_r
   pinModeFast(p_res, OUTPUT);
   delayMicroseconds(10);
   digitalWriteFast(p_res, HIGH);
-  delay(5);
+  delayMicroseconds(5000);   // no delay(): Timer0 overflow interrupt is off with RTC_TIMEBASE
 
   // Init DOGM-Text displays, depending on users choice of supply voltages and lines
   ptr_init = init_DOGM162_3V;   // default pointer for wrong parameters
@@ -62,7 +63,7 @@ void dogm_7036::initialize(byte p_cs, byte p_si, byte p_clk, byte p_rs, byte p_r
   displ_lines = lines;   // set position
 
   digitalWriteFast(p_rs, LOW);
-  for (i = 0; i < INITLEN; i++) command(*ptr_init++);
+  for (i = 0; i < INITLEN; i++) command(pgm_read_byte(ptr_init++));
 
   displ_onoff(true);     // Display on
   cursor_onoff(false);   // Cursor off
@@ -192,7 +193,7 @@ void dogm_7036::command(byte dat) {
   digitalWriteFast(p_rs, LOW);
   spi_put_byte(dat);
   if (dat <= 0x03)   // return home or clear display need 1.08 ms
-    delay(1);
+    delayMicroseconds(1080);
   else delayMicroseconds(30);   // all other commands need 26 us
 }
 
@@ -6,11 +6,28 @@
 /// @date 2022-05-01
 /// @version 1.0
 ///
+/// @date 2022-11-05
+/// Burst read/write of consecutive registers added.
+///
+/// @date 2023-01-07
+/// enableSw1Hz() clears the rate select bits RS2:RS1 (power-on value 8.192kHz).
+///
+/// @date 2023-01-21
+/// enable32kHz() added.
+///
+/// @date 2023-01-28
+/// Daily alarms on the INT/SQW pin.
+///
+/// @date 2023-02-11
+/// setTimer() (alarm 1 in n seconds) and setCalibration() (aging offset) for the RTC interface.
+///
 /// @copyright Copyright (c) 2022
 ///
 //////////////////////////////////////////////////////////////////////////////
 
 #include "DS3231Wire.h"
+#include "bcdconv.hpp"
+#include "timecalc.hpp"
 
 namespace DS3231 {
 //////////////////////////////////////////////////////////////////////////////
@@ -19,8 +36,8 @@ namespace DS3231 {
 //////////////////////////////////////////////////////////////////////////////
 void enableSw1Hz(void) {
   uint8_t data = readRegister(CONTROL);
-  data &= 0xF8;   // set to 1Hz
-  data |= 0x40;   // enable square wave
+  data &= ~0x1C;   // INTCN = 0 (square wave output), RS2 = RS1 = 0 (1Hz)
+  data |= 0x40;    // enable square wave
   writeRegister(CONTROL, data);
 }
 
@@ -45,6 +62,88 @@ void disable32kHz() {
   writeRegister(CTL_STATUS, data);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches the 32kHz signal on (EN32kHz), e.g. as clock for a timer.
+///
+//////////////////////////////////////////////////////////////////////////////
+void enable32kHz() {
+  uint8_t data = readRegister(CTL_STATUS);
+  data |= 0x08;
+  writeRegister(CTL_STATUS, data);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets alarm 1 to a time of the day (every day, A1M4 = 1).
+///
+/// @param bcdHours
+/// @param bcdMinutes
+/// @param bcdSeconds
+//////////////////////////////////////////////////////////////////////////////
+void setAlarm1(uint8_t bcdHours, uint8_t bcdMinutes, uint8_t bcdSeconds) {
+  const uint8_t data[]{bcdSeconds, bcdMinutes, bcdHours, ALARM_MASK};
+  writeRegisters(ALARM1_SECONDS, data, sizeof(data));
+}
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets alarm 2 to a time of the day (every day, A2M4 = 1). Alarm 2
+///        has no seconds, it matches at second 00.
+///
+/// @param bcdHours
+/// @param bcdMinutes
+//////////////////////////////////////////////////////////////////////////////
+void setAlarm2(uint8_t bcdHours, uint8_t bcdMinutes) {
+  const uint8_t data[]{bcdMinutes, bcdHours, ALARM_MASK};
+  writeRegisters(ALARM2_MINUTES, data, sizeof(data));
+}
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets alarm 1 to the time of the day that is seconds away.
+///
+/// @param seconds       Time until the alarm (< 1 day)
+/// @param secondOfDay   RTC time of the day now
+//////////////////////////////////////////////////////////////////////////////
+void setTimer(uint16_t seconds, uint32_t secondOfDay) {
+  uint32_t at = (secondOfDay + seconds) % TimeCalc::SECONDS_PER_DAY;
+  setAlarm1(BCDConv::decToBcd(at / TimeCalc::SECONDS_PER_HOUR),
+            BCDConv::decToBcd(at / TimeCalc::SECONDS_PER_MINUTE % TimeCalc::MINUTES_PER_HOUR),
+            BCDConv::decToBcd(at % TimeCalc::SECONDS_PER_MINUTE));
+}
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches the INT/SQW pin from the square wave to the alarm
+///        interrupt (INTCN = 1). The pin goes LOW when an enabled alarm
+///        matches and stays LOW until clearAlarms(). Old alarm flags are
+///        cleared. enableSw1Hz() switches back to the square wave.
+///
+/// @param alarms   ALARM1 | ALARM2
+//////////////////////////////////////////////////////////////////////////////
+void enableAlarms(uint8_t alarms) {
+  clearAlarms();
+  uint8_t data = readRegister(CONTROL);
+  data &= ~(ALARM1 | ALARM2);
+  data |= 0x04 | (alarms & (ALARM1 | ALARM2));   // INTCN = 1
+  writeRegister(CONTROL, data);
+}
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Clears the alarm flags. The INT/SQW pin is released (HIGH).
+///
+/// @return uint8_t   Alarms that had occurred (ALARM1 | ALARM2)
+//////////////////////////////////////////////////////////////////////////////
+uint8_t clearAlarms() {
+  uint8_t data = readRegister(CTL_STATUS);
+  if (data & (ALARM1 | ALARM2)) { writeRegister(CTL_STATUS, data & ~(ALARM1 | ALARM2)); }
+  return data & (ALARM1 | ALARM2);
+}
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Compensates the rate error of the oscillator with the aging
+///        offset (about 0.1 ppm per LSB). A positive value slows the
+///        oscillator. It takes effect with the next temperature
+///        conversion (at most 64 s).
+///
+/// @param tenthPpm   Measured rate error in 0.1 ppm, positive if the RTC runs fast
+//////////////////////////////////////////////////////////////////////////////
+void setCalibration(int16_t tenthPpm) {
+  if (tenthPpm > INT8_MAX) { tenthPpm = INT8_MAX; }
+  if (tenthPpm < INT8_MIN) { tenthPpm = INT8_MIN; }
+  writeRegister(AGING_OFFSET, static_cast<uint8_t>(tenthPpm));
+}
 //////////////////////////////////////////////////////////////////////////////
 /// @brief Reads the content of an RTC register via I2C
 ///
@@ -72,6 +171,39 @@ void writeRegister(uint8_t reg, uint8_t data) {
   Wire.endTransmission();         // Completes the transaction by sending stop bit
 }
 
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Reads consecutive RTC registers with one I2C transfer.
+///        The DS3231 copies all time registers to its read buffer at the
+///        start of the transfer, so the values are consistent.
+///
+/// @param reg    First register address
+/// @param data   Destination buffer
+/// @param len    Number of registers to read
+//////////////////////////////////////////////////////////////////////////////
+void readRegisters(uint8_t reg, uint8_t *data, uint8_t len) {
+  Wire.beginTransmission(ADDR);
+  Wire.write(reg);
+  Wire.endTransmission();
+  Wire.requestFrom(ADDR, len);
+  while (len--) { *data++ = Wire.read(); }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Writes consecutive RTC registers with one I2C transfer.
+///        If the transfer starts with the SECONDS register, the countdown
+///        chain of the RTC is reset when the seconds byte is acknowledged.
+///
+/// @param reg    First register address
+/// @param data   Values to write
+/// @param len    Number of registers to write
+//////////////////////////////////////////////////////////////////////////////
+void writeRegisters(uint8_t reg, const uint8_t *data, uint8_t len) {
+  Wire.beginTransmission(ADDR);
+  Wire.write(reg);
+  Wire.write(data, len);
+  Wire.endTransmission();
+}
+
 //////////////////////////////////////////////////////////////////////////////
 /// @brief Set the time
 ///
@@ -6,6 +6,20 @@
 /// @date 2022-05-01
 /// @version 1.0
 ///
+/// @date 2022-11-05
+/// Burst read/write of consecutive registers added.
+///
+/// @date 2023-01-21
+/// enable32kHz() added (time base for the DCF77 pulse timing).
+///
+/// @date 2023-01-28
+/// Daily alarms (setAlarm1(), setAlarm2()) on the INT/SQW pin instead of the square wave
+/// (enableAlarms(), clearAlarms()).
+///
+/// @date 2023-02-11
+/// Backend of the RTC interface (lib/rtc): readTime(), writeTime(), enable1Hz(), setTimer(),
+/// setDailyAlarm(), setCalibration() (aging offset).
+///
 /// @copyright Copyright (c) 2022
 ///
 //////////////////////////////////////////////////////////////////////////////
@@ -32,28 +46,57 @@ constexpr uint8_t CEN_MONTH{0x05};   // toggles if Year 99 switches to 00 -> 1-1
 constexpr uint8_t YEAR{0x06};        // Year 00 - 99
 constexpr uint8_t CONTROL{0x0e};
 constexpr uint8_t CTL_STATUS{0x0f};
+constexpr uint8_t TIME_REGS{7};      // SECONDS ... YEAR, read/written in one burst
+constexpr uint8_t ALARM1_SECONDS{0x07};
+constexpr uint8_t ALARM1_MINUTES{0x08};
+constexpr uint8_t ALARM1_HOURS{0x09};
+constexpr uint8_t ALARM1_DAY_DATE{0x0a};
+constexpr uint8_t ALARM2_MINUTES{0x0b};
+constexpr uint8_t ALARM2_HOURS{0x0c};
+constexpr uint8_t ALARM2_DAY_DATE{0x0d};
 
+// Alarm bits: A1IE/A2IE in CONTROL, A1F/A2F in CTL_STATUS
+constexpr uint8_t ALARM1{0x01};
+constexpr uint8_t ALARM2{0x02};
+constexpr uint8_t ALARM_MASK{0x80};   // AxMy: the register is not compared
+
+constexpr uint8_t AGING_OFFSET{0x10};   // Two's complement, about 0.1 ppm per LSB at 25 degree C
 /* uncomment if you want to use...
-constexpr uint8_t ALARM1_SECONDS  {0x07};
-constexpr uint8_t ALARM1_MINUTES  {0x08};
-constexpr uint8_t ALARM1_HOURS    {0x09};
-constexpr uint8_t ALARM1_DAY_DATE {0x0a};
-constexpr uint8_t ALARM2_MINUTES  {0x0b};
-constexpr uint8_t ALARM2_HOURS    {0x0c};
-constexpr uint8_t ALARM2_DAY_DATE {0x0d};
-constexpr uint8_t AGING_OFFSET    {0x10};
 constexpr uint8_t TEMP_MSB        {0x11};
 constexpr uint8_t TEMP_LSB        {0x12};
 */
 
+// RTC interface (lib/rtc)
+constexpr uint8_t MONTH{CEN_MONTH};
+constexpr uint8_t MONTH_MASK{0x1F};   // Without the century bit
+constexpr uint8_t ALARM_TIMER{ALARM1};
+constexpr uint8_t ALARM_DAILY{ALARM2};
+constexpr bool TICK_RISING{true};     // SQW falls at the start of the second and rises in the middle of it
+
 void enableSw1Hz(void);
 void disableSw(void);
 void disable32kHz(void);
+void enable32kHz(void);
+void setAlarm1(uint8_t bcdHours, uint8_t bcdMinutes, uint8_t bcdSeconds);
+void setAlarm2(uint8_t bcdHours, uint8_t bcdMinutes);
+void enableAlarms(uint8_t alarms);
+uint8_t clearAlarms(void);
 uint8_t readRegister(uint8_t reg);
 void writeRegister(uint8_t reg, uint8_t data);
+void readRegisters(uint8_t reg, uint8_t *data, uint8_t len);
+void writeRegisters(uint8_t reg, const uint8_t *data, uint8_t len);
 void setTime(uint8_t bcdHours, uint8_t bcdMinutes, uint8_t bcdSeconds);
 void setDate(uint8_t bcdYear, uint8_t bcdMonth, uint8_t bcdDayofMonth);
 void setDateTime(uint8_t bcdYear, uint8_t bcdMonth, uint8_t bcdDayofMonth, uint8_t bcdHours, uint8_t bcdMinutes,
                  uint8_t bcdSeconds);
+void setTimer(uint16_t seconds, uint32_t secondOfDay);
+void setCalibration(int16_t tenthPpm);
+
+inline void readTime(uint8_t *data, uint8_t len) { readRegisters(SECONDS, data, len); }
+inline void writeTime(const uint8_t *data) { writeRegisters(SECONDS, data, TIME_REGS); }
+inline void enable1Hz() { enableSw1Hz(); }
+inline void setDailyAlarm(uint8_t bcdHours, uint8_t bcdMinutes) { setAlarm2(bcdHours, bcdMinutes); }
+// Time from the start of the RTC second to the counted edge of the 1Hz signal
+inline uint32_t tickPhase(uint32_t periodMicros) { return periodMicros >> 1; }
 }   // namespace DS3231
 #endif
\ No newline at end of file
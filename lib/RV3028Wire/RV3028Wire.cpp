@@ -0,0 +1,263 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file RV3028Wire.cpp
+/// @author Kai R.
+/// @brief Communication with the RV-3028-C7 RT clock
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include "RV3028Wire.h"
+
+namespace {
+// STATUS
+constexpr uint8_t STATUS_EEBUSY{0x80};
+constexpr uint8_t STATUS_TF{0x08};
+constexpr uint8_t STATUS_AF{0x04};
+// CONTROL1
+constexpr uint8_t CONTROL1_WADA{0x20};   // Alarm on the date instead of the weekday
+constexpr uint8_t CONTROL1_USEL{0x10};   // Time update every minute instead of every second
+constexpr uint8_t CONTROL1_EERD{0x08};   // No automatic refresh from the EEPROM
+constexpr uint8_t CONTROL1_TE{0x04};     // Countdown timer enabled
+constexpr uint8_t CONTROL1_TD{0x03};     // Timer clock
+constexpr uint8_t TD_1HZ{0x02};
+constexpr uint8_t TD_1_60HZ{0x03};
+// CONTROL2
+constexpr uint8_t CONTROL2_UIE{0x20};
+constexpr uint8_t CONTROL2_TIE{0x10};
+constexpr uint8_t CONTROL2_AIE{0x08};
+constexpr uint8_t CONTROL2_RESET{0x01};   // Resets the prescaler, cleared by the RTC
+// EE_CLKOUT
+constexpr uint8_t CLKOUT_CLKOE{0x80};
+constexpr uint8_t CLKOUT_FD{0x07};        // FD = 0: 32.768 kHz
+// EE_COMMAND
+constexpr uint8_t EE_CMD_FIRST{0x00};
+constexpr uint8_t EE_CMD_UPDATE{0x11};    // All configuration registers RAM -> EEPROM
+constexpr uint8_t EE_BACKUP_OFFSET0{0x80};
+
+constexpr int32_t OFFSET_STEP{9537};   // One offset step in 0.001 ppm
+constexpr int16_t OFFSET_MAX{255};     // 9 bit two's complement
+constexpr uint16_t TIMER_MAX{4095};    // 12 bit countdown timer
+constexpr uint8_t SECONDS_PER_MINUTE{60};
+constexpr uint8_t DAYS_PER_WEEK{7};
+
+uint8_t control2{0};   // Copy of CONTROL2: writeTime() sets RESET without reading it first
+
+void writeControl2(uint8_t data) {
+  control2 = data;
+  RV3028::writeRegister(RV3028::CONTROL2, data);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Writes configuration registers (RAM mirrors of the EEPROM) and
+///        stores them in the EEPROM if they have changed. The automatic
+///        refresh from the EEPROM is off during the update. Takes about
+///        10 ms if the EEPROM is written.
+///
+/// @param reg    First register (EE_CLKOUT ... EE_BACKUP)
+/// @param mask   Bits to change in every register
+/// @param data   New values
+/// @param len
+//////////////////////////////////////////////////////////////////////////////
+void writeConfig(uint8_t reg, const uint8_t *mask, const uint8_t *data, uint8_t len) {
+  uint8_t config[3];
+  RV3028::readRegisters(reg, config, len);
+  bool changed = false;
+  for (uint8_t i = 0; i < len; ++i) {
+    uint8_t value = (config[i] & ~mask[i]) | (data[i] & mask[i]);
+    if (value != config[i]) { changed = true; }
+    config[i] = value;
+  }
+  if (!changed) { return; }
+  uint8_t control1 = RV3028::readRegister(RV3028::CONTROL1);
+  RV3028::writeRegister(RV3028::CONTROL1, control1 | CONTROL1_EERD);
+  RV3028::writeRegisters(reg, config, len);
+  RV3028::writeRegister(RV3028::EE_COMMAND, EE_CMD_FIRST);
+  RV3028::writeRegister(RV3028::EE_COMMAND, EE_CMD_UPDATE);
+  while (RV3028::readRegister(RV3028::STATUS) & STATUS_EEBUSY) {}
+  RV3028::writeRegister(RV3028::CONTROL1, control1 & ~CONTROL1_EERD);
+}
+
+void writeConfig(uint8_t reg, uint8_t mask, uint8_t data) { writeConfig(reg, &mask, &data, 1); }
+}   // namespace
+
+namespace RV3028 {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches the 1Hz signal on INT on (periodic time update every
+///        second). The alarm interrupts are disabled. Must be called before
+///        the other functions that write CONTROL2.
+///
+//////////////////////////////////////////////////////////////////////////////
+void enable1Hz() {
+  uint8_t data = readRegister(CONTROL1);
+  if (data & CONTROL1_USEL) { writeRegister(CONTROL1, data & ~CONTROL1_USEL); }
+  writeControl2((readRegister(CONTROL2) & ~(CONTROL2_TIE | CONTROL2_AIE)) | CONTROL2_UIE);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief CLKOUT is on at power-on (32.768 kHz, EEPROM default). With this
+///        function the output is switched off (LOW).
+///
+//////////////////////////////////////////////////////////////////////////////
+void disable32kHz() { writeConfig(EE_CLKOUT, CLKOUT_CLKOE | CLKOUT_FD, 0); }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches the 32.768 kHz signal on CLKOUT on, e.g. as clock for a timer.
+///
+//////////////////////////////////////////////////////////////////////////////
+void enable32kHz() { writeConfig(EE_CLKOUT, CLKOUT_CLKOE | CLKOUT_FD, CLKOUT_CLKOE); }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Starts the countdown timer (single mode). Up to 4095 s it counts
+///        seconds, above it counts minutes: the alarm comes up to 59 s
+///        late (the receiver is switched on later, never sooner).
+///
+/// @param seconds       Time until the alarm
+/// @param secondOfDay   Not needed (DS3231: alarm time)
+//////////////////////////////////////////////////////////////////////////////
+void setTimer(uint16_t seconds, uint32_t) {
+  uint8_t clock = TD_1HZ;
+  if (seconds > TIMER_MAX) {
+    seconds = (seconds + SECONDS_PER_MINUTE - 1) / SECONDS_PER_MINUTE;
+    clock = TD_1_60HZ;
+  }
+  uint8_t data = readRegister(CONTROL1) & ~(CONTROL1_TE | CONTROL1_TD);
+  writeRegister(CONTROL1, data);   // The value is loaded when TE is set
+  const uint8_t value[]{static_cast<uint8_t>(seconds), static_cast<uint8_t>(seconds >> 8)};
+  writeRegisters(TIMER_VALUE_0, value, sizeof(value));
+  writeRegister(CONTROL1, data | CONTROL1_TE | clock);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the alarm to a time of the day (every day, AE_WD = 1). The
+///        alarm matches at second 00.
+///
+/// @param bcdHours
+/// @param bcdMinutes
+//////////////////////////////////////////////////////////////////////////////
+void setDailyAlarm(uint8_t bcdHours, uint8_t bcdMinutes) {
+  const uint8_t data[]{bcdMinutes, bcdHours, ALARM_MASK};
+  writeRegisters(ALARM_MINUTES, data, sizeof(data));
+  uint8_t control1 = readRegister(CONTROL1);
+  if (control1 & CONTROL1_WADA) { writeRegister(CONTROL1, control1 & ~CONTROL1_WADA); }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches INT from the 1Hz signal to the alarm interrupts. The pin
+///        goes LOW when an enabled alarm occurs and stays LOW until
+///        clearAlarms(). Old alarm flags are cleared. enable1Hz() switches
+///        back to the 1Hz signal.
+///
+/// @param alarms   ALARM_TIMER | ALARM_DAILY
+//////////////////////////////////////////////////////////////////////////////
+void enableAlarms(uint8_t alarms) {
+  clearAlarms();
+  uint8_t data = control2 & ~(CONTROL2_UIE | CONTROL2_TIE | CONTROL2_AIE);
+  if (alarms & ALARM_TIMER) { data |= CONTROL2_TIE; }
+  if (alarms & ALARM_DAILY) { data |= CONTROL2_AIE; }
+  writeControl2(data);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Clears the alarm flags. INT is released (HIGH).
+///
+/// @return uint8_t   Alarms that had occurred (ALARM_TIMER | ALARM_DAILY)
+//////////////////////////////////////////////////////////////////////////////
+uint8_t clearAlarms() {
+  uint8_t data = readRegister(STATUS);
+  if (data & (STATUS_TF | STATUS_AF)) { writeRegister(STATUS, data & ~(STATUS_TF | STATUS_AF)); }
+  return ((data & STATUS_TF) ? ALARM_TIMER : 0) | ((data & STATUS_AF) ? ALARM_DAILY : 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Compensates the rate error of the crystal with the offset
+///        register (9 bit, 0.9537 ppm per step). The value is stored in the
+///        EEPROM.
+///
+/// @param tenthPpm   Measured rate error in 0.1 ppm, positive if the RTC runs fast
+//////////////////////////////////////////////////////////////////////////////
+void setCalibration(int16_t tenthPpm) {
+  int32_t scaled = tenthPpm * INT32_C(100);
+  int16_t offset = static_cast<int16_t>((scaled + (scaled < 0 ? -OFFSET_STEP : OFFSET_STEP) / 2) / OFFSET_STEP);
+  if (offset > OFFSET_MAX) { offset = OFFSET_MAX; }
+  if (offset < -OFFSET_MAX - 1) { offset = -OFFSET_MAX - 1; }
+  const uint8_t mask[]{0xFF, EE_BACKUP_OFFSET0};
+  const uint8_t data[]{static_cast<uint8_t>(static_cast<uint16_t>(offset) >> 1),
+                       static_cast<uint8_t>((offset & 1) << 7)};
+  writeConfig(EE_OFFSET, mask, data, sizeof(data));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Writes the time registers with one burst. The prescaler is reset
+///        before, the new second starts with the write. The day of the week
+///        1-7 (DCF77, DS3231) is written as 0-6 (Sunday = 0).
+///
+/// @param data   SECONDS ... YEAR
+//////////////////////////////////////////////////////////////////////////////
+void writeTime(const uint8_t *data) {
+  writeRegister(CONTROL2, control2 | CONTROL2_RESET);
+  Wire.beginTransmission(ADDR);
+  Wire.write(SECONDS);
+  for (uint8_t i = 0; i < TIME_REGS; ++i) { Wire.write(i == DAY ? data[i] % DAYS_PER_WEEK : data[i]); }
+  Wire.endTransmission();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Reads the content of an RTC register via I2C
+///
+/// @param reg Registeraddress
+/// @return uint8_t
+//////////////////////////////////////////////////////////////////////////////
+uint8_t readRegister(uint8_t reg) {
+  Wire.beginTransmission(ADDR);
+  Wire.write(reg);
+  Wire.endTransmission();
+  Wire.requestFrom(ADDR, ONE_BYTE);
+  return Wire.read();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Writes a value to an RTC register via I2C
+///
+/// @param reg Registeraddress
+/// @param data Value
+//////////////////////////////////////////////////////////////////////////////
+void writeRegister(uint8_t reg, uint8_t data) {
+  Wire.beginTransmission(ADDR);
+  Wire.write(reg);
+  Wire.write(data);
+  Wire.endTransmission();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Reads consecutive RTC registers with one I2C transfer.
+///
+/// @param reg    First register address
+/// @param data   Destination buffer
+/// @param len    Number of registers to read
+//////////////////////////////////////////////////////////////////////////////
+void readRegisters(uint8_t reg, uint8_t *data, uint8_t len) {
+  Wire.beginTransmission(ADDR);
+  Wire.write(reg);
+  Wire.endTransmission();
+  Wire.requestFrom(ADDR, len);
+  while (len--) { *data++ = Wire.read(); }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Writes consecutive RTC registers with one I2C transfer.
+///
+/// @param reg    First register address
+/// @param data   Values to write
+/// @param len    Number of registers to write
+//////////////////////////////////////////////////////////////////////////////
+void writeRegisters(uint8_t reg, const uint8_t *data, uint8_t len) {
+  Wire.beginTransmission(ADDR);
+  Wire.write(reg);
+  Wire.write(data, len);
+  Wire.endTransmission();
+}
+}   // namespace RV3028
@@ -0,0 +1,87 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file RV3028Wire.h
+/// @author Kai R.
+/// @brief Communication with the RV-3028-C7 RT clock (backend of lib/rtc,
+///        build flag RTC_RV3028).
+///        The RV-3028 draws about 45 nA (DS3231: about 100 uA). The time
+///        registers have the same layout as on the DS3231 (BCD, 24h mode).
+///        Wiring: INT (open drain) -> pin 3 (instead of INT/SQW), CLKOUT ->
+///        PD5 (T1) only with RTC_TIMEBASE.
+///        - 1Hz signal: periodic time update interrupt (UIE, USEL = 0). INT
+///          pulses LOW at the start of every second (tRTN, about 8 ms), the
+///          falling edge is counted.
+///        - Alarms on INT (LOW until clearAlarms()): the countdown timer
+///          (setTimer(), 1 Hz, above 4095 s 1/60 Hz) and the alarm (minutes
+///          and hours, setDailyAlarm(); the RV-3028 has no alarm seconds).
+///        - The configuration registers CLKOUT, OFFSET and BACKUP are RAM
+///          mirrors of the EEPROM, which are refreshed from the EEPROM once a
+///          day. They are written to the EEPROM when they are changed.
+///        - Writing the time does not reset the prescaler. writeTime() sets
+///          the RESET bit before the burst, so the new second starts with
+///          the write as on the DS3231.
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _RV3028_WIRE_H
+#define _RV3028_WIRE_H
+
+#include <Wire.h>
+
+namespace RV3028 {
+constexpr uint8_t ONE_BYTE{1};
+constexpr uint8_t ADDR{0x52};
+
+// RV-3028 Registers
+constexpr uint8_t SECONDS{0x00};   // 00-59
+constexpr uint8_t MINUTES{0x01};   // 00-59
+constexpr uint8_t HOURS{0x02};     // 00-23
+constexpr uint8_t DAY{0x03};       // Day of Week 0-6
+constexpr uint8_t DATE{0x04};      // Day of Month 1 - 31
+constexpr uint8_t MONTH{0x05};     // 1-12
+constexpr uint8_t YEAR{0x06};      // Year 00 - 99
+constexpr uint8_t TIME_REGS{7};    // SECONDS ... YEAR, read/written in one burst
+constexpr uint8_t ALARM_MINUTES{0x07};
+constexpr uint8_t ALARM_HOURS{0x08};
+constexpr uint8_t ALARM_DAY_DATE{0x09};
+constexpr uint8_t TIMER_VALUE_0{0x0A};   // Countdown timer, bits 7:0
+constexpr uint8_t TIMER_VALUE_1{0x0B};   // Bits 11:8
+constexpr uint8_t STATUS{0x0E};
+constexpr uint8_t CONTROL1{0x0F};
+constexpr uint8_t CONTROL2{0x10};
+constexpr uint8_t EE_COMMAND{0x27};
+constexpr uint8_t EE_CLKOUT{0x35};   // RAM mirrors of the EEPROM configuration
+constexpr uint8_t EE_OFFSET{0x36};   // Offset bits 8:1
+constexpr uint8_t EE_BACKUP{0x37};   // Bit 7: offset bit 0
+
+constexpr uint8_t ALARM_MASK{0x80};   // AE_x: the register is not compared
+
+// RTC interface (lib/rtc)
+constexpr uint8_t MONTH_MASK{0x1F};
+constexpr uint8_t ALARM_TIMER{0x01};
+constexpr uint8_t ALARM_DAILY{0x02};
+constexpr bool TICK_RISING{false};   // INT falls at the start of the second
+
+void enable1Hz(void);
+void disable32kHz(void);
+void enable32kHz(void);
+void setTimer(uint16_t seconds, uint32_t secondOfDay);
+void setDailyAlarm(uint8_t bcdHours, uint8_t bcdMinutes);
+void enableAlarms(uint8_t alarms);
+uint8_t clearAlarms(void);
+void setCalibration(int16_t tenthPpm);
+void writeTime(const uint8_t *data);
+uint8_t readRegister(uint8_t reg);
+void writeRegister(uint8_t reg, uint8_t data);
+void readRegisters(uint8_t reg, uint8_t *data, uint8_t len);
+void writeRegisters(uint8_t reg, const uint8_t *data, uint8_t len);
+
+inline void readTime(uint8_t *data, uint8_t len) { readRegisters(SECONDS, data, len); }
+// Time from the start of the RTC second to the counted edge of the 1Hz signal
+inline uint32_t tickPhase(uint32_t) { return 0; }
+}   // namespace RV3028
+#endif
@@ -0,0 +1,49 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file battery.cpp
+/// @author Kai R.
+/// @brief Supply voltage measurement with the internal bandgap reference.
+///
+/// @date 2023-02-04
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <avr/power.h>
+#include "battery.hpp"
+
+namespace {
+constexpr uint8_t MUX_BANDGAP{0x0E};     // ADC input: internal bandgap reference
+constexpr uint16_t SETTLE_MICROS{1000};   // Start-up of the bandgap, charging of the AREF capacitor
+constexpr uint8_t SAMPLES{4};
+
+uint16_t convert() {
+  ADCSRA |= bit(ADSC);
+  while (ADCSRA & bit(ADSC)) {}
+  return ADC;
+}
+}   // namespace
+
+namespace Battery {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Measures the supply voltage. Takes about 1.5 ms. Must not be
+///        called with a boosted clock (lib/cpuclock): the ADC clock is
+///        set for 1 MHz (prescaler 8 = 125 kHz).
+///
+/// @return uint16_t  VCC in mV
+//////////////////////////////////////////////////////////////////////////////
+uint16_t readVcc() {
+  power_adc_enable();
+  ADMUX = bit(REFS0) | MUX_BANDGAP;                // Reference AVCC
+  ADCSRA = bit(ADEN) | bit(ADPS1) | bit(ADPS0);   // Prescaler 8
+  delayMicroseconds(SETTLE_MICROS);
+  convert();   // The first conversion after switching the input is not accurate
+  uint16_t sum = 0;
+  for (uint8_t i = 0; i < SAMPLES; ++i) { sum += convert(); }
+  ADCSRA = 0;
+  power_adc_disable();
+  return BANDGAP_MV * 1024 * SAMPLES / sum;
+}
+}   // namespace Battery
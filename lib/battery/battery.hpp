@@ -0,0 +1,36 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file battery.hpp
+/// @author Kai R.
+/// @brief Declaration of the supply voltage measurement.
+///        The ADC measures the internal bandgap reference (1.1 V, ATmega8:
+///        1.3 V) with AVCC as reference: VCC = VBG * 1024 / ADC. No pin and
+///        no external divider are needed. The ADC is switched on only for
+///        the measurement (about 1 ms), otherwise it stays off as set in
+///        optimizePowerConsumption() (PRR).
+///        The bandgap voltage varies from chip to chip by up to 10 %.
+///        BANDGAP_MV can be calibrated with a voltmeter:
+///        BANDGAP_MV * measured VCC / readVcc().
+///
+/// @date 2023-02-04
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _BATTERY_HPP_
+#define _BATTERY_HPP_
+
+#include <stdint.h>
+
+namespace Battery {
+#if defined(__AVR_ATmega8__)
+constexpr uint32_t BANDGAP_MV{1300};
+#else
+constexpr uint32_t BANDGAP_MV{1100};
+#endif
+
+uint16_t readVcc(void);
+}   // namespace Battery
+
+#endif
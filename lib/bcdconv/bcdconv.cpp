@@ -7,28 +7,15 @@
 /// @date 2022-05-22
 /// @version 1.0
 ///
+/// @date 2022-11-12
+/// bcdToDec() and decToBcd() moved to bcdconv.hpp (constexpr).
+///
 /// @copyright Copyright (c) 2022
 ///
 //////////////////////////////////////////////////////////////////////////////
 #include "bcdconv.hpp"
 
 namespace BCDConv {
-//////////////////////////////////////////////////////////////////////////////
-/// @brief Converts a bcd value to a decimal value
-///
-/// @param bcd
-/// @return uint8_t
-//////////////////////////////////////////////////////////////////////////////
-uint8_t bcdToDec(uint8_t bcd) { return bcd - 6 * (bcd >> 4); }
-
-//////////////////////////////////////////////////////////////////////////////
-/// @brief Converts an decimal value to a bcd value
-///
-/// @param dec
-/// @return uint8_t
-//////////////////////////////////////////////////////////////////////////////
-uint8_t decToBcd(uint8_t dec) { return (dec + 6 * (dec / 10)); }
-
 //////////////////////////////////////////////////////////////////////////////
 /// @brief copies an 8-bit BDC number to a string of two ASCII characters.
 ///        No string end character is written!
@@ -37,7 +24,7 @@ uint8_t decToBcd(uint8_t dec) { return (dec + 6 * (dec / 10)); }
 /// @param bcdVal
 //////////////////////////////////////////////////////////////////////////////
 void bcdTochar(char *const str, const char bcdVal) {
-  *(str) = (bcdVal >> 4) + 0x30;
+  *(str) = (static_cast<uint8_t>(bcdVal) >> 4) + 0x30;   // char is signed: 0x80-0x99 must not be sign extended
   *(str + 1) = (bcdVal & 0x0F) + 0x30;
 }
 }   // namespace BCDConv
@@ -7,6 +7,10 @@
 /// @date 2022-05-22
 /// @version 1.0
 ///
+/// @date 2022-11-12
+/// bcdToDec() and decToBcd() are constexpr and inline. They are shared by
+/// the DCF77 decoder, the RTC code and the time calculations (timecalc).
+///
 /// @copyright Copyright (c) 2022
 ///
 //////////////////////////////////////////////////////////////////////////////
@@ -16,8 +20,22 @@
 
 #include <stdint.h>
 namespace BCDConv {
-uint8_t bcdToDec(uint8_t);
-uint8_t decToBcd(uint8_t);
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Converts a bcd value to a decimal value
+///
+/// @param bcd
+/// @return uint8_t
+//////////////////////////////////////////////////////////////////////////////
+constexpr uint8_t bcdToDec(uint8_t bcd) { return bcd - 6 * (bcd >> 4); }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Converts an decimal value to a bcd value
+///
+/// @param dec
+/// @return uint8_t
+//////////////////////////////////////////////////////////////////////////////
+constexpr uint8_t decToBcd(uint8_t dec) { return (dec + 6 * (dec / 10)); }
+
 void bcdTochar(char *const, const char);
 }   // namespace BCDConv
 #endif
@@ -0,0 +1,161 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file buttons.cpp
+/// @author Kai R.
+/// @brief Interrupt driven buttons (pin change interrupt + watchdog timer).
+///
+/// @date 2022-11-26
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <avr/wdt.h>
+#include "buttons.hpp"
+
+namespace Btn {
+ButtonIRQ *ButtonIRQ::_buttons[MAX_BUTTONS]{nullptr};
+uint8_t ButtonIRQ::_count{0};
+volatile bool ButtonIRQ::_wdtRunning{false};
+void (*ButtonIRQ::_onEvent)(void){nullptr};
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Set the pin to input with pullup (button switches to GND) and
+///        enable the pin change interrupt of the pin.
+///        The ISR of the pin change interrupt must call pinChange().
+///
+//////////////////////////////////////////////////////////////////////////////
+void ButtonIRQ::begin() {
+  if (_count >= MAX_BUTTONS) { return; }
+  pinMode(_pin, INPUT_PULLUP);
+  _pinReg = portInputRegister(digitalPinToPort(_pin));
+  _mask = digitalPinToBitMask(_pin);
+  _buttons[_count++] = this;
+  *digitalPinToPCMSK(_pin) |= bit(digitalPinToPCMSKbit(_pin));
+  *digitalPinToPCICR(_pin) |= bit(digitalPinToPCICRbit(_pin));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the result of the last press and resets it.
+///
+/// @return ButtonState   notPressed, shortPressed or longPressed
+//////////////////////////////////////////////////////////////////////////////
+ButtonState ButtonIRQ::tick() {
+  noInterrupts();
+  ButtonState state = _state;
+  _state = ButtonState::notPressed;
+  interrupts();
+  return state;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns true while the button is pressed (debounced).
+///
+//////////////////////////////////////////////////////////////////////////////
+bool ButtonIRQ::isActive() const { return _phase != Phase::RELEASED; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets a function that is called (in the ISR!) when a button has
+///        been pressed or released.
+///
+/// @param onEvent  Function or nullptr
+//////////////////////////////////////////////////////////////////////////////
+void ButtonIRQ::setEventCallback(void (*onEvent)(void)) { _onEvent = onEvent; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Must be called by the pin change ISR. If a button has been
+///        pressed, the watchdog timer is started for debouncing.
+///
+//////////////////////////////////////////////////////////////////////////////
+void ButtonIRQ::pinChange() {
+  if (_wdtRunning) { return; }
+  for (uint8_t i = 0; i < _count; ++i) {
+    if (_buttons[i]->isLow()) {
+      startWdt();
+      return;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Called every TICK_MS by the watchdog interrupt. Updates all
+///        buttons and stops the watchdog if they are all released.
+///
+//////////////////////////////////////////////////////////////////////////////
+void ButtonIRQ::wdtTick() {
+  bool active = false;
+  bool event = false;
+  for (uint8_t i = 0; i < _count; ++i) {
+    event |= _buttons[i]->update();
+    active |= _buttons[i]->isActive() || _buttons[i]->_debounce;
+  }
+  if (!active) { stopWdt(); }
+  if (event && _onEvent) { _onEvent(); }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns true while a button is debounced or pressed.
+///
+//////////////////////////////////////////////////////////////////////////////
+bool ButtonIRQ::busy() { return _wdtRunning; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Debouncing and classification of one button.
+///
+/// @return true    A new result (short/long pressed) is available.
+//////////////////////////////////////////////////////////////////////////////
+bool ButtonIRQ::update() {
+  // A change of the level must be stable for DEBOUNCE_TICKS.
+  if (isLow() == (_phase == Phase::RELEASED)) {
+    if (++_debounce < DEBOUNCE_TICKS) { return false; }
+  } else {
+    _debounce = 0;
+    if (_phase == Phase::PRESSED && ++_ticks >= LONG_PRESS_TICKS) {
+      _phase = Phase::HELD;
+      _state = ButtonState::longPressed;
+      return true;
+    }
+    return false;
+  }
+
+  _debounce = 0;
+  switch (_phase) {
+    case Phase::RELEASED:
+      _phase = Phase::PRESSED;
+      _ticks = DEBOUNCE_TICKS;
+      return false;
+    case Phase::PRESSED:
+      _phase = Phase::RELEASED;
+      _state = ButtonState::shortPressed;
+      return true;
+    default: _phase = Phase::RELEASED; return false;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Watchdog timer in interrupt mode (no reset), period 16ms.
+///
+//////////////////////////////////////////////////////////////////////////////
+void ButtonIRQ::startWdt() {
+  uint8_t sreg = SREG;
+  cli();
+  wdt_reset();
+  WDTCSR = bit(WDCE) | bit(WDE);   // Timed sequence: the next write must follow within 4 cycles
+  WDTCSR = bit(WDIE);
+  _wdtRunning = true;
+  SREG = sreg;
+}
+
+void ButtonIRQ::stopWdt() {
+  uint8_t sreg = SREG;
+  cli();
+  wdt_reset();
+  WDTCSR = bit(WDCE) | bit(WDE);
+  WDTCSR = 0x00;
+  _wdtRunning = false;
+  SREG = sreg;
+}
+}   // namespace Btn
+
+ISR(WDT_vect) { Btn::ButtonIRQ::wdtTick(); }
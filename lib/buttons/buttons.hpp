@@ -0,0 +1,77 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file buttons.hpp
+/// @author Kai R.
+/// @brief Declaration of interrupt driven buttons.
+///        A pin change interrupt starts the watchdog timer (interrupt mode,
+///        16ms). The watchdog interrupt debounces the buttons and classifies
+///        short and long presses. When all buttons are released the watchdog
+///        is stopped again, so there are no wake-ups while no button is touched.
+///
+///        The results are the same as with Button_SL:
+///        shortPressed  button released before LONG_PRESS_TIME
+///        longPressed   button held for LONG_PRESS_TIME (reported while it is still held)
+///        Every press is reported once by tick().
+///
+/// @date 2022-11-26
+/// @version 1.0
+///
+/// @date 2023-02-18
+/// _phase and _debounce are volatile: they are written by the interrupts and read by
+/// isActive()/busy() in the main loop.
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _BUTTONS_HPP_
+#define _BUTTONS_HPP_
+
+#include <stdint.h>
+
+namespace Btn {
+enum class ButtonState : uint8_t { notPressed, shortPressed, longPressed };
+
+constexpr uint8_t MAX_BUTTONS{2};
+constexpr uint8_t TICK_MS{16};                                 // Watchdog interrupt period
+constexpr uint8_t DEBOUNCE_TICKS{2};                           // Level must be stable for 2 ticks (32ms)
+constexpr uint16_t LONG_PRESS_TIME{1000};                      // ms
+constexpr uint8_t LONG_PRESS_TICKS{LONG_PRESS_TIME / TICK_MS};
+
+class ButtonIRQ {
+private:
+  enum class Phase : uint8_t { RELEASED, PRESSED, HELD };
+
+  static ButtonIRQ *_buttons[MAX_BUTTONS];
+  static uint8_t _count;
+  static volatile bool _wdtRunning;
+  static void (*_onEvent)(void);
+
+  volatile uint8_t *_pinReg{nullptr};
+  uint8_t _pin;
+  uint8_t _mask{0};
+  volatile uint8_t _debounce{0};
+  uint8_t _ticks{0};
+  volatile Phase _phase{Phase::RELEASED};
+  volatile ButtonState _state{ButtonState::notPressed};
+
+  bool isLow(void) const { return !(*_pinReg & _mask); }
+  bool update(void);
+  static void startWdt(void);
+  static void stopWdt(void);
+
+public:
+  ButtonIRQ(uint8_t pin) : _pin(pin) {}
+  ButtonIRQ(const ButtonIRQ &) = delete;              // prevent copy
+  ButtonIRQ &operator=(const ButtonIRQ &) = delete;   // prevent assignment
+
+  void begin(void);
+  ButtonState tick(void);
+  bool isActive(void) const;
+
+  static void setEventCallback(void (*)(void));
+  static void pinChange(void);
+  static void wdtTick(void);
+  static bool busy(void);
+};
+}   // namespace Btn
+#endif
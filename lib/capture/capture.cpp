@@ -0,0 +1,78 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file capture.cpp
+/// @author Kai R.
+/// @brief Raw DCF77 edge capture.
+///
+/// @date 2022-12-17
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifdef CAPTURE_ENABLED
+#include <Arduino.h>
+#include "capture.hpp"
+
+namespace {
+uint8_t buffer[Capture::BUFFER_SIZE];
+volatile uint8_t head{0};   // Next byte to write (ISR)
+volatile uint8_t tail{0};   // Next byte to send (main)
+uint32_t carry{0};          // Duration of dropped edges
+}   // namespace
+
+namespace Capture {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Initialize the serial output.
+///
+//////////////////////////////////////////////////////////////////////////////
+void begin() { Serial.begin(BAUD_RATE); }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Stores an edge of the receiver signal. Called by the ISR of
+///        DCF77Receive.
+///
+/// @param level      Signal after the edge (true = second mark)
+/// @param duration   ms since the previous edge
+//////////////////////////////////////////////////////////////////////////////
+void edge(bool level, uint16_t duration) {
+  uint32_t value = ((carry + duration) << 1) | level;
+  uint8_t encoded[MAX_VALUE_BYTES];
+  uint8_t len = 0;
+  do {
+    encoded[len] = value & 0x7F;
+    value >>= 7;
+    if (value) { encoded[len] |= 0x80; }
+    ++len;
+  } while (value);
+
+  uint8_t sreg = SREG;
+  cli();
+  uint8_t space = (tail - head - 1) & (BUFFER_SIZE - 1);
+  if (len > space) {
+    carry += duration;
+  } else {
+    carry = 0;
+    for (uint8_t i = 0; i < len; ++i) {
+      buffer[head] = encoded[i];
+      head = (head + 1) & (BUFFER_SIZE - 1);
+    }
+  }
+  SREG = sreg;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sends all stored bytes. Must be called in the main context.
+///        Waits until the last byte has been sent (see Trace::drain()).
+///
+//////////////////////////////////////////////////////////////////////////////
+void drain() {
+  if (head == tail) { return; }
+  while (head != tail) {
+    Serial.write(buffer[tail]);
+    tail = (tail + 1) & (BUFFER_SIZE - 1);
+  }
+  Serial.flush();
+}
+}   // namespace Capture
+#endif
@@ -0,0 +1,59 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file capture.hpp
+/// @author Kai R.
+/// @brief Declaration of the raw DCF77 edge capture.
+///        Every edge of the receiver signal is stored as one variable length
+///        value (ISR safe ring buffer) and sent in the main context via
+///        Serial (9600 baud). The host tool tools/replay feeds a capture
+///        through the unchanged DCF77Receive/DCF77Clock code.
+///
+///        Stream format (one value per edge, no header):
+///        value = duration << 1 | level
+///          duration: ms since the previous edge (as measured by DCF77Receive)
+///          level:    signal after the edge (1 = start of a second mark)
+///        The value is sent in 7 bit groups, least significant group first.
+///        Bit 7 is set in every byte except the last one, so the host can
+///        resynchronize after the next byte with bit 7 cleared.
+///        If the buffer is full, the edge is dropped and its duration is added
+///        to the next stored edge. A dropped edge therefore shows up as two
+///        consecutive edges with the same level.
+///
+///        Build flag CAPTURE_ENABLED switches the capture on. Without it the
+///        CAPTURE() macro is empty. Uses the same serial line as the trace
+///        channel, so TRACE_ENABLED must not be set at the same time.
+///
+/// @date 2022-12-17
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CAPTURE_HPP_
+#define _CAPTURE_HPP_
+
+#include <stdint.h>
+
+#if defined(CAPTURE_ENABLED) && defined(TRACE_ENABLED)
+#error "CAPTURE_ENABLED and TRACE_ENABLED share the serial line. Only one of them can be used."
+#endif
+
+namespace Capture {
+constexpr uint8_t BUFFER_SIZE{32};   // Bytes, power of 2
+constexpr uint32_t BAUD_RATE{9600};
+constexpr uint8_t MAX_VALUE_BYTES{5};   // 32 bit value in 7 bit groups
+
+void begin(void);
+void edge(bool, uint16_t);
+void drain(void);
+}   // namespace Capture
+
+#ifdef CAPTURE_ENABLED
+#define CAPTURE(level, duration) Capture::edge((level), (duration))
+#else
+#define CAPTURE(level, duration)                                                                                       \
+  do {                                                                                                                 \
+  } while (0)
+#endif
+
+#endif
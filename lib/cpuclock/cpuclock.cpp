@@ -0,0 +1,190 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file cpuclock.cpp
+/// @author Kai R.
+/// @brief Dynamic clock scaling.
+///
+/// @date 2022-12-03
+/// @version 1.0
+///
+/// @date 2023-01-21
+/// A timer with an external clock (Timer1 with RTC_TIMEBASE) keeps its clock select bits.
+///
+/// @date 2023-02-25
+/// Boosting is prohibited until the supply voltage has been checked (enable()).
+/// Build flag CLOCK_BOOST. The SPI clock divider is scaled exactly (SPI2X included).
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include "cpuclock.hpp"
+
+// The ATtiny88 has the clock select bits of timer 0 in TCCR0A (no TCCR0B).
+#ifdef TCCR0B
+#define TIMER0_CS_REG TCCR0B
+#else
+#define TIMER0_CS_REG TCCR0A
+#endif
+
+namespace {
+constexpr uint8_t CS_MASK{0x07};     // Clock select bits of TCCR0A/B and TCCR1B
+constexpr uint8_t CS_DIV1{1};
+constexpr uint8_t CS_DIV8{2};
+constexpr uint8_t CS_DIV64{3};
+constexpr uint8_t CS_DIV256{4};
+constexpr uint8_t CS_DIV1024{5};
+constexpr uint8_t CS_EXT_FALLING{6};   // External clock: independent of the CPU clock
+constexpr uint8_t CS_NONE{0xFF};       // No prescaler for the scaled clock (scaledCs())
+constexpr uint8_t SPR_MASK{0x03};    // SPI clock rate bits of SPCR: /4, /16, /64, /128 (halved by SPI2X)
+constexpr uint8_t SPI_MAX_SHIFT{7};  // Largest SPI clock divider: /128
+constexpr uint8_t CLKPR_DIV8{bit(CLKPS1) | bit(CLKPS0)};
+constexpr uint8_t CLKPR_DIV2{bit(CLKPS0)};
+constexpr uint8_t CLKPR_DIV1{0x00};
+
+uint8_t factor{1};          // 1 = boost not possible, 4 or 8
+uint8_t boostLevel{0};      // Nesting depth of boost()
+bool enabled{false};       // Set by enable() after a supply voltage check
+uint8_t twbrBase{0};
+uint8_t twbrBoost{0};
+uint8_t csBase0{0};
+uint8_t csBase1{0};
+uint8_t spcrBase{0};
+uint8_t spsrBase{0};
+uint8_t spcrBoost{0};
+uint8_t spsrBoost{0};
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Timer prescaler (clock select value) for a factor times higher clock.
+///
+/// @param cs        Clock select value at the normal clock
+/// @param f         Clock factor (4 or 8)
+/// @return uint8_t   CS_NONE if not possible
+//////////////////////////////////////////////////////////////////////////////
+uint8_t scaledCs(uint8_t cs, uint8_t f) {
+  if (cs == 0) { return 0; }   // Timer stopped
+  if (cs >= CS_EXT_FALLING) { return cs; }
+  if (f == 8 && (cs == CS_DIV1 || cs == CS_DIV8)) { return cs + 1; }
+  if (f == 4 && (cs == CS_DIV64 || cs == CS_DIV256)) { return cs + 1; }
+  return CS_NONE;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief SPI clock divider of SPCR/SPSR as a power of two.
+///
+/// @param spcr
+/// @param spsr
+/// @return uint8_t   1 (/2) to 7 (/128)
+//////////////////////////////////////////////////////////////////////////////
+uint8_t spiShift(uint8_t spcr, uint8_t spsr) {
+  uint8_t spr = spcr & SPR_MASK;
+  uint8_t shift = (spr == SPR_MASK) ? SPI_MAX_SHIFT : 2 * spr + 2;
+  return (spsr & bit(SPI2X)) ? shift - 1 : shift;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the SPI clock divider of SPCR/SPSR to a power of two.
+///
+/// @param spcr
+/// @param spsr
+/// @param shift     1 (/2) to 7 (/128)
+//////////////////////////////////////////////////////////////////////////////
+void setSpiShift(uint8_t &spcr, uint8_t &spsr, uint8_t shift) {
+  uint8_t spr = (shift == SPI_MAX_SHIFT) ? SPR_MASK : (shift - 1) / 2;
+  spcr = (spcr & ~SPR_MASK) | spr;
+  spsr = (shift < SPI_MAX_SHIFT && (shift & 1)) ? (spsr | bit(SPI2X)) : (spsr & ~bit(SPI2X));
+}
+
+uint8_t twbr(uint32_t cpu, uint32_t speed) {
+  uint32_t ratio = cpu / speed;
+  return (ratio <= 16) ? 0 : (ratio - 16) / 2;   // TWI prescaler = 1
+}
+
+void setClock(uint8_t clkpr, uint8_t cs0, uint8_t cs1, uint8_t twbr_, uint8_t spcr, uint8_t spsr) {
+  uint8_t sreg = SREG;
+  cli();
+  TIMER0_CS_REG = (TIMER0_CS_REG & ~CS_MASK) | cs0;
+  TCCR1B = (TCCR1B & ~CS_MASK) | cs1;
+  TWBR = twbr_;
+  SPCR = spcr;
+  SPSR = spsr;
+  CLKPR = bit(CLKPCE);   // Prescaler change enable. The next write must follow within 4 cycles
+  CLKPR = clkpr;
+  SREG = sreg;
+}
+}   // namespace
+
+namespace CpuClock {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Determines whether and how far the clock can be boosted. Must be
+///        called after Wire and SPI have been initialized.
+///        Clock scaling is only possible with F_CPU = 1 MHz (8 MHz / 8) and
+///        if both timers and the SPI (if enabled) can keep their clock with
+///        a higher divider.
+///
+/// @param wireSpeed   I2C bus speed (Hz)
+//////////////////////////////////////////////////////////////////////////////
+void begin(uint32_t wireSpeed) {
+  csBase0 = TIMER0_CS_REG & CS_MASK;
+  csBase1 = TCCR1B & CS_MASK;
+  spcrBase = SPCR;
+  spsrBase = SPSR & bit(SPI2X);   // The other bits of SPSR are read-only flags
+  uint8_t spi = (spcrBase & bit(SPE)) ? spiShift(spcrBase, spsrBase) : 0;
+  factor = 1;
+#if F_CPU == 1000000L
+  for (uint8_t f = 8; f >= 4; f -= 4) {
+    uint8_t shift = (f == 8) ? 3 : 2;
+    if (scaledCs(csBase0, f) != CS_NONE && scaledCs(csBase1, f) != CS_NONE && spi + shift <= SPI_MAX_SHIFT) {
+      factor = f;
+      spcrBoost = spcrBase;
+      spsrBoost = spsrBase;
+      if (spi) { setSpiShift(spcrBoost, spsrBoost, spi + shift); }
+      break;
+    }
+  }
+#endif
+  // Wire::setClock() calculates a wrong value if F_CPU / speed < 16 (e.g. 1 MHz / 100 kHz).
+  twbrBase = twbr(F_CPU, wireSpeed);
+  twbrBoost = twbr(F_CPU * factor, wireSpeed);
+  TWBR = twbrBase;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Allows or prohibits clock boosting. Prohibited after begin():
+///        allow it only while the measured supply voltage is at least
+///        MIN_BOOST_MV. Must not be called while boosted.
+///
+/// @param enable
+//////////////////////////////////////////////////////////////////////////////
+void enable(bool enable) { enabled = enable; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches to the higher clock.
+///
+//////////////////////////////////////////////////////////////////////////////
+void boost() {
+#ifdef CLOCK_BOOST
+  if (factor == 1 || !enabled || boostLevel++) { return; }
+  setClock(factor == 8 ? CLKPR_DIV1 : CLKPR_DIV2, scaledCs(csBase0, factor), scaledCs(csBase1, factor), twbrBoost,
+           spcrBoost, spsrBoost);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches back to 1 MHz.
+///
+//////////////////////////////////////////////////////////////////////////////
+void relax() {
+  if (boostLevel == 0 || --boostLevel) { return; }
+  setClock(CLKPR_DIV8, csBase0, csBase1, twbrBase, spcrBase, spsrBase);
+}
+
+bool isBoosted() { return boostLevel != 0; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the factor by which the clock is increased in boost mode.
+///
+/// @return uint8_t   1 (no boost possible), 4 or 8
+//////////////////////////////////////////////////////////////////////////////
+uint8_t boostFactor() { return factor; }
+}   // namespace CpuClock
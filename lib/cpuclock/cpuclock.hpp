@@ -0,0 +1,81 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file cpuclock.hpp
+/// @author Kai R.
+/// @brief Declaration of the dynamic clock scaling.
+///        The MCU runs with 1 MHz (internal 8 MHz oscillator / 8) while it
+///        waits. CPU bound work (decoding, I2C bursts, formatting) can be
+///        done with a higher clock (boost), so the MCU can sleep earlier.
+///
+///        All dividers are adjusted together, so the peripherals do not
+///        notice the change:
+///        - Timer0 (millis(), micros()) and Timer1 (backlight PWM) prescaler,
+///          unless the timer counts an external clock (lib/timebase)
+///        - TWI bit rate (TWBR)
+///        - SPI clock divider (SPR1:0 and SPI2X), if the SPI is enabled. No
+///          boost if the divider cannot be raised by the factor (8: up to
+///          /16 at 1 MHz, 4: up to /32)
+///        delayMicroseconds() is calculated with F_CPU at compile time and is
+///        too short while boosted. The DOGM display (uses delayMicroseconds())
+///        must therefore not be written in boost mode. The baud rate of
+///        Serial is not adjusted either (the trace channel sends with the base clock).
+///
+///        The ATtiny88 is specified for 8 MHz only from 2.7 V (4 MHz from
+///        1.8 V). Boosting is therefore prohibited after begin() until
+///        enable(true) is called with a measured supply voltage of at least
+///        MIN_BOOST_MV, and must be prohibited again when it falls below.
+///
+///        Build flag CLOCK_BOOST: without it boost() does nothing and the
+///        clock stays at 1 MHz. It needs the supply voltage check of
+///        BATTERY_MONITOR (src/main.cpp). According to the comparison below
+///        it pays off only with WIRE_FAST_MODE, and only by a small margin.
+///
+/// @date 2022-12-03
+/// @version 1.0
+///
+/// @date 2023-02-18
+/// Energy per second against FIXED_CLOCK (simulator, 7 days without buttons, tools/energy_model.py
+/// with its default model, 3 V):
+///   I2C 100 kHz (default)          boost 4527.5 uJ/s, fixed 4524.0 uJ/s (+0.08 %)
+///   I2C 400 kHz (WIRE_FAST_MODE)   boost 4523.9 uJ/s, fixed 4524.0 uJ/s
+/// The boost shortens the awake time by 30 s per day at 100 kHz. In the simulator the boosted time
+/// is spent waiting for I2C transfers, which only get 1.6 times shorter (62.5 kHz at 1 MHz) at 5.6
+/// times the current (2.8 mA instead of 0.5 mA, mcu_boost_ma). At 100 kHz the boost breaks even at
+/// 0.8 mA. Computations take no time in the simulator, so the charge the boost saves on them is
+/// not included.
+///
+/// @date 2023-02-25
+/// The boost is off by default (build flag CLOCK_BOOST instead of FIXED_CLOCK). At 100 kHz it costs
+/// more than it saves, and no hardware measurement shows a gain yet.
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CPUCLOCK_HPP_
+#define _CPUCLOCK_HPP_
+
+#include <stdint.h>
+
+namespace CpuClock {
+constexpr uint16_t MIN_BOOST_MV{2700};   // Lowest supply voltage for 8 MHz
+
+void begin(uint32_t);
+void enable(bool);
+void boost(void);
+void relax(void);
+bool isBoosted(void);
+uint8_t boostFactor(void);
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Boosts the clock as long as the object exists. Can be nested.
+///
+//////////////////////////////////////////////////////////////////////////////
+class Boost {
+public:
+  Boost() { boost(); }
+  ~Boost() { relax(); }
+  Boost(const Boost &) = delete;              // prevent copy
+  Boost &operator=(const Boost &) = delete;   // prevent assignment
+};
+}   // namespace CpuClock
+#endif
@@ -13,14 +13,180 @@
 /// Change when determining the signal length. A short signal must now be at least
 /// 85ms (THRESHOLD_DUR_SHORT_SIGNAL) long to be recognized and accepted.
 ///
+/// @date 2022-11-05
+/// The start of every second mark is stored with a micros() time stamp.
+///
+/// @date 2022-11-12
+/// The received time must be the successor (TimeCalc::nextMinute()) of the
+/// previously received time. Before only minutes and hours were compared.
+///
+/// @date 2022-11-19
+/// Optional callback at the end of a complete sequence (setSequenceCallback()).
+///
+/// @date 2022-12-10
+/// Serial debug output replaced by binary trace points (lib/trace).
+///
+/// @date 2022-12-17
+/// Every edge can be recorded with the raw edge capture (lib/capture).
+///
+/// @date 2022-12-24
+/// Deglitch stage: the edges pass a filter before the pulses are classified. The end of a
+/// pulse is classified with the next start of a second, so a short dropout can still be
+/// merged into the pulse.
+///
+/// @date 2022-12-31
+/// Reception quality metric (getQuality()).
+///
+/// @date 2023-01-21
+/// Pulse timing and time stamps with TimeBase (optionally the 32 kHz output of the RTC).
+///
+/// @date 2023-01-28
+/// Adaptive decision boundaries. Receiver modules (e.g. ELV DCF-2) and the RC oscillator of
+/// the MCU shift the measured pulse widths, the fixed thresholds misclassified them.
+///
+/// @date 2023-02-04
+/// Frame mailbox. The receive buffer was cleared by decodeSequence() and the flag by the
+/// first pulse of the next minute: a late decoding lost the frame and the bits of the
+/// next minute.
+/// A missing second mark looks like a minute mark and restarts the second index. Until the
+/// next complete minute the index is NO_SECOND. A minute gap that is a second too long
+/// (no signal at the start of the minute) makes the minute incomplete. Both set the RTC
+/// seconds wrong.
+///
+/// @date 2023-02-11
+/// The frame layout is shared with the encoder (encodeSequence(), DCF77 output of the
+/// clock, lib/dcf77out).
+///
+/// @date 2023-02-11
+/// Build flag PARTIAL_FRAMES: a dropout makes the whole minute useless, although the RTC
+/// knows the second within the minute. The ISR also places every bit at its second of the
+/// RTC minute and publishes these bits once a minute, complete or not. decodePartial()
+/// keeps the minutes, hours and date of these minutes separately (each checked by its own
+/// parity) and assembles the time when every field has been received twice, in any minutes.
+///
+/// @date 2023-02-11
+/// getSequence(): the bits of the minute being received for a comparison with the RTC.
+///
+/// @date 2023-02-18
+/// The start of a second is only accepted at the falling edge of a pulse of at least _minPulse.
+/// A spike late in the minute gap started the new minute and a second mark at the spike and fed
+/// a wrong period to the quality metric and the minute threshold, although the spike itself was
+/// rejected at its falling edge.
+///
+/// @date 2023-02-25
+/// The ISR only counts the pulse widths. The 2-means step of the adaptive thresholds blocked the
+/// interrupts (1Hz time stamp, serial time) for up to 2 ms with every pulse. It runs in the main
+/// context now, once per PULSE_HIST_UPDATE pulses (updateThresholds()).
+///
 /// @copyright Copyright (c) 2022
 ///
 //////////////////////////////////////////////////////////////////////////////
 
 #include <Arduino.h>
 #include "dcf77.hpp"
+#include "bcdconv.hpp"
+#include "capture.hpp"
+#include "timebase.hpp"
+#include "trace.hpp"
 #include <digitalWriteFast.h>
 
+using BCDConv::bcdToDec;
+
+namespace {
+// Pulse width histogram: 16 bins of 16 ms from 40 ms (longer pulses in the last bin).
+// The ISR only counts the pulses. updateThresholds() runs the 2-means step after
+// PULSE_HIST_UPDATE new pulses and halves the counts while there are PULSE_HIST_LIMIT
+// or more, so the histogram follows a change within one or two minutes and the sums of
+// the 2-means step fit into 16 bit.
+constexpr uint8_t PULSE_HIST_BINS{16};
+constexpr uint8_t PULSE_HIST_MIN{40};
+constexpr uint8_t PULSE_HIST_SHIFT{4};
+constexpr uint8_t PULSE_HIST_CENTER{PULSE_HIST_MIN + (1 << (PULSE_HIST_SHIFT - 1))};   // Center of bin 0
+constexpr uint8_t PULSE_HIST_LIMIT{128};
+constexpr uint8_t PULSE_HIST_UPDATE{30};   // New pulses for the next 2-means step: about half a minute
+constexpr uint8_t PULSE_CLASS_MIN{8};   // Pulses per class (0/1) needed to move the boundary
+constexpr uint16_t PERIOD_MIN{750};     // Second periods (ms) used for the minute threshold
+constexpr uint16_t PERIOD_MAX{1250};
+
+#ifdef PARTIAL_FRAMES
+constexpr uint32_t HALF_SECOND_MICROS{500000};   // Max. phase between the RTC and the DCF77 second marks
+constexpr uint8_t PARTIAL_PUBLISH_SECOND{1};     // The pulse of second 58 is classified at the mark of second 0
+constexpr uint16_t MINUTES_PER_DAY{1440};
+enum : uint8_t { FIELD_MINUTES, FIELD_HOURS, FIELD_DATE };
+
+struct PartialField {
+  uint8_t first;    // First bit in the frame
+  uint8_t length;   // Bits including the parity bit
+};
+const PartialField PARTIAL_FIELD[PARTIAL_FIELDS] PROGMEM{
+    {DCF77Bit::MINUTES, 8}, {DCF77Bit::HOURS, 7}, {DCF77Bit::DATE, 23}};
+static_assert(DCF77Bit::MINUTES + 7 == DCF77Bit::PARITY_MINUTES && DCF77Bit::HOURS + 6 == DCF77Bit::PARITY_HOURS &&
+                  DCF77Bit::DATE + 22 == DCF77Bit::PARITY_DATE,
+              "The parity bit follows every field");
+
+bool isBcd(uint8_t bcd, uint8_t min, uint8_t max) {
+  return (bcd & 0x0F) <= 9 && bcdToDec(bcd) >= min && bcdToDec(bcd) <= max;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Checks the BCD digits and the ranges of a field. The day of the
+///        week must belong to the date.
+///
+/// @param field    FIELD_MINUTES, FIELD_HOURS or FIELD_DATE
+/// @param value    Bits of the field without the parity bit
+/// @return true    Plausible
+//////////////////////////////////////////////////////////////////////////////
+bool isPlausible(uint8_t field, uint32_t value) {
+  switch (field) {
+    case FIELD_MINUTES: return isBcd(value, 0, 59);
+    case FIELD_HOURS: return isBcd(value, 0, 23);
+    default: {
+      uint8_t day = value & 0x3F;
+      uint8_t month = (value >> (DCF77Bit::MONTH - DCF77Bit::DATE)) & 0x1F;
+      uint8_t year = value >> (DCF77Bit::YEAR - DCF77Bit::DATE);
+      uint8_t dayOfWeek = (value >> (DCF77Bit::DAY_OF_WEEK - DCF77Bit::DATE)) & 0x07;
+      return isBcd(day, 1, 31) && isBcd(month, 1, 12) && isBcd(year, 0, 99) &&
+             dayOfWeek == TimeCalc::dayOfWeek(TimeCalc::fromBcd(year, month, day, 0, 0, 0));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Offset DCF77 time - RTC time (minutes) given by one capture of a
+///        field. The minutes give it modulo 60, the hours modulo 1440 (with
+///        the offset of the minutes), the date completely (with the offset
+///        of the hours). The offset does not change while the RTC runs, so
+///        captures of different minutes can be compared.
+///
+/// @param field    FIELD_MINUTES, FIELD_HOURS or FIELD_DATE
+/// @param minute   RTC minute (epoch / 60) of the capture
+/// @param value    Bits of the field without the parity bit
+/// @param lower    Offset of the field below (FIELD_HOURS, FIELD_DATE)
+/// @return int32_t
+//////////////////////////////////////////////////////////////////////////////
+int32_t captureOffset(uint8_t field, uint32_t minute, uint32_t value, int32_t lower) {
+  uint16_t minuteOfDay = minute % MINUTES_PER_DAY;
+  uint8_t minuteOfHour = minuteOfDay % TimeCalc::MINUTES_PER_HOUR;
+  switch (field) {
+    case FIELD_MINUTES:
+      return (bcdToDec(value) + TimeCalc::MINUTES_PER_HOUR - minuteOfHour) % TimeCalc::MINUTES_PER_HOUR;
+    case FIELD_HOURS: {
+      uint16_t dcfMinuteOfDay =
+          bcdToDec(value) * TimeCalc::MINUTES_PER_HOUR + (minuteOfHour + lower) % TimeCalc::MINUTES_PER_HOUR;
+      return (dcfMinuteOfDay + MINUTES_PER_DAY - minuteOfDay) % MINUTES_PER_DAY;
+    }
+    default: {
+      uint16_t days = TimeCalc::daysFromCivil(bcdToDec(value >> (DCF77Bit::YEAR - DCF77Bit::DATE)),
+                                              bcdToDec((value >> (DCF77Bit::MONTH - DCF77Bit::DATE)) & 0x1F),
+                                              bcdToDec(value & 0x3F));
+      uint32_t dcfMinute = static_cast<uint32_t>(days) * MINUTES_PER_DAY + (minuteOfDay + lower) % MINUTES_PER_DAY;
+      return static_cast<int32_t>(dcfMinute - minute);
+    }
+  }
+}
+#endif
+}   // namespace
+
 //////////////////////////////////////////////////
 // Initialize static class variables
 //////////////////////////////////////////////////
@@ -29,10 +195,51 @@ uint8_t DCF77Receive::_intPin {PIND2};
 bool DCF77Receive::_activeLow {false};
 uint8_t DCF77Receive::_seconds {0};
 uint16_t DCF77Receive::_duration {0};
-uint32_t DCF77Receive::_lastInt {0};
+uint32_t DCF77Receive::_lastEdge {0};
+uint32_t DCF77Receive::_lastRise {0};
+uint32_t DCF77Receive::_riseMicros {0};
+uint32_t DCF77Receive::_lastFall {0};
+uint32_t DCF77Receive::_lastRawFall {0};
+uint16_t DCF77Receive::_pulseWidth {0};
+bool DCF77Receive::_pulsePending {false};
+bool DCF77Receive::_pulseAccepted {false};
+uint8_t DCF77Receive::_minPulse {DEGLITCH_MIN_PULSE};
+uint8_t DCF77Receive::_minGap {DEGLITCH_MIN_GAP};
+volatile uint16_t DCF77Receive::_glitchCount {0};
+uint16_t DCF77Receive::_lastGlitchCount {0};
+uint32_t DCF77Receive::_lastSecond {0};
+uint16_t DCF77Receive::_pulseErrorAvg {0};
+uint16_t DCF77Receive::_spikesAvg {0};
+uint16_t DCF77Receive::_missedAvg {0};
 bool DCF77Receive::_longSig {false};
+bool DCF77Receive::_adaptive {true};
+volatile uint8_t DCF77Receive::_pulseHist[PULSE_HIST_BINS] {};
+volatile uint8_t DCF77Receive::_pulseHistNew {0};
+uint16_t DCF77Receive::_periodAvg {1000 << 4};
+uint8_t DCF77Receive::_shortThreshold {THRESHOLD_DUR_SHORT_SIGNAL};
+uint8_t DCF77Receive::_longThreshold {THRESHOLD_DUR_LONG_SIGNAL};
+uint16_t DCF77Receive::_minuteThreshold {THRESHOLD_DUR_MINUTE};
 uint64_t DCF77Receive::_sequenceBuffer {0};
-DCF77Sequence DCF77Receive::_sequenceFlag {SEQ_ERROR};
+DCF77Frame DCF77Receive::_frame {0, 0, SEQ_ERROR};
+volatile uint8_t DCF77Receive::_frameCount {0};
+uint8_t DCF77Receive::_frameRead {0};
+uint8_t DCF77Receive::_framesLost {0};
+volatile uint8_t DCF77Receive::_edgeCount {0};
+volatile uint8_t DCF77Receive::_edgeSecond {0};
+volatile uint32_t DCF77Receive::_edgeMicros {0};
+void (*DCF77Receive::_onSequence)(void) {nullptr};
+#ifdef PARTIAL_FRAMES
+volatile uint8_t DCF77Receive::_rtcSecond {NO_SECOND};
+uint32_t DCF77Receive::_rtcSecondMicros {0};
+uint32_t DCF77Receive::_rtcMinute {0};
+bool DCF77Receive::_rtcAligned {false};
+uint8_t DCF77Receive::_alignedSecond {NO_SECOND};
+uint64_t DCF77Receive::_alignedBits {0};
+uint64_t DCF77Receive::_alignedReceived {0};
+DCF77Partial DCF77Receive::_partial {0, 0, 0};
+volatile uint8_t DCF77Receive::_partialCount {0};
+uint8_t DCF77Receive::_partialRead {0};
+#endif
 
 // Methods of DCF77Receive  //////////////////////////////////////////////////
 
@@ -63,59 +270,383 @@ void DCF77Receive::begin(uint8_t intPin) {
 //////////////////////////////////////////////////////////////////////////////
 void DCF77Receive::setActiveLow(bool activeLow) { _activeLow = activeLow; }
 
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the deglitch filter. 0 switches the respective check off.
+///
+/// @param minPulse   Pulses shorter than minPulse (ms) are rejected as spikes
+/// @param minGap     Gaps shorter than minGap (ms) are merged into the pulse
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::setDeglitch(uint8_t minPulse, uint8_t minGap) {
+  noInterrupts();
+  _minPulse = minPulse;
+  _minGap = minGap;
+  interrupts();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the number of spikes and dropouts removed by the deglitch
+///        filter (overflows).
+///
+/// @return uint16_t
+//////////////////////////////////////////////////////////////////////////////
+uint16_t DCF77Receive::getGlitchCount() {
+  noInterrupts();
+  uint16_t count = _glitchCount;
+  interrupts();
+  return count;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 /// @brief Method called by ISR to receive the DCF-77 time signals.
+///        Deglitch stage: a pulse shorter than _minPulse is a spike and is
+///        ignored. A gap shorter than _minGap is a dropout, the pulse
+///        continues. A rising edge only starts a second when its pulse has
+///        lasted _minPulse, at the falling edge (secondStart() with the time
+///        stamp of the rising edge). The previous pulse is classified then
+///        (classifyPulse()), so a dropout can still be merged into it.
 ///
 //////////////////////////////////////////////////////////////////////////////
 void DCF77Receive::receiveSequence() {
-  _duration = millis() - _lastInt;
+  uint32_t now = TimeBase::millis();
+  _duration = now - _lastEdge;
+  _lastEdge = now;
+  bool signal = digitalReadFast(_intPin) ^ _activeLow;
+  CAPTURE(signal, _duration);
 
-  if (digitalReadFast(_intPin) ^ _activeLow) {
-#ifdef DEBUG_ISR
-    Serial.println(_duration);
-#endif
-    if (_duration > THRESHOLD_DUR_MINUTE) {
-      switch (_seconds) {
-        case MAX_SECONDS: _sequenceFlag = MAX_SECONDS; break;
-        case LEAP_SECOND: _sequenceFlag = LEAP_SECOND; break;
-        default:
-          _sequenceFlag = SEQ_ERROR;
-          _sequenceBuffer = 0;
-          break;
-      }
-      _seconds = 0;
+  if (signal) {
+    TRACE(EDGE, 1, _duration);
+    if (now - _lastRawFall < _minGap) {   // Dropout: the pulse continues
+      ++_glitchCount;
+      return;
     }
+    _riseMicros = TimeBase::micros();
+    _lastRise = now;
+    _pulseAccepted = false;
   } else {
-#ifdef DEBUG_ISR
-    Serial.print(_seconds);
-    Serial.print(F(". "));
-    Serial.print(_duration);
-    Serial.print(F("  /  "));
+    TRACE(EDGE, 0, _duration);
+    _lastRawFall = now;
+    uint16_t width = now - _lastRise;
+    if (width < _minPulse) {   // Spike
+      ++_glitchCount;
+      return;
+    }
+    if (!_pulseAccepted) {   // First falling edge of the pulse that passes: start of a second
+      _pulseAccepted = true;
+      if (_pulsePending) { classifyPulse(_pulseWidth); }
+      secondStart(_lastRise - _lastFall, _riseMicros);
+    }
+    _pulseWidth = width;
+    _pulsePending = true;
+    _lastFall = now;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Start of a second mark. After a gap longer than the minute
+///        threshold the previous minute is complete, unless the gap is
+///        also a second longer than that.
+///
+/// @param gap          Time (ms) between the last two accepted pulses
+/// @param riseMicros   micros() at the rising edge
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::secondStart(uint32_t gap, uint32_t riseMicros) {
+#ifdef PARTIAL_FRAMES
+  uint8_t rtcSecond = rtcAlignedSecond(riseMicros);
+#endif
+  bool minuteMark = gap > _minuteThreshold;
+  updateQuality(minuteMark);
+  if (minuteMark) {
+    // A longer gap hides missed second marks: the start of the new minute is unknown.
+    bool markGap = gap < _minuteThreshold + (_periodAvg >> 4);
+    bool complete = (_seconds == MAX_SECONDS || _seconds == LEAP_SECOND) && markGap;
+#ifdef PARTIAL_FRAMES
+    if (markGap && rtcSecond == 0) { _rtcAligned = true; }   // The minute mark starts the RTC minute
+#endif
+    TRACE(FRAME, complete ? _seconds : static_cast<uint8_t>(SEQ_ERROR), _seconds);
+    TRACE(THRESHOLD, _minuteThreshold / 10, (_shortThreshold << 8) | _longThreshold);
+    // The second index belongs to the new minute: the previous frame is outdated.
+    if (_frame.length != SEQ_ERROR && _frameCount != _frameRead) { ++_framesLost; }
+    _frame.length = SEQ_ERROR;
+    if (complete) {
+      _frame.bits = _sequenceBuffer;
+      _frame.micros = riseMicros;
+      _frame.length = _seconds;
+      ++_frameCount;
+    }
+    _sequenceBuffer = 0;
+    _seconds = 0;
+    if (complete && _onSequence) { _onSequence(); }
+  }
+  // The rising edge of the signal is the start of the second (_seconds).
+  _edgeMicros = riseMicros;
+  _edgeSecond = _frame.length != SEQ_ERROR ? _seconds : NO_SECOND;
+#ifdef PARTIAL_FRAMES
+  if (_edgeSecond == NO_SECOND && _rtcAligned) { _edgeSecond = rtcSecond; }
+  _alignedSecond = rtcSecond;
+#endif
+  ++_edgeCount;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Bit classification of an accepted pulse.
+///
+/// @param width  Pulse width (ms)
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::classifyPulse(uint16_t width) {
+  countPulse(width);
+  uint16_t error = width > _longThreshold ? width - 200 : width - 100;
+  if (error & 0x8000) { error = -error; }
+  if (error > 100) { error = 100; }
+  _pulseErrorAvg += error - ((_pulseErrorAvg + 15) >> 4);
+  // Signals arround 200ms are a logical 1 / 100ms are logical 0. So if (width > _longThreshold) comes
+  // true set a bit.
+  if (width > _shortThreshold) {
+    _longSig = false;
+    if (width > _longThreshold) {
+      _sequenceBuffer |= ((uint64_t)1 << _seconds);
+      _longSig = true;
+    }
+#ifdef PARTIAL_FRAMES
+    if (_alignedSecond != NO_SECOND) {
+      uint64_t mask = (uint64_t)1 << _alignedSecond;
+      _alignedReceived |= mask;
+      if (_longSig) { _alignedBits |= mask; }
+    }
 #endif
-    // Signals arround 200ms are a logical 1 / 100ms are logical 0. So if (duration > THRESHOLD_DUR_LONG_SIGNAL) comes
-    // true set a bit.
-    if (_duration > THRESHOLD_DUR_SHORT_SIGNAL) {
-      _longSig = false;
-      if (_duration > THRESHOLD_DUR_LONG_SIGNAL) {
-        _sequenceBuffer |= ((uint64_t)1 << _seconds);
-        _longSig = true;
-      }
-      _seconds++;
+    TRACE(BIT, _seconds, _longSig);
+    _seconds++;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Adds a pulse to the width histogram. The counts stop at 255 if
+///        updateThresholds() is not called.
+///
+/// @param width  Pulse width (ms)
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::countPulse(uint16_t width) {
+  uint16_t bin = width < PULSE_HIST_MIN ? 0 : (width - PULSE_HIST_MIN) >> PULSE_HIST_SHIFT;
+  volatile uint8_t &count = _pulseHist[bin < PULSE_HIST_BINS ? bin : PULSE_HIST_BINS - 1];
+  if (count != UINT8_MAX) { ++count; }
+  if (_pulseHistNew != UINT8_MAX) { ++_pulseHistNew; }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Moves the 0/1 boundary to the middle between the mean widths of
+///        the short and the long pulses (two steps of 2-means, starting at
+///        the current boundary), if PULSE_HIST_UPDATE pulses have been
+///        counted since the last call. The short threshold is a quarter of
+///        the distance of the means below the short mean. Both are limited
+///        (THRESHOLD_*_MIN/MAX). The boundary only moves if both classes
+///        have PULSE_CLASS_MIN pulses.
+///        The 2-means step takes about 1.5k-2k cycles, so it does not run in
+///        the ISR. Call it from the main context while the receiver is on,
+///        e.g. once per second: it does not depend on complete frames, so
+///        start values that miss the pulses are corrected as well.
+///
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::updateThresholds() {
+  uint8_t hist[PULSE_HIST_BINS];
+  noInterrupts();
+  if (_pulseHistNew < PULSE_HIST_UPDATE) {
+    interrupts();
+    return;
+  }
+  _pulseHistNew = 0;
+  for (;;) {
+    uint16_t total = 0;
+    for (uint8_t i = 0; i < PULSE_HIST_BINS; ++i) { total += _pulseHist[i]; }
+    if (total < PULSE_HIST_LIMIT) { break; }
+    for (uint8_t i = 0; i < PULSE_HIST_BINS; ++i) { _pulseHist[i] >>= 1; }
+  }
+  for (uint8_t i = 0; i < PULSE_HIST_BINS; ++i) { hist[i] = _pulseHist[i]; }
+  interrupts();
+  if (!_adaptive) { return; }
+
+  uint16_t threshold = _longThreshold;
+  uint16_t mean[2];
+  for (uint8_t step = 0; step < 2; ++step) {
+    uint16_t n[2]{0, 0};
+    uint16_t sum[2]{0, 0};   // Sum of the bin numbers
+    for (uint8_t i = 0; i < PULSE_HIST_BINS; ++i) {
+      uint8_t cls = (PULSE_HIST_CENTER + (i << PULSE_HIST_SHIFT)) > threshold;
+      n[cls] += hist[i];
+      sum[cls] += hist[i] * i;
     }
-    _sequenceFlag = SEQ_ERROR;
+    if (n[0] < PULSE_CLASS_MIN || n[1] < PULSE_CLASS_MIN) { return; }
+    for (uint8_t cls = 0; cls < 2; ++cls) { mean[cls] = PULSE_HIST_CENTER + (sum[cls] << PULSE_HIST_SHIFT) / n[cls]; }
+    threshold = (mean[0] + mean[1]) >> 1;
+  }
+  uint8_t longThreshold = constrain(threshold, THRESHOLD_LONG_MIN, THRESHOLD_LONG_MAX);
+  uint8_t shortThreshold = constrain(mean[0] - ((mean[1] - mean[0]) >> 2), THRESHOLD_SHORT_MIN, THRESHOLD_SHORT_MAX);
+  noInterrupts();   // classifyPulse() uses both
+  _longThreshold = longThreshold;
+  _shortThreshold = shortThreshold;
+  interrupts();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Moving average of the second period (factor 1/16). The minute
+///        mark is a gap of about two periods minus the pulse, a normal gap
+///        is shorter than one period: the minute threshold is 1.5 periods
+///        (limited, THRESHOLD_MINUTE_MIN/MAX). Periods with a missed second
+///        mark or the minute mark are not used.
+///
+/// @param period   Time (ms) between the last two second marks
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::adaptMinuteThreshold(uint32_t period) {
+  if (period < PERIOD_MIN || period > PERIOD_MAX) { return; }
+  _periodAvg += period - ((_periodAvg + 8) >> 4);
+  if (!_adaptive) { return; }
+  uint16_t minute = (_periodAvg * 3) >> 5;
+  _minuteThreshold = constrain(minute, THRESHOLD_MINUTE_MIN, THRESHOLD_MINUTE_MAX);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Updates the spike and missed second averages at the start of a
+///        second. Exponential moving averages with factor 1/16, scaled by
+///        256, so they only need shifts and 16 bit additions.
+///
+///        The measured period also adapts the minute threshold.
+///
+/// @param minuteMark   No second mark in second 59 is expected
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::updateQuality(bool minuteMark) {
+  uint32_t period = _lastRise - _lastSecond;
+  _lastSecond = _lastRise;
+  adaptMinuteThreshold(period);
+  uint16_t glitches = _glitchCount - _lastGlitchCount;
+  _lastGlitchCount = _glitchCount;
+  if (period > QUALITY_RESTART) {
+    _pulseErrorAvg = _spikesAvg = _missedAvg = 0;
+    return;
   }
-  _lastInt = millis();
+  uint8_t missed = (period + 500) / 1000;   // Seconds since the previous mark
+  missed = missed > (1 + minuteMark) ? missed - 1 - minuteMark : 0;
+  if (glitches > 15) { glitches = 15; }
+  _spikesAvg += (glitches << 4) - ((_spikesAvg + 15) >> 4);   // Rounded up, so the average decays to 0
+  _missedAvg += (missed << 4) - ((_missedAvg + 15) >> 4);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the reception quality. See DCF77Quality.
+///        score = 99 - pulse error (ms) - spikes/min - 2 * missed seconds/min
+///
+/// @return DCF77Quality
+//////////////////////////////////////////////////////////////////////////////
+DCF77Quality DCF77Receive::getQuality() {
+  noInterrupts();
+  uint16_t pulseErrorAvg = _pulseErrorAvg;
+  uint16_t spikesAvg = _spikesAvg;
+  uint16_t missedAvg = _missedAvg;
+  uint32_t lastSecond = _lastSecond;
+  uint8_t second = _seconds;
+  interrupts();
+
+  DCF77Quality q;
+  q.pulseError = pulseErrorAvg >> 4;
+  uint16_t spikes = (static_cast<uint32_t>(spikesAvg) * 60) >> 8;
+  uint16_t missed = (static_cast<uint32_t>(missedAvg) * 60) >> 8;
+  q.spikes = spikes > 255 ? 255 : spikes;
+  q.missed = missed > 255 ? 255 : missed;
+  q.second = second;
+  int16_t score = 99 - q.pulseError - spikes - 2 * missed;
+  if (score < 0 || TimeBase::millis() - lastSecond > QUALITY_NO_SIGNAL) { score = 0; }
+  q.score = score;
+  return q;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches the adaptive thresholds on (default) or off. Off sets
+///        the constant thresholds THRESHOLD_DUR_*. The histogram and the
+///        period are measured in both cases.
+///
+/// @param adaptive
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::setAdaptive(bool adaptive) {
+  noInterrupts();
+  _adaptive = adaptive;
+  if (!adaptive) {
+    _shortThreshold = THRESHOLD_DUR_SHORT_SIGNAL;
+    _longThreshold = THRESHOLD_DUR_LONG_SIGNAL;
+    _minuteThreshold = THRESHOLD_DUR_MINUTE;
+  }
+  interrupts();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the current decision boundaries (diagnostics).
+///
+/// @return DCF77Thresholds
+//////////////////////////////////////////////////////////////////////////////
+DCF77Thresholds DCF77Receive::getThresholds() {
+  noInterrupts();
+  DCF77Thresholds t{_shortThreshold, _longThreshold, _minuteThreshold};
+  interrupts();
+  return t;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets a function that is called (in the ISR!) when a complete
+///        sequence has been received.
+///
+/// @param onSequence   Function or nullptr
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::setSequenceCallback(void (*onSequence)(void)) { _onSequence = onSequence; }
+
 //////////////////////////////////////////////////////////////////////////////
 /// @brief Returns a flag. This flag provides information as to whether
-///        a complete data reception sequence has been completed or not.
+///        a complete data reception sequence is waiting to be fetched.
 ///        MAX_SECONDS or LEAP_SECOND = OK
-///        SEQ_ERROR = Not OK or not yet complete.
+///        SEQ_ERROR = No new complete sequence.
 ///
 /// @return DCF77Sequence MAX_SECONDS or LEAP_SECOND or SEQ_ERROR
 //////////////////////////////////////////////////////////////////////////////
-DCF77Sequence DCF77Receive::getSequenceFlag() { return _sequenceFlag; }
+DCF77Sequence DCF77Receive::getSequenceFlag() {
+  return _frameCount != _frameRead ? static_cast<DCF77Sequence>(_frame.length) : SEQ_ERROR;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Fetches the last complete frame from the mailbox. The frame
+///        stays valid until the next minute mark; meanwhile the ISR
+///        receives the next minute in its own buffer. After an incomplete
+///        minute there is no frame.
+///
+/// @param frame    Copy of the frame
+/// @return true    New frame
+/// @return false   No new frame since the last call (frame unchanged)
+//////////////////////////////////////////////////////////////////////////////
+bool DCF77Receive::fetchFrame(DCF77Frame &frame) {
+  noInterrupts();
+  uint8_t count = _frameCount;
+  bool isNew = (count != _frameRead && _frame.length != SEQ_ERROR);
+  if (isNew) { frame = _frame; }
+  interrupts();
+  _frameRead = count;
+  return isNew;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns a counter that is incremented with every complete frame.
+///
+/// @return uint8_t  Number of complete frames received (overflows)
+//////////////////////////////////////////////////////////////////////////////
+uint8_t DCF77Receive::getFrameCount() { return _frameCount; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Marks the frame in the mailbox as fetched, e.g. an old frame from
+///        before the receiver was switched off.
+///
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::discardFrame() { _frameRead = _frameCount; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Number of complete frames that were replaced by the next one
+///        before they have been fetched.
+///
+/// @return uint8_t  Lost frames (overflows)
+//////////////////////////////////////////////////////////////////////////////
+uint8_t DCF77Receive::getFramesLost() { return _framesLost; }
 
 //////////////////////////////////////////////////////////////////////////////
 /// @brief This method returns whether the last signal received
@@ -126,6 +657,150 @@ DCF77Sequence DCF77Receive::getSequenceFlag() { return _sequenceFlag; }
 //////////////////////////////////////////////////////////////////////////////
 bool DCF77Receive::wasLastSignalLong() { return _longSig; }
 
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns a counter that is incremented with every accepted
+///        second mark, at the end of its pulse. A change of the value shows
+///        that a new second began (at the time stamp of getLastEdge()).
+///
+/// @return uint8_t  Number of second marks received (overflows)
+//////////////////////////////////////////////////////////////////////////////
+uint8_t DCF77Receive::getEdgeCount() { return _edgeCount; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the time stamp and the second index of the last
+///        second mark. Both values are read with interrupts disabled,
+///        so they always belong together.
+///
+/// @param edgeMicros   micros() at the start of the last second mark
+/// @return uint8_t     Second (0-59) that started with this mark, NO_SECOND
+///                     if the second marks since the last frame are incomplete
+//////////////////////////////////////////////////////////////////////////////
+uint8_t DCF77Receive::getLastEdge(uint32_t &edgeMicros) {
+  noInterrupts();
+  edgeMicros = _edgeMicros;
+  uint8_t second = _edgeSecond;
+  interrupts();
+  return second;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the bits of the minute being received and its last second
+///        mark, also if the minute was not preceded by a complete one (the
+///        first minute after switching the receiver on). Read with interrupts
+///        disabled, so the values belong together.
+///
+/// @param bits         Bits 0 ... second - 1 of the minute being received
+/// @param edgeMicros   micros() at the start of the last second mark
+/// @return uint8_t     Seconds since the last minute mark: the second that
+///                     started with this mark, if none has been missed
+//////////////////////////////////////////////////////////////////////////////
+uint8_t DCF77Receive::getSequence(uint64_t &bits, uint32_t &edgeMicros) {
+  noInterrupts();
+  bits = _sequenceBuffer;
+  edgeMicros = _edgeMicros;
+  uint8_t second = _seconds;
+  interrupts();
+  return second;
+}
+
+#ifdef PARTIAL_FRAMES
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Second of the RTC minute in which a second mark starts. A mark
+///        more than half a second after the start of the counted RTC second
+///        belongs to the next one (the RTC is late or its tick is not yet
+///        counted, INT0 comes first).
+///
+/// @param riseMicros   micros() at the start of the second mark
+/// @return uint8_t     0-59, NO_SECOND without RTC time
+//////////////////////////////////////////////////////////////////////////////
+uint8_t DCF77Receive::rtcAlignedSecond(uint32_t riseMicros) {
+  uint8_t second = _rtcSecond;
+  if (second == NO_SECOND || riseMicros - _rtcSecondMicros <= HALF_SECOND_MICROS) { return second; }
+  return second == TimeCalc::SECONDS_PER_MINUTE - 1 ? 0 : second + 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The alignment of the bits needs the RTC time: no time yet or
+///        after resyncRtc().
+///
+//////////////////////////////////////////////////////////////////////////////
+bool DCF77Receive::needsRtcTime() { return _rtcSecond == NO_SECOND; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the RTC second that is running. Must be called in the second
+///        that has been read (after its tick). The bits are published after
+///        a minute mark has started RTC second 0: a wrong alignment would
+///        place them at the wrong seconds.
+///
+/// @param epoch   RTC time (TimeCalc epoch)
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::setRtcTime(uint32_t epoch) {
+  uint8_t second = epoch % TimeCalc::SECONDS_PER_MINUTE;
+  noInterrupts();
+  _rtcMinute = epoch - second;
+  _rtcSecond = second;
+  _rtcAligned = false;
+  _alignedBits = 0;
+  _alignedReceived = 0;
+  interrupts();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Counted tick of the RTC 1Hz signal (interrupt). Counts the RTC
+///        seconds and publishes the bits of the previous RTC minute in
+///        second PARTIAL_PUBLISH_SECOND.
+///
+/// @param secondStart   micros() at the start of the RTC second
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::rtcTick(uint32_t secondStart) {
+  _rtcSecondMicros = secondStart;
+  if (_rtcSecond == NO_SECOND) { return; }
+  if (++_rtcSecond == TimeCalc::SECONDS_PER_MINUTE) {
+    _rtcSecond = 0;
+    _rtcMinute += TimeCalc::SECONDS_PER_MINUTE;
+  } else if (_rtcSecond == PARTIAL_PUBLISH_SECOND) {
+    if (_rtcAligned && _alignedReceived) {
+      _partial.bits = _alignedBits;
+      _partial.received = _alignedReceived;
+      _partial.minute = _rtcMinute;
+      ++_partialCount;
+    }
+    _alignedBits = 0;
+    _alignedReceived = 0;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Stops the alignment until the next setRtcTime(), e.g. after the
+///        RTC has been set or when the 1Hz signal may stop.
+///
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Receive::resyncRtc() {
+  noInterrupts();
+  _rtcSecond = NO_SECOND;
+  _rtcAligned = false;
+  _alignedSecond = NO_SECOND;
+  interrupts();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Fetches the bits of the last RTC minute from the mailbox.
+///
+/// @param partial  Copy of the bits
+/// @return true    New RTC minute
+/// @return false   No new RTC minute since the last call (partial unchanged)
+//////////////////////////////////////////////////////////////////////////////
+bool DCF77Receive::fetchPartial(DCF77Partial &partial) {
+  noInterrupts();
+  uint8_t count = _partialCount;
+  bool isNew = (count != _partialRead);
+  if (isNew) { partial = _partial; }
+  interrupts();
+  _partialRead = count;
+  return isNew;
+}
+#endif
+
 // Methods of DCF77Clock //////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////
@@ -135,29 +810,27 @@ bool DCF77Receive::wasLastSignalLong() { return _longSig; }
 /// @return false The reception of the time sequence was faulty.
 //////////////////////////////////////////////////////////////////////////////
 bool DCF77Clock::decodeSequence() {
-
-  if (_sequenceFlag == SEQ_ERROR) { return false; }
+  DCF77Frame frame;
+  if (!fetchFrame(frame)) { return false; }   // Prevents multiple evaluation of the same frame
   _parityTimeOK = false;
   _parityDateOK = false;
   //
   // There are two consecutive correct receive sequences are required to set the RTC.
   //
-  _oldMinutes = _minutes;
-  _oldHours = _hours;
-  // dcf77Seq->switchMEZ = (int0_dcf77DataBuffer >> 16) & 0x01;        // Time changes to MEZ/MESZ after actal hour
-  // dcf77Seq->summertime = (int0_dcf77DataBuffer >> 17) & 0x03;       // MEZ: b17=0 b18=1 / MESZ = b17=1 b18=0  bit
-  // 17-18
-  _leapSecond = (_sequenceBuffer >> 19) & 0x01;         // If true a leap second is set in the following hour
-  _startBit = (_sequenceBuffer >> 20) & 0x01;           // startbit = 20 must be one!
-  _minutes = (_sequenceBuffer >> 21) & 0x7F;            // minute = 21-27
-  _parityBitMinutes = (_sequenceBuffer >> 28) & 0x01;   // parity bit minutes
-  _hours = (_sequenceBuffer >> 29) & 0x3F;              // hour = bit 29-34
-  _parityBitHours = (_sequenceBuffer >> 35) & 0x01;     // parity bit hours
-  _dayOfMonth = (_sequenceBuffer >> 36) & 0x3F;         // day of the month = bit 36-41
-  _dayOfWeek = (_sequenceBuffer >> 42) & 0x07;          // day of the week = bit 42-44
-  _month = (_sequenceBuffer >> 45) & 0x1F;              // month = bit 45-49
-  _year = (_sequenceBuffer >> 50) & 0xFF;               // year = bit 50-57
-  _parityBitDate = (_sequenceBuffer >> 58) & 0x01;      // parity bit date
+  TimeCalc::DateTime expectedTime = TimeCalc::nextMinute(_lastTime);
+  uint64_t bits = frame.bits;
+  uint8_t zone = (bits >> DCF77Bit::ZONE) & 0x03;   // CET: Z2, CEST: Z1
+  _leapSecond = (bits >> DCF77Bit::LEAP_ANNOUNCE) & 0x01;   // If true a leap second is set in the following hour
+  _startBit = (bits >> DCF77Bit::START) & 0x01;             // startbit = 20 must be one!
+  _minutes = (bits >> DCF77Bit::MINUTES) & 0x7F;            // minute = 21-27
+  _parityBitMinutes = (bits >> DCF77Bit::PARITY_MINUTES) & 0x01;
+  _hours = (bits >> DCF77Bit::HOURS) & 0x3F;                // hour = bit 29-34
+  _parityBitHours = (bits >> DCF77Bit::PARITY_HOURS) & 0x01;
+  _dayOfMonth = (bits >> DCF77Bit::DATE) & 0x3F;            // day of the month = bit 36-41
+  _dayOfWeek = (bits >> DCF77Bit::DAY_OF_WEEK) & 0x07;      // day of the week = bit 42-44
+  _month = (bits >> DCF77Bit::MONTH) & 0x1F;                // month = bit 45-49
+  _year = (bits >> DCF77Bit::YEAR) & 0xFF;                  // year = bit 50-57
+  _parityBitDate = (bits >> DCF77Bit::PARITY_DATE) & 0x01;
 
   //
   // if startbit is zero anything went wrong.
@@ -169,61 +842,139 @@ bool DCF77Clock::decodeSequence() {
     if ((__builtin_parity(_minutes) == _parityBitMinutes) && (__builtin_parity(_hours) == _parityBitHours)) {
       //
       // It is possible that nonsensical time values will also result in correct parity.
-      // That's why an additional check is made.
+      // That's why an additional check is made: The time must follow the time of the previous sequence.
       //
-      _parityTimeOK = !(abs(bcdToDec(_minutes) - ((bcdToDec(_oldMinutes) + 1) % 60)) ||
-                        abs(bcdToDec(_hours) -
-                            ((bcdToDec(_oldHours) + (_minutes ? 0 : 1)) % 24))   // Add 1 if an hour change has occurred
-      );
+      _parityTimeOK = (getDateTime() == expectedTime);
     }
 
-    if (__builtin_parityl((_sequenceBuffer >> 36) & 0x3FFFFF) == _parityBitDate) {   // parity of Date bit 36-57
+    if (__builtin_parityl((bits >> DCF77Bit::DATE) & 0x3FFFFF) == _parityBitDate) {   // parity of Date bit 36-57
       _parityDateOK = true;
     }
-
-#ifdef DEBUG_DCF77_SEQ_ADD_CHECK
-    Serial.print(F("Par Time: "));
-    Serial.println(_parityTimeOK);
-    Serial.print(F("Par Date: "));
-    Serial.println(_parityDateOK);
-    Serial.print(F("hours: "));
-    Serial.println((bcdToDec(_hours)));
-    Serial.print(F("oldHours: "));
-    Serial.println((bcdToDec(_oldHours)));
-    Serial.print(F("minutes: "));
-    Serial.println((bcdToDec(_minutes)));
-    Serial.print(F("oldMinutes: "));
-    Serial.println((bcdToDec(_oldMinutes)));
-    Serial.print(F("Diff. hours   - oldHours + (0|1) (should be zero) : "));
-    Serial.println(abs(bcdToDec(_hours) - ((bcdToDec(_oldHours) + (_minutes ? 0 : 1)) % 24)));
-    Serial.print(F("Diff. minutes - oldMinutes + 1   (should be zero) : "));
-    Serial.println(abs(bcdToDec(_minutes) - ((bcdToDec(_oldMinutes) + 1) % 60)));
-#endif
   }
-  _sequenceBuffer = 0;
-  _sequenceFlag =
-      DCF77Sequence::SEQ_ERROR;   // Prevents multiple evaluation of the time sequence in too short time intervals
-
-#ifdef DEBUG_DCF77_SEQ
-  Serial.print(F("Ls: "));
-  Serial.println(bcdToDec(_leapSecond));
-  Serial.println(F("Date and Time:"));
-  Serial.print(F("Yr : "));
-  Serial.println(bcdToDec(_year));
-  Serial.print(F("Mon: "));
-  Serial.println(bcdToDec(_month));
-  Serial.print(F("DoM: "));
-  Serial.println(bcdToDec(_dayOfMonth));
-  Serial.print(F("DoW: "));
-  Serial.println(_dayOfWeek);
-  Serial.print(F("Hr : "));
-  Serial.println(bcdToDec(_hours));
-  Serial.print(F("Min: "));
-  Serial.println(bcdToDec(_minutes));
-#endif
+  TRACE(DECODE, _startBit | (_parityTimeOK << 1) | (_parityDateOK << 2), (_hours << 8) | _minutes);
+  _lastTime = getDateTime();
+  if (_parityTimeOK && _parityDateOK) { _zone = zone; }
   return (_parityTimeOK && _parityDateOK);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Builds the frame that is sent in the minute before dt (the time
+///        at the next minute mark), with the layout of decodeSequence().
+///        Bits 0-16 (weather, call bit, announcement of a zone change) and
+///        the leap second announcement are 0. The parity bits make the
+///        number of ones even.
+///
+/// @param dt         Time of the next minute mark (the seconds are ignored)
+/// @param zone       DCF77_ZONE_CET or DCF77_ZONE_CEST
+/// @return uint64_t  Bit n = second n
+//////////////////////////////////////////////////////////////////////////////
+uint64_t DCF77Clock::encodeSequence(const TimeCalc::DateTime &dt, uint8_t zone) {
+  uint8_t minutes = BCDConv::decToBcd(dt.minute);
+  uint8_t hours = BCDConv::decToBcd(dt.hour);
+  uint32_t date = BCDConv::decToBcd(dt.day) | (static_cast<uint32_t>(TimeCalc::dayOfWeek(dt)) << 6) |
+                  (static_cast<uint32_t>(BCDConv::decToBcd(dt.month)) << 9) |
+                  (static_cast<uint32_t>(BCDConv::decToBcd(dt.year)) << 14);   // Bits 36-57
+  uint64_t bits = static_cast<uint64_t>(zone & 0x03) << DCF77Bit::ZONE;
+  bits |= 1ULL << DCF77Bit::START;
+  bits |= static_cast<uint64_t>(minutes) << DCF77Bit::MINUTES;
+  bits |= static_cast<uint64_t>(__builtin_parity(minutes)) << DCF77Bit::PARITY_MINUTES;
+  bits |= static_cast<uint64_t>(hours) << DCF77Bit::HOURS;
+  bits |= static_cast<uint64_t>(__builtin_parity(hours)) << DCF77Bit::PARITY_HOURS;
+  bits |= static_cast<uint64_t>(date) << DCF77Bit::DATE;
+  bits |= static_cast<uint64_t>(__builtin_parityl(date)) << DCF77Bit::PARITY_DATE;
+  return bits;
+}
+
+#ifdef PARTIAL_FRAMES
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Decodes the fields of the last RTC minute (fetchPartial()). A
+///        field is kept if all its bits and its parity bit have been
+///        received, the parity is even and the value is plausible. The
+///        start bit must have been received, the zone bits must be valid
+///        if they have been received.
+///        The time is assembled when the last two captures of every field
+///        give the same offset to the RTC (captureOffset()), like the two
+///        consecutive sequences of decodeSequence(). getDateTime() is then
+///        the time at the start of the current RTC minute, getLastEdge()
+///        gives the RTC-aligned second.
+///
+/// @return true    The time has been assembled with a field of this minute
+/// @return false   No new RTC minute or not all fields confirmed
+//////////////////////////////////////////////////////////////////////////////
+bool DCF77Clock::decodePartial() {
+  DCF77Partial partial;
+  if (!fetchPartial(partial)) { return false; }
+  uint32_t minute = partial.minute / TimeCalc::SECONDS_PER_MINUTE;
+  uint8_t zone = (partial.bits >> DCF77Bit::ZONE) & 0x03;
+  bool zoneReceived = ((partial.received >> DCF77Bit::ZONE) & 0x03) == 0x03;
+  bool startBit = (partial.received & partial.bits) >> DCF77Bit::START & 0x01;
+  uint8_t captured = 0;
+  // A shifted alignment moves other bits to these positions.
+  if (startBit && (!zoneReceived || zone == DCF77_ZONE_CET || zone == DCF77_ZONE_CEST)) {
+    for (uint8_t field = 0; field < PARTIAL_FIELDS; ++field) {
+      uint8_t first = pgm_read_byte(&PARTIAL_FIELD[field].first);
+      uint32_t mask = (1UL << pgm_read_byte(&PARTIAL_FIELD[field].length)) - 1;
+      if (((partial.received >> first) & mask) != mask) { continue; }
+      uint32_t value = (partial.bits >> first) & mask;
+      if (__builtin_parityl(value)) { continue; }   // Even parity of the field and its parity bit
+      value &= mask >> 1;
+      if (!isPlausible(field, value)) { continue; }
+      _captures[field][0] = _captures[field][1];
+      _captures[field][1] = PartialCapture{minute, value};
+      captured |= 1 << field;
+    }
+  }
+  int32_t offset;
+  bool assembled = captured && partialOffset(offset);
+  TRACE(PARTIAL, captured | (assembled << 3), __builtin_popcountll(partial.received));
+  if (!assembled) { return false; }
+  TimeCalc::DateTime dt = TimeCalc::fromEpoch((minute + offset) * TimeCalc::SECONDS_PER_MINUTE);
+  _minutes = BCDConv::decToBcd(dt.minute);
+  _hours = BCDConv::decToBcd(dt.hour);
+  _dayOfMonth = BCDConv::decToBcd(dt.day);
+  _month = BCDConv::decToBcd(dt.month);
+  _year = BCDConv::decToBcd(dt.year);
+  _dayOfWeek = TimeCalc::dayOfWeek(dt);
+  _leapSecond = false;
+  _lastTime = dt;
+  if (zoneReceived) { _zone = zone; }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Offset DCF77 time - RTC time (minutes), if both captures of every
+///        field give the same one. Each field needs the offset of the field
+///        below.
+///
+/// @param offset   Offset in minutes
+/// @return true    All fields confirmed
+//////////////////////////////////////////////////////////////////////////////
+bool DCF77Clock::partialOffset(int32_t &offset) const {
+  offset = 0;
+  for (uint8_t field = 0; field < PARTIAL_FIELDS; ++field) {
+    const PartialCapture &previous = _captures[field][0];
+    const PartialCapture &last = _captures[field][1];
+    if (previous.minute == 0) { return false; }
+    int32_t lower = offset;
+    offset = captureOffset(field, last.minute, last.value, lower);
+    if (captureOffset(field, previous.minute, previous.value, lower) != offset) { return false; }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Forgets the captured fields. Must be called when the RTC has been
+///        set: the captures refer to the RTC minutes.
+///
+//////////////////////////////////////////////////////////////////////////////
+void DCF77Clock::clearPartial() {
+  for (auto &captures : _captures) {
+    captures[0].minute = 0;
+    captures[1].minute = 0;
+  }
+}
+#endif
+
 //////////////////////////////////////////////////////////////////////////////
 /// @brief Return LeapSecond
 ///
@@ -244,6 +995,25 @@ uint8_t DCF77Clock::getHours() const { return bcdToDec(_hours); }
 uint8_t DCF77Clock::getDay() const { return bcdToDec(_dayOfMonth); }
 uint8_t DCF77Clock::getMonth() const { return bcdToDec(_month); }
 uint8_t DCF77Clock::getYear() const { return bcdToDec(_year); }
+uint8_t DCF77Clock::getDayOfWeek() const { return _dayOfWeek; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Time zone bits of the last valid sequence (DCF77_ZONE_CET before
+///        the first one).
+///
+/// @return uint8_t   DCF77_ZONE_CET or DCF77_ZONE_CEST
+//////////////////////////////////////////////////////////////////////////////
+uint8_t DCF77Clock::getZone() const { return _zone; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the received date and time. The sequence is evaluated at
+///        the minute mark, so the seconds are always 0.
+///
+/// @return TimeCalc::DateTime
+//////////////////////////////////////////////////////////////////////////////
+TimeCalc::DateTime DCF77Clock::getDateTime() const {
+  return TimeCalc::fromBcd(_year, _month, _dayOfMonth, _hours, _minutes, 0);
+}
 uint8_t DCF77Clock::getBcdMinutes() const { return _minutes; }
 uint8_t DCF77Clock::getBcdHours() const { return _hours; }
 uint8_t DCF77Clock::getBcdDay() const { return _dayOfMonth; }
@@ -9,6 +9,59 @@
 /// @date 2022-06-03
 /// bool DCF77Receive::wasLastSignalLong() added
 ///
+/// @date 2022-11-05
+/// Time stamp (micros) and second index of the last second mark added
+/// (getEdgeCount(), getLastEdge()). Needed to align the RTC phase.
+///
+/// @date 2022-11-12
+/// Plausibility check with TimeCalc::nextMinute(). getDateTime() added.
+///
+/// @date 2022-11-19
+/// setSequenceCallback() added. Informs the scheduler about a complete sequence.
+///
+/// @date 2022-12-24
+/// Deglitch stage between the interrupt and the bit classification: spikes shorter than
+/// the minimum pulse width are rejected, dropouts shorter than the minimum gap width are
+/// merged into the pulse (setDeglitch(), getGlitchCount()).
+///
+/// @date 2022-12-31
+/// Reception quality (getQuality()): pulse width error, spikes, missed seconds and the
+/// current second, updated with every second mark.
+///
+/// @date 2023-01-28
+/// Adaptive thresholds: the 0/1 boundary is placed between the two clusters of a pulse
+/// width histogram, the minute boundary follows the measured second period
+/// (setAdaptive(), getThresholds()). The THRESHOLD_DUR_* constants are the start values.
+///
+/// @date 2023-02-04
+/// Frame mailbox: at the minute mark the ISR publishes the complete frame (bits, length,
+/// receive time) and starts the next one in its own buffer (fetchFrame(), discardFrame(),
+/// getFramesLost()).
+/// The next minute is received while the previous one is decoded.
+/// After an incomplete minute the second index of getLastEdge() is NO_SECOND.
+/// getFrameCount() for the supervision of the reception.
+///
+/// @date 2023-02-11
+/// Frame layout (DCF77Bit) shared by decodeSequence() and encodeSequence(). The time
+/// zone bits of the last valid sequence (getZone()).
+///
+/// @date 2023-02-11
+/// Build flag PARTIAL_FRAMES: the bits are also placed at their second of the RTC minute
+/// (setRtcTime(), rtcTick()). decodePartial() assembles the time from the fields of
+/// incomplete minutes (fetchPartial()).
+///
+/// @date 2023-02-11
+/// getSequence(): bits and last second mark of the minute being received, also in an
+/// incomplete minute (verify mode of the firmware).
+///
+/// @date 2023-02-18
+/// A second mark is accepted at the end of its pulse: getEdgeCount() changes up to the pulse
+/// width after the time stamp of getLastEdge().
+///
+/// @date 2023-02-25
+/// updateThresholds(): the 0/1 boundary is moved in the main context (call it while the
+/// receiver is on), the ISR only counts the pulse widths.
+///
 /// @copyright Copyright (c) 2022
 ///
 //////////////////////////////////////////////////////////////////////////////
@@ -17,29 +70,159 @@
 #define _DCF77_HPP_
 
 #include <stdint.h>
+#include "timecalc.hpp"
 
 constexpr uint16_t THRESHOLD_DUR_MINUTE{1500};
 constexpr uint8_t THRESHOLD_DUR_LONG_SIGNAL{150};
 constexpr uint8_t THRESHOLD_DUR_SHORT_SIGNAL{85};
-constexpr uint8_t HOUR_CHANGE{59};
+constexpr uint8_t THRESHOLD_SHORT_MIN{60};      // Limits of the adaptive thresholds (ms)
+constexpr uint8_t THRESHOLD_SHORT_MAX{110};
+constexpr uint8_t THRESHOLD_LONG_MIN{115};
+constexpr uint8_t THRESHOLD_LONG_MAX{210};
+constexpr uint16_t THRESHOLD_MINUTE_MIN{1250};
+constexpr uint16_t THRESHOLD_MINUTE_MAX{1800};
+constexpr uint8_t DEGLITCH_MIN_PULSE{50};   // Shorter pulses (ms) are spikes
+constexpr uint8_t DEGLITCH_MIN_GAP{50};     // Shorter gaps (ms) are dropouts inside a pulse
+
+constexpr uint16_t QUALITY_NO_SIGNAL{2500};   // No second mark for this time (ms): score 0
+constexpr uint16_t QUALITY_RESTART{10000};    // Longer pauses (receiver off) restart the quality metric
 
 enum DCF77Sequence { SEQ_ERROR, MAX_SECONDS = 59U, LEAP_SECOND = 60U };
 
+// Position of the information in the frame (bit n = second n)
+namespace DCF77Bit {
+constexpr uint8_t ZONE{17};             // Z1 (CEST), Z2 (CET)
+constexpr uint8_t LEAP_ANNOUNCE{19};    // A leap second is inserted at the end of the hour
+constexpr uint8_t START{20};            // Always 1
+constexpr uint8_t MINUTES{21};          // BCD, 7 bit
+constexpr uint8_t PARITY_MINUTES{28};   // Even parity of the minutes
+constexpr uint8_t HOURS{29};            // BCD, 6 bit
+constexpr uint8_t PARITY_HOURS{35};
+constexpr uint8_t DATE{36};             // Day of the month, BCD, 6 bit (start of the date parity)
+constexpr uint8_t DAY_OF_WEEK{42};      // 1 = Monday ... 7 = Sunday
+constexpr uint8_t MONTH{45};            // BCD, 5 bit
+constexpr uint8_t YEAR{50};             // BCD, 8 bit
+constexpr uint8_t PARITY_DATE{58};      // Even parity of the bits 36-57
+}   // namespace DCF77Bit
+constexpr uint8_t DCF77_ZONE_CEST{0x01};   // Bits ZONE ... ZONE + 1
+constexpr uint8_t DCF77_ZONE_CET{0x02};
+constexpr uint8_t NO_SECOND{0xFF};   // getLastEdge(): second unknown (incomplete minute)
+#ifdef PARTIAL_FRAMES
+constexpr uint8_t PARTIAL_FIELDS{3};   // Minutes, hours, date (each with its own parity bit)
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Reception quality. The values are moving averages over about
+///        16 seconds.
+///
+//////////////////////////////////////////////////////////////////////////////
+struct DCF77Quality {
+  uint8_t score;        // 0 (no signal) ... 99 (undisturbed)
+  uint8_t pulseError;   // Mean deviation of the pulse widths from 100/200 ms (ms)
+  uint8_t spikes;       // Spikes and dropouts per minute
+  uint8_t missed;       // Missed second marks per minute
+  uint8_t second;       // Current second (0-59)
+};
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Decision boundaries of the pulse classification (ms).
+///        Pulses up to shortPulse are ignored, longer pulses than longPulse
+///        are a 1. A gap longer than minute is the minute mark.
+///
+//////////////////////////////////////////////////////////////////////////////
+struct DCF77Thresholds {
+  uint8_t shortPulse;
+  uint8_t longPulse;
+  uint16_t minute;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Complete frame, published by the ISR at the minute mark.
+///
+//////////////////////////////////////////////////////////////////////////////
+struct DCF77Frame {
+  uint64_t bits;      // Bit n = second n
+  uint32_t micros;    // TimeBase::micros() at the minute mark (start of second 0 of the next minute)
+  uint8_t length;     // MAX_SECONDS or LEAP_SECOND
+};
+
+#ifdef PARTIAL_FRAMES
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Bits of one RTC minute at their RTC-aligned second, also of an
+///        incomplete minute. Published by the RTC tick of second 1.
+///
+//////////////////////////////////////////////////////////////////////////////
+struct DCF77Partial {
+  uint64_t bits;       // Bit n = second n of the RTC minute
+  uint64_t received;   // Seconds with a classified pulse
+  uint32_t minute;     // RTC time (TimeCalc epoch) of the minute mark at the end of the frame
+};
+#endif
+
 class DCF77Receive {
 private:
   static bool _activeLow;
-  static uint16_t _duration;
-  static uint32_t _lastInt;
+  static uint16_t _duration;   // Time since the previous edge (not filtered)
+  static uint32_t _lastEdge;
+  static uint32_t _lastRise;      // Start of the current pulse
+  static uint32_t _riseMicros;    // Start of the current pulse (micros)
+  static uint32_t _lastFall;      // End of the last accepted pulse
+  static uint32_t _lastRawFall;   // Last falling edge, also of rejected spikes
+  static uint16_t _pulseWidth;    // Width of the pulse waiting for classification
+  static bool _pulsePending;
+  static bool _pulseAccepted;     // The current pulse has started a second
+  static uint8_t _minPulse;
+  static uint8_t _minGap;
+  static volatile uint16_t _glitchCount;
+  static uint16_t _lastGlitchCount;   // _glitchCount at the previous second mark
+  static uint32_t _lastSecond;        // Start of the previous second mark
+  static uint16_t _pulseErrorAvg;     // Moving averages (x16 ms, x256 per second)
+  static uint16_t _spikesAvg;
+  static uint16_t _missedAvg;
   static bool _longSig;
+  static bool _adaptive;
+  static volatile uint8_t _pulseHist[];   // Pulse widths, see PULSE_HIST_* in dcf77.cpp
+  static volatile uint8_t _pulseHistNew;  // Pulses since the last updateThresholds()
+  static uint16_t _periodAvg;         // Moving average of the second period (x16 ms)
+  static uint8_t _shortThreshold;
+  static uint8_t _longThreshold;
+  static uint16_t _minuteThreshold;
 
 protected:
   static uint8_t _intPin;
   static uint8_t _seconds;
-  static uint64_t _sequenceBuffer;
-  static DCF77Sequence _sequenceFlag;
+  static uint64_t _sequenceBuffer;   // Frame being received (ISR only)
+  static DCF77Frame _frame;          // Last complete frame (mailbox)
+  static volatile uint8_t _frameCount;
+  static uint8_t _frameRead;         // _frameCount of the last fetched frame
+  static uint8_t _framesLost;
+  static volatile uint8_t _edgeCount;
+  static volatile uint8_t _edgeSecond;
+  static volatile uint32_t _edgeMicros;
+  static void (*_onSequence)(void);
+#ifdef PARTIAL_FRAMES
+  static volatile uint8_t _rtcSecond;   // RTC second (0-59) that started at _rtcSecondMicros, NO_SECOND: no RTC time
+  static uint32_t _rtcSecondMicros;
+  static uint32_t _rtcMinute;           // RTC time (TimeCalc epoch) at the start of the RTC minute
+  static bool _rtcAligned;              // A minute mark started RTC second 0
+  static uint8_t _alignedSecond;        // RTC second of the current second mark
+  static uint64_t _alignedBits;         // RTC minute being received (ISR only)
+  static uint64_t _alignedReceived;
+  static DCF77Partial _partial;         // Last published RTC minute (mailbox)
+  static volatile uint8_t _partialCount;
+  static uint8_t _partialRead;
+#endif
 
 private:
   static void receiveSequence(void);
+  static void secondStart(uint32_t, uint32_t);
+  static void classifyPulse(uint16_t);
+  static void updateQuality(bool);
+  static void countPulse(uint16_t);
+  static void adaptMinuteThreshold(uint32_t);
+#ifdef PARTIAL_FRAMES
+  static uint8_t rtcAlignedSecond(uint32_t);
+#endif
 
 protected:
   DCF77Receive(void){};
@@ -50,14 +233,34 @@ public:
   void begin(void);
   void begin(uint8_t);
   void setActiveLow(bool);
+  void setDeglitch(uint8_t, uint8_t);
+  uint16_t getGlitchCount(void);
+  DCF77Quality getQuality(void);
+  void setAdaptive(bool);
+  void updateThresholds(void);
+  DCF77Thresholds getThresholds(void);
   DCF77Sequence getSequenceFlag(void);
+  bool fetchFrame(DCF77Frame &);
+  uint8_t getFrameCount(void);
+  void discardFrame(void);
+  uint8_t getFramesLost(void);
   bool wasLastSignalLong(void);
+  uint8_t getEdgeCount(void);
+  uint8_t getLastEdge(uint32_t &);
+  uint8_t getSequence(uint64_t &, uint32_t &);
+  void setSequenceCallback(void (*)(void));
+#ifdef PARTIAL_FRAMES
+  bool needsRtcTime(void);
+  void setRtcTime(uint32_t);
+  void rtcTick(uint32_t);
+  void resyncRtc(void);
+  bool fetchPartial(DCF77Partial &);
+#endif
 };
 
 class DCF77Clock : public DCF77Receive {
 private:
-  uint8_t _oldMinutes;
-  uint8_t _oldHours;
+  TimeCalc::DateTime _lastTime;   // Time of the previous sequence for the plausibility check
 
   // uint8_t switchMEZ;
   // uint8_t summertime;
@@ -74,16 +277,26 @@ private:
   bool _parityBitDate;
   bool _parityTimeOK;
   bool _parityDateOK;
+  uint8_t _zone{DCF77_ZONE_CET};   // Of the last valid sequence
+#ifdef PARTIAL_FRAMES
+  struct PartialCapture {
+    uint32_t minute;   // RTC minute (epoch / 60) of the minute mark at the end of the frame, 0 = none
+    uint32_t value;    // Bits of the field without the parity bit
+  };
+  PartialCapture _captures[PARTIAL_FIELDS][2]{};   // Previous and last capture of every field
 
-private:
-  uint8_t bcdToDec(uint8_t bcd) const {   // inline
-    return bcd - 6 * (bcd >> 4);
-  }
+  bool partialOffset(int32_t &) const;
+#endif
 
 public:
   DCF77Clock(void) : DCF77Receive(){};
 
   bool decodeSequence(void);
+  static uint64_t encodeSequence(const TimeCalc::DateTime &, uint8_t);
+#ifdef PARTIAL_FRAMES
+  bool decodePartial(void);
+  void clearPartial(void);
+#endif
   bool getLeapSecond(void) const;
   uint8_t getSeconds(void) const;
   uint8_t getMinutes(void) const;
@@ -91,6 +304,9 @@ public:
   uint8_t getDay(void) const;
   uint8_t getMonth(void) const;
   uint8_t getYear(void) const;
+  uint8_t getDayOfWeek(void) const;
+  uint8_t getZone(void) const;
+  TimeCalc::DateTime getDateTime(void) const;
 
   uint8_t getBcdMinutes(void) const;
   uint8_t getBcdHours(void) const;
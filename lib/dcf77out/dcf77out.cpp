@@ -0,0 +1,113 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file dcf77out.cpp
+/// @author Kai R.
+/// @brief DCF77 time code output (DCF77_OUTPUT).
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#if defined(DCF77_OUTPUT) && defined(RTC_TIMEBASE)
+#include <Arduino.h>
+#include <digitalWriteFast.h>
+#include "dcf77out.hpp"
+#include "dcf77.hpp"
+#include "timebase.hpp"
+#include "timecalc.hpp"
+
+namespace {
+uint64_t bits{0};                  // Frame of the current minute
+uint64_t nextBits{0};              // Frame of the next minute
+volatile bool nextValid{false};
+volatile uint8_t second{NO_SECOND};   // Second that starts with the next tick
+volatile bool pulse{false};
+
+void endPulse() {
+  digitalWriteFast(DCF77Out::PIN, DCF77Out::ACTIVE_LOW ? HIGH : LOW);
+  pulse = false;
+}
+}   // namespace
+
+namespace DCF77Out {
+void begin() {
+  pinModeFast(PIN, OUTPUT);
+  digitalWriteFast(PIN, ACTIVE_LOW ? HIGH : LOW);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Start of an RTC second (interrupt). Starts the pulse of the
+///        second, at the end of the minute the next frame is taken over.
+///        Without a time (setTime()) nothing is sent.
+///
+/// @return true    A pulse has been started, Timer1 must run until it ends
+/// @return false   No pulse (minute mark, no time)
+//////////////////////////////////////////////////////////////////////////////
+bool tick() {
+  if (second == NO_SECOND) { return false; }
+  if (second == TimeCalc::SECONDS_PER_MINUTE) {
+    if (!nextValid) {   // The frame was not prepared in time
+      second = NO_SECOND;
+      return false;
+    }
+    bits = nextBits;
+    nextValid = false;
+    second = 0;
+  }
+  uint8_t index = second++;
+  if (index >= MAX_SECONDS) { return false; }
+  bool one = (bits >> index) & 1;
+  digitalWriteFast(PIN, ACTIVE_LOW ? LOW : HIGH);
+  pulse = true;
+  TimeBase::after(one ? PULSE_1 : PULSE_0, endPulse);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The output needs the RTC time: no time yet, after resync() or
+///        the frame of the next minute is missing (once a minute).
+///
+//////////////////////////////////////////////////////////////////////////////
+bool needsTime() { return second == NO_SECOND || !nextValid; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the frame of the next minute. Must be called in the second
+///        that has been read (after its tick). If the second does not fit
+///        the count of the ticks (first call, RTC set), the frame of the
+///        current minute is set too and the output continues with the next
+///        second.
+///
+/// @param epoch    RTC time (TimeCalc epoch)
+/// @param zone     DCF77_ZONE_CET or DCF77_ZONE_CEST
+//////////////////////////////////////////////////////////////////////////////
+void setTime(uint32_t epoch, uint8_t zone) {
+  uint8_t current = epoch % TimeCalc::SECONDS_PER_MINUTE;
+  uint32_t minute = epoch - current;
+  bool counted = (second == current + 1);
+  uint64_t frame = 0;
+  if (!counted) {
+    frame = DCF77Clock::encodeSequence(TimeCalc::fromEpoch(minute + TimeCalc::SECONDS_PER_MINUTE), zone);
+  }
+  uint64_t next = DCF77Clock::encodeSequence(TimeCalc::fromEpoch(minute + 2 * TimeCalc::SECONDS_PER_MINUTE), zone);
+  noInterrupts();
+  if (!counted) {
+    bits = frame;
+    second = current + 1;
+  }
+  nextBits = next;
+  nextValid = true;
+  interrupts();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Stops the output until the next setTime(), e.g. after the RTC has
+///        been set (the second may start again with an additional edge).
+///
+//////////////////////////////////////////////////////////////////////////////
+void resync() { second = NO_SECOND; }
+
+bool isPulse() { return pulse; }
+}   // namespace DCF77Out
+#endif
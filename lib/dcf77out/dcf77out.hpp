@@ -0,0 +1,47 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file dcf77out.hpp
+/// @author Kai R.
+/// @brief Declaration of the DCF77 time code output (build flag DCF77_OUTPUT)
+///        for slave clocks with a DCF77 input.
+///        The clock sends the frames of its RTC time at PIN like a DCF77
+///        receiver module: a pulse of 100 ms (0) or 200 ms (1) at the start
+///        of every second, no pulse in second 59 (minute mark). The frame
+///        sent in a minute holds the time of the next minute mark
+///        (DCF77Clock::encodeSequence()).
+///        The pulse starts at the edge of the RTC 1Hz signal that begins
+///        the second (tick(), called by the pin change interrupt). It ends
+///        after PULSE_0 or PULSE_1 ticks of Timer1, which counts the 32 kHz
+///        output of the RTC (lib/timebase, RTC_TIMEBASE is required). The
+///        jitter of both edges is the interrupt latency, the pulse widths
+///        are as accurate as the RTC.
+///        The frames come from the RTC time (setTime(), once a minute). The
+///        RTC has no leap seconds, the time zone bits are those of the last
+///        received DCF77 sequence.
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DCF77OUT_HPP_
+#define _DCF77OUT_HPP_
+
+#include <stdint.h>
+
+namespace DCF77Out {
+constexpr uint8_t PIN{17};              // PC0 (A0)
+constexpr bool ACTIVE_LOW{false};       // Level of the pulses: HIGH
+constexpr uint16_t PULSE_0{3277};       // 100 ms in 1/32768 s
+constexpr uint16_t PULSE_1{6554};       // 200 ms
+
+void begin(void);
+bool tick(void);
+bool needsTime(void);
+void setTime(uint32_t, uint8_t);
+void resync(void);
+bool isPulse(void);
+}   // namespace DCF77Out
+
+#endif
@@ -10,14 +10,52 @@
 /// Refactornig, added animated dots to the time display.
 /// The behavior of the backlight button has been changed. Two switching modes are now possible.
 ///
+/// @date 2022-11-26
+/// isBacklightOn() added. The backlight PWM needs the timer, so the MCU must not power down.
+///
+/// @date 2022-12-03
+/// The RTC is read with boosted clock (lib/cpuclock). The display is written with 1 MHz.
+///
+/// @date 2022-12-10
+/// The time is read with one burst. PRINT_TIME_SERIAL replaced by a trace point (lib/trace).
+///
+/// @date 2022-12-31
+/// printQuality() added.
+///
+/// @date 2023-01-07
+/// setDate(): the string end was written behind the date buffer.
+///
+/// @date 2023-01-14
+/// Constant bit patterns and strings are kept in flash (PROGMEM) instead of RAM.
+///
+/// @date 2023-01-21
+/// With RTC_TIMEBASE Timer1 is switched to PWM mode only while the backlight is on.
+///
+/// @date 2023-02-04
+/// limitBacklight(): brightness and duration of the backlight can be reduced (low battery).
+///
+/// @date 2023-02-11
+/// The RTC is accessed through lib/rtc (DS3231 or RV-3028). The date is read with one burst.
+///
 /// @copyright Copyright (c) 2022
 ///
 //////////////////////////////////////////////////////////////////////////////
 
 #include "display.hpp"
 #include "bcdconv.hpp"
-#include "DS3231Wire.h"
+#include "cpuclock.hpp"
+#include "rtc.hpp"
+#include "timebase.hpp"
+#include "trace.hpp"
+
+static bool backlightOn = false;
+static uint8_t lightOffTime;
+static uint8_t blBrightness = BL_BRIGHTNESS_ON;
+static uint8_t blDuration = BL_BURN_DURATION;
 
+// Bit patterns of the self defined chars 0x01 and 0x02 (flash, only needed in initDisplay)
+static const uint8_t halfColonUp[8] PROGMEM = {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00};
+static const uint8_t halfColonDown[8] PROGMEM = {0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00, 0x00};
 
 // Methods of ClockSeparators //////////////////////////////////////////////////////
 
@@ -57,14 +95,17 @@ uint8_t ClockSeparators::getSeparatorChar(Separators sep) const { return separat
 //////////////////////////////////////////////////////////////////////////////
 void ClockData::setTime() {
   static bool switchSep = true;
+  uint8_t rtc[RTC::HOURS + 1];
+  RTC::readTime(rtc, sizeof(rtc));
+  TRACE(RTC_TIME, rtc[RTC::SECONDS], (rtc[RTC::HOURS] << 8) | rtc[RTC::MINUTES]);
   // Looks complicated, but it saves many flash space (-1.5Kb) compared to sprintf.
   *(_strTimeBuff + 8) = '\0';
-  BCDConv::bcdTochar((_strTimeBuff + 6), DS3231::readRegister(DS3231::SECONDS));
+  BCDConv::bcdTochar((_strTimeBuff + 6), rtc[RTC::SECONDS]);
   *(_strTimeBuff + 5) = separator.getSeparatorChar(separator.getTimeSeparator(switchSep));
   switchSep = !switchSep;
-  BCDConv::bcdTochar((_strTimeBuff + 3), DS3231::readRegister(DS3231::MINUTES));
+  BCDConv::bcdTochar((_strTimeBuff + 3), rtc[RTC::MINUTES]);
   *(_strTimeBuff + 2) = separator.getSeparatorChar(Separators::TIME);
-  BCDConv::bcdTochar(_strTimeBuff, DS3231::readRegister(DS3231::HOURS));
+  BCDConv::bcdTochar(_strTimeBuff, rtc[RTC::HOURS]);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -73,15 +114,17 @@ void ClockData::setTime() {
 ///
 //////////////////////////////////////////////////////////////////////////////
 void ClockData::setDate() {
-  BCDConv::bcdTochar(_strDateBuff, DS3231::readRegister(DS3231::DATE));
+  uint8_t rtc[RTC::TIME_REGS];
+  RTC::readTime(rtc, sizeof(rtc));
+  BCDConv::bcdTochar(_strDateBuff, rtc[RTC::DATE]);
   *(_strDateBuff + 2) = separator.getSeparatorChar(Separators::DATE);
-  BCDConv::bcdTochar((_strDateBuff + 3), DS3231::readRegister(DS3231::CEN_MONTH));
+  BCDConv::bcdTochar((_strDateBuff + 3), rtc[RTC::MONTH] & RTC::MONTH_MASK);
   *(_strDateBuff + 5) = separator.getSeparatorChar(Separators::DATE);
   // *(strDateBuff+6) = '2';                         //change it 2099 :-)
   // *(strDateBuff+7) = '0';
   // bcdTochar((strDateBuff+8),readRegister(DS3231_YEAR));
-  BCDConv::bcdTochar((_strDateBuff + 6), DS3231::readRegister(DS3231::YEAR));
-  *(_strDateBuff + 10) = '\0';
+  BCDConv::bcdTochar((_strDateBuff + 6), rtc[RTC::YEAR]);
+  *(_strDateBuff + 8) = '\0';
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -113,27 +156,33 @@ ClockSeparators &ClockData::clockSeparator() { return separator; }
 /// @param disp
 //////////////////////////////////////////////////////////////////////////////
 void initDisplay(dogm_7036 &disp) {
-  uint8_t halfColonUp[8] = {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00};
-  uint8_t halfColonDown[8] = {0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00, 0x00};
+  uint8_t pattern[sizeof(halfColonUp)];
 
   // SS = 10, 0,0= use Hardware SPI, 7 = RS, 8 = RESET, 0 = 3.3V, EA DOGM081-A (=1 line)
   disp.initialize(SS, 0, 0, PIN_RS, PIN_RST, 0, DOGM081);
   // disp.initialize(SS,0,0,PIN_RS,PIN_RST,0,DOGM162);
   disp.displ_onoff(true);                  // turn Display on
   disp.cursor_onoff(false);                // turn Curosor blinking off
-  disp.define_char(0x01, halfColonUp);     // define own char on memory adress 1
-  disp.define_char(0x02, halfColonDown);   // define own char on memory adress 2
+  memcpy_P(pattern, halfColonUp, sizeof(pattern));
+  disp.define_char(0x01, pattern);   // define own char on memory adress 1
+  memcpy_P(pattern, halfColonDown, sizeof(pattern));
+  disp.define_char(0x02, pattern);   // define own char on memory adress 2
   pinModeFast(PIN_BACKLIGHT, OUTPUT);
   monoBacklight(
       BL_BRIGHTNESS_OFF);   // use monochrome backlight in this sample code. Please change it to your configuration
 }
 
 //////////////////////////////////////////////////////////////////////////////
-/// @brief Controlling the backlight brightness.
+/// @brief Controlling the backlight brightness. The PWM mode of Timer1 is
+///        only needed while the backlight is on (lib/timebase).
 ///
 /// @param brightness
 //////////////////////////////////////////////////////////////////////////////
-void monoBacklight(byte brightness) { analogWrite(PIN_BACKLIGHT, brightness); }
+void monoBacklight(byte brightness) {
+  if (brightness != BL_BRIGHTNESS_OFF) { TimeBase::setPwm(true); }
+  analogWrite(PIN_BACKLIGHT, brightness);
+  if (brightness == BL_BRIGHTNESS_OFF) { TimeBase::setPwm(false); }
+}
 
 //////////////////////////////////////////////////////////////////////////////
 /// @brief Turns on the backlight when the button is pressed.
@@ -141,19 +190,19 @@ void monoBacklight(byte brightness) { analogWrite(PIN_BACKLIGHT, brightness); }
 ///        switched on for a certain period of time. It then turns itself off
 ///        again. If the button was pressed for a long time (>= 1 second),
 ///        the backlight remains active until the button is pressed again.
+///        While the backlight is limited (limitBacklight()) a long press
+///        acts like a short one.
 ///
 /// @param second             Second of RT-Clock at which the button was pressed
 /// @param blButtonPressed    State of then button (not, short or long pressed)
 //////////////////////////////////////////////////////////////////////////////
 void switchBacklight(uint8_t second, Btn::ButtonState blButtonPressed) {
-  static bool backlightOn = false;
-  static uint8_t lightOffTime;
-
   if (blButtonPressed != Btn::ButtonState::notPressed && !backlightOn) {
+    if (blBrightness == BL_BRIGHTNESS_OFF) { return; }
     backlightOn = true;
-    monoBacklight(BL_BRIGHTNESS_ON);
-    if (blButtonPressed == Btn::ButtonState::shortPressed) {
-      lightOffTime = (second + BL_BURN_DURATION + 1) % MINUTE;   // Mod 60 Seconds
+    monoBacklight(blBrightness);
+    if (blButtonPressed == Btn::ButtonState::shortPressed || blBrightness != BL_BRIGHTNESS_ON) {
+      lightOffTime = (second + blDuration + 1) % MINUTE;   // Mod 60 Seconds
     } else {
       lightOffTime = MINUTE_IMPOSSIBLE;
     }
@@ -166,26 +215,64 @@ void switchBacklight(uint8_t second, Btn::ButtonState blButtonPressed) {
 }
 
 //////////////////////////////////////////////////////////////////////////////
-/// @brief Output of time and date on the serial console
+/// @brief Limits the brightness and the duration of the backlight.
+///        BL_BRIGHTNESS_OFF: the button is ignored. A backlight that is on
+///        gets the new brightness; if it is on permanently, it is switched
+///        off after the new duration. BL_BRIGHTNESS_ON and BL_BURN_DURATION
+///        remove the limit.
+///
+/// @param second       Current second of the RT-Clock
+/// @param brightness   PWM duty cycle
+/// @param duration     Time in sec
+//////////////////////////////////////////////////////////////////////////////
+void limitBacklight(uint8_t second, uint8_t brightness, uint8_t duration) {
+  blBrightness = brightness;
+  blDuration = duration;
+  if (!backlightOn) { return; }
+  if (brightness == BL_BRIGHTNESS_OFF) {
+    backlightOn = false;
+  } else if (brightness != BL_BRIGHTNESS_ON && lightOffTime == MINUTE_IMPOSSIBLE) {
+    lightOffTime = (second + duration + 1) % MINUTE;
+  }
+  monoBacklight(brightness);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the state of the backlight.
+///
+/// @return true    Backlight is on (PWM active)
+/// @return false   Backlight is off
+//////////////////////////////////////////////////////////////////////////////
+bool isBacklightOn() { return backlightOn; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Output of time or date on the display
 ///
 /// @param rtcTime
 //////////////////////////////////////////////////////////////////////////////
 void printRtcTime(dogm_7036 &disp, ClockData &cd, bool dateVisible) {
+  CpuClock::boost();   // Only reading the RTC. The display timing needs 1 MHz
   switch (dateVisible) {
-    case true:
-      cd.setDate();
-      disp.position(1, 1);
-      disp.string(cd.getDate());
-      break;
-    default:
-      cd.setTime();
-      disp.position(1, 1);
-      disp.string(cd.getTime());
+    case true: cd.setDate(); break;
+    default: cd.setTime();
   }
-#ifdef PRINT_TIME_SERIAL
-  Serial.print("Time is ");
-  Serial.print(cd.getDate());
-  Serial.print(" ");
-  Serial.print(cd.getTime());
-#endif
-}
\ No newline at end of file
+  CpuClock::relax();
+  disp.position(1, 1);
+  disp.string(dateVisible ? cd.getDate() : cd.getTime());
+}
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Output of the DCF77 reception quality: "Q 87 s23"
+///        (score 0-99 and the current second of the DCF77 receiver).
+///
+/// @param disp
+/// @param score    0-99
+/// @param second   0-59
+//////////////////////////////////////////////////////////////////////////////
+void printQuality(dogm_7036 &disp, uint8_t score, uint8_t second) {
+  char str[9];
+  strcpy_P(str, PSTR("Q    s  "));
+  BCDConv::bcdTochar(str + 2, BCDConv::decToBcd(score > 99 ? 99 : score));
+  BCDConv::bcdTochar(str + 6, BCDConv::decToBcd(second > 99 ? 99 : second));
+  disp.position(1, 1);
+  disp.string(str);
+}
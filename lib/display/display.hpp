@@ -23,7 +23,7 @@
 ///          Pin 09: Brightness
 ///
 ///          Pin 04: Button for switching the backlight  4
-///          Pin 05: Button to switch on the date        5
+///          Pin 05: Button to switch on the date        5 (Pin 00 with RTC_TIMEBASE)
 ///
 /// @date 2022-05-01
 /// @version 1.0
@@ -33,6 +33,18 @@
 /// File suffix changed from .h to .hpp.
 /// The behavior of the backlight button has been changed. Two switching modes are now possible.
 ///
+/// @date 2022-11-26
+/// Buttons are interrupt driven (lib/buttons) instead of Button_SL.
+///
+/// @date 2022-12-31
+/// printQuality() shows the DCF77 reception quality.
+///
+/// @date 2023-01-21
+/// With RTC_TIMEBASE the date button is connected to D0 (D5 = T1 is the 32kHz input).
+///
+/// @date 2023-02-04
+/// limitBacklight() reduces brightness and duration of the backlight.
+///
 /// @copyright Copyright (c) 2022
 ///
 //////////////////////////////////////////////////////////////////////////////
@@ -43,7 +55,7 @@
 #include <stdint.h>
 #include <SPI.h>
 #include <digitalWriteFast.h>
-#include <Button_SL.hpp>
+#include "buttons.hpp"
 #include "dogm_7036.h"
 
 //////////////////////////////////////////////////
@@ -53,7 +65,11 @@ constexpr uint8_t PIN_RS{7};          // RS = Read/Write Data from/to RAM (Pin 3
 constexpr uint8_t PIN_RST{8};         // Reset des Displays (Pin 40)
 constexpr uint8_t PIN_BACKLIGHT{9};   // Pin (D9) for backlight brightness control
 constexpr uint8_t BUTTON_BL_PIN{4};   // Pin (D4) for switching the backlight on
+#ifdef RTC_TIMEBASE
+constexpr uint8_t BUTTON_DT_PIN{0};   // Pin (D0) for switching the date view, D5 is the 32kHz input (T1)
+#else
 constexpr uint8_t BUTTON_DT_PIN{5};   // Pin (D5) for switching the date view on the Display
+#endif
 
 // PWM duty cycles for brightness: 0 = off, 255 = max. brightness
 constexpr uint8_t BL_BRIGHTNESS_OFF{0};
@@ -121,5 +137,8 @@ void initDisplay(dogm_7036 &);
 void monoBacklight(byte);
 void printRtcTime(dogm_7036 &, ClockData &, bool);
 void switchBacklight(uint8_t, Btn::ButtonState);
+void limitBacklight(uint8_t, uint8_t, uint8_t);
+bool isBacklightOn(void);
+void printQuality(dogm_7036 &, uint8_t, uint8_t);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file memcheck.cpp
+/// @author Kai R.
+/// @brief Stack painting and RAM usage measurement.
+///
+/// @date 2023-01-14
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include "memcheck.hpp"
+
+#ifdef __AVR__
+#include <avr/io.h>
+
+// Symbols of the linker script
+extern uint8_t _end;      // End of .bss (and .noinit) = start of the heap
+extern uint8_t __stack;   // Top of the stack (RAMEND)
+
+void paintStack(void) __attribute__((naked, used, section(".init3")));
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Fills the free RAM with the PAINT pattern. Called by the C runtime
+///        after the stack pointer has been set (.init2) and before the
+///        variables are initialized (.init4). Naked: no prologue, no return,
+///        so the stack is not used.
+///
+//////////////////////////////////////////////////////////////////////////////
+void paintStack(void) {
+  uint8_t *p = &_end;
+  while (p <= &__stack) { *p++ = MemCheck::PAINT; }
+}
+#endif
+
+namespace MemCheck {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Size of the static data (.data, .bss, .noinit).
+///
+/// @return uint16_t  Bytes
+//////////////////////////////////////////////////////////////////////////////
+uint16_t staticRam() {
+#ifdef __AVR__
+  return &_end - reinterpret_cast<uint8_t *>(RAMSTART);
+#else
+  return 0;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Free RAM between the static data and the current stack pointer.
+///
+/// @return uint16_t  Bytes
+//////////////////////////////////////////////////////////////////////////////
+uint16_t stackFree() {
+#ifdef __AVR__
+  return reinterpret_cast<uint8_t *>(SP) - &_end;
+#else
+  return 0;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Number of painted bytes that have never been used by the stack
+///        since the start (distance between the static data and the
+///        high-water mark of the stack). Takes about 10 CPU cycles per byte.
+///
+/// @return uint16_t  Bytes
+//////////////////////////////////////////////////////////////////////////////
+uint16_t stackUnused() {
+#ifdef __AVR__
+  const uint8_t *p = &_end;
+  while (p <= &__stack && *p == PAINT) { ++p; }
+  return p - &_end;
+#else
+  return 0;
+#endif
+}
+}   // namespace MemCheck
@@ -0,0 +1,36 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file memcheck.hpp
+/// @author Kai R.
+/// @brief Declaration of the RAM usage measurement.
+///        Before the C runtime initializes the variables (section .init3),
+///        the RAM between the end of the static data (_end) and the top of
+///        the stack (__stack) is filled with a pattern (stack painting).
+///        Bytes that still contain the pattern have never been used by the
+///        stack. The lowest changed byte is the high-water mark of the stack.
+///        The painting is linked in with the first use of these functions.
+///
+///        The program does not use the heap (malloc, new). Otherwise the
+///        heap would grow into the painted area from below.
+///
+///        On the host (tools/host) no stack is painted, all values are 0.
+///
+/// @date 2023-01-14
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _MEMCHECK_HPP_
+#define _MEMCHECK_HPP_
+
+#include <stdint.h>
+
+namespace MemCheck {
+constexpr uint8_t PAINT{0xC5};   // Unlikely as return address or register content
+
+uint16_t staticRam(void);
+uint16_t stackFree(void);
+uint16_t stackUnused(void);
+}   // namespace MemCheck
+#endif
@@ -0,0 +1,45 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file rtc.hpp
+/// @author Kai R.
+/// @brief RTC interface with the backend selected at compile time. RTC is an
+///        alias of the namespace of the driver, so the calls cost nothing
+///        compared with calling the driver directly (no virtual functions).
+///        Default: DS3231 (lib/DS3231Wire). Build flag RTC_RV3028: RV-3028-C7
+///        (lib/RV3028Wire), e.g. for boards with a lower quiescent current.
+///
+///        Every backend provides:
+///        - SECONDS ... YEAR, TIME_REGS: time registers (BCD, same layout),
+///          MONTH_MASK removes the century bit of MONTH
+///        - readTime(data, len): burst read of len registers from SECONDS
+///        - writeTime(data): burst write of TIME_REGS registers, the new
+///          second starts with the write
+///        - enable1Hz(): 1Hz signal on the RTC pin. TICK_RISING: the counted
+///          edge, tickPhase(period): time from the start of the RTC second
+///          to the counted edge (microseconds)
+///        - enable32kHz(), disable32kHz(): 32.768 kHz output (RTC_TIMEBASE)
+///        - setTimer(seconds, secondOfDay): alarm ALARM_TIMER in n seconds,
+///          setDailyAlarm(bcdHours, bcdMinutes): alarm ALARM_DAILY,
+///          enableAlarms(), clearAlarms(): the RTC pin is the alarm output
+///          instead of the 1Hz signal
+///        - setCalibration(tenthPpm): rate correction (DS3231: aging offset,
+///          RV-3028: offset)
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _RTC_HPP_
+#define _RTC_HPP_
+
+#ifdef RTC_RV3028
+#include "RV3028Wire.h"
+namespace RTC = RV3028;
+#else
+#include "DS3231Wire.h"
+namespace RTC = DS3231;
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file scheduler.cpp
+/// @author Kai R.
+/// @brief A small cooperative task scheduler.
+///
+/// @date 2022-11-19
+/// @version 1.0
+///
+/// @date 2023-01-28
+/// advance() and remaining() for the time without the 1Hz signal (night mode).
+///
+/// @date 2023-02-18
+/// The sleep mode is requested after the tasks. A task that switched the receiver or
+/// the backlight on sent the MCU to power down in the same pass, so Timer0/Timer1
+/// stopped until the next 1Hz edge.
+///
+/// @date 2023-02-25
+/// Pending seconds are counted. EV_SECOND is a flag, so a task that ran longer than a second
+/// shifted all deadlines and now().
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include "scheduler.hpp"
+
+namespace Sched {
+volatile uint8_t Scheduler::_events{EV_NONE};
+volatile uint8_t Scheduler::_seconds{0};
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets an event. May be called from an interrupt service routine.
+///        EV_SECOND is also counted, so now() does not lose seconds while
+///        a task runs longer than a second.
+///
+/// @param event
+//////////////////////////////////////////////////////////////////////////////
+void Scheduler::signal(uint8_t event) {
+  uint8_t sreg = SREG;
+  cli();
+  _events |= event;
+  if ((event & EV_SECOND) && _seconds != UINT8_MAX) { ++_seconds; }
+  SREG = sreg;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Adds a task. The order of adding is the order of execution.
+///
+/// @param task     Function to be called
+/// @param events   Events that start the task (EV_NONE = deadline only)
+/// @return uint8_t Id of the task or NO_TASK if the table is full
+//////////////////////////////////////////////////////////////////////////////
+uint8_t Scheduler::add(Task task, uint8_t events) {
+  if (_count >= MAX_TASKS) { return NO_TASK; }
+  _tasks[_count] = {task, events, false, 0};
+  return _count++;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Changes the events that start a task.
+///
+/// @param id
+/// @param events
+//////////////////////////////////////////////////////////////////////////////
+void Scheduler::setEvents(uint8_t id, uint8_t events) {
+  if (id < _count) { _tasks[id].events = events; }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The task is started once after the given number of seconds.
+///        A deadline that has already been set is overwritten.
+///
+/// @param id
+/// @param seconds  1 - 32767
+//////////////////////////////////////////////////////////////////////////////
+void Scheduler::setDeadline(uint8_t id, uint16_t seconds) {
+  if (id < _count) {
+    _tasks[id].deadline = _now + seconds;
+    _tasks[id].armed = true;
+  }
+}
+
+void Scheduler::cancelDeadline(uint8_t id) {
+  if (id < _count) { _tasks[id].armed = false; }
+}
+
+bool Scheduler::hasDeadline(uint8_t id) const { return (id < _count) && _tasks[id].armed; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the seconds until the deadline of a task.
+///
+/// @param id
+/// @return uint16_t  0 if the deadline has been reached or is not set
+//////////////////////////////////////////////////////////////////////////////
+uint16_t Scheduler::remaining(uint8_t id) const {
+  if (!hasDeadline(id)) { return 0; }
+  int16_t left = _tasks[id].deadline - _now;
+  return left > 0 ? left : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the number of seconds (EV_SECOND events) since start.
+///        Overflows after 65536 seconds.
+///
+/// @return uint16_t
+//////////////////////////////////////////////////////////////////////////////
+uint16_t Scheduler::now() const { return _now; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Adds seconds that have passed without EV_SECOND events. Deadlines
+///        that have been reached start their tasks with the next EV_SECOND.
+///
+/// @param seconds
+//////////////////////////////////////////////////////////////////////////////
+void Scheduler::advance(uint16_t seconds) { _now += seconds; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Starts all tasks whose events are pending or whose deadline has
+///        been reached. Then the MCU sleeps until the next interrupt, unless
+///        a new event has been set in the meantime. The sleep mode is
+///        requested after the tasks, so it includes their changes.
+///        All seconds signaled since the last call are added to now(). The
+///        tasks of EV_SECOND run once for them.
+///        Must be called in loop().
+///
+/// @param sleepMode  Returns the sleep mode that is possible now
+//////////////////////////////////////////////////////////////////////////////
+void Scheduler::run(SleepMode sleepMode) {
+  cli();
+  uint8_t events = _events | EV_WAKEUP;
+  uint8_t seconds = _seconds;
+  _events = EV_NONE;
+  _seconds = 0;
+  sei();
+
+  _now += seconds;
+  for (uint8_t i = 0; i < _count; ++i) {
+    Entry &t = _tasks[i];
+    bool due = (t.events & events);
+    if (t.armed && seconds && static_cast<int16_t>(_now - t.deadline) >= 0) {
+      t.armed = false;
+      due = true;
+    }
+    if (due) { t.task(); }
+  }
+
+  set_sleep_mode(sleepMode());
+  cli();
+  if (_events == EV_NONE) {
+    sleep_enable();
+#if defined(BODS) && defined(BODSE)
+    sleep_bod_disable();   // Brown-out detector off during sleep (if enabled by fuses)
+#endif
+    sei();   // The instruction after sei() is executed before any interrupt.
+    sleep_cpu();
+    sleep_disable();
+  }
+  sei();
+}
+}   // namespace Sched
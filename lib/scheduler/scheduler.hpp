@@ -0,0 +1,86 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file scheduler.hpp
+/// @author Kai R.
+/// @brief Declaration of a small cooperative task scheduler.
+///        Tasks are started by events (set by interrupts) or by a deadline
+///        in seconds. If no event is pending, the MCU is put to sleep until
+///        the next interrupt. The task table is static, no memory allocation.
+///
+/// @date 2022-11-19
+/// @version 1.0
+///
+/// @date 2023-01-28
+/// EV_ALARM. While the 1Hz signal is off the deadlines stop; advance() catches up
+/// with the seconds that have passed, remaining() is the time left until a deadline.
+/// MAX_TASKS 9: room for the optional tasks (trace, capture, night mode).
+///
+/// @date 2023-02-04
+/// MAX_TASKS 10: battery monitor.
+///
+/// @date 2023-02-11
+/// MAX_TASKS 11: RTC alignment of the DCF77 bits (PARTIAL_FRAMES).
+///
+/// @date 2023-02-18
+/// run() gets the sleep mode from a callback after the tasks have run (SleepMode).
+///
+/// @date 2023-02-25
+/// signal(EV_SECOND) counts the seconds, run() adds all of them to now(). A task that ran longer
+/// than a second lost the seconds that had passed in the meantime.
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SCHEDULER_HPP_
+#define _SCHEDULER_HPP_
+
+#include <stdint.h>
+
+namespace Sched {
+using Task = void (*)(void);
+using SleepMode = uint8_t (*)(void);   // Returns SLEEP_MODE_... (avr/sleep.h)
+
+// Events. They are set in interrupt service routines with Scheduler::signal().
+constexpr uint8_t EV_NONE{0x00};
+constexpr uint8_t EV_SECOND{0x01};   // INT1: 1Hz signal of the RTC. Also the time base for the deadlines.
+constexpr uint8_t EV_DCF77{0x02};    // INT0: DCF77 sequence complete (minute mark)
+constexpr uint8_t EV_BUTTON{0x04};   // A button has been pressed or released
+constexpr uint8_t EV_ALARM{0x08};    // RTC alarm (INT/SQW pin, while the 1Hz signal is off)
+constexpr uint8_t EV_WAKEUP{0x80};   // Every wake-up of the MCU (no ISR needed)
+
+constexpr uint8_t MAX_TASKS{11};
+constexpr uint8_t NO_TASK{0xFF};
+
+class Scheduler {
+private:
+  struct Entry {
+    Task task;
+    uint8_t events;      // Events that start the task
+    bool armed;          // Deadline is active
+    uint16_t deadline;   // Second (see now()) at which the task is started
+  };
+
+  static volatile uint8_t _events;
+  static volatile uint8_t _seconds;   // EV_SECOND signals since the last run()
+  Entry _tasks[MAX_TASKS];
+  uint8_t _count{0};
+  uint16_t _now{0};
+
+public:
+  Scheduler() {}
+  Scheduler(const Scheduler &) = delete;              // prevent copy
+  Scheduler &operator=(const Scheduler &) = delete;   // prevent assignment
+
+  static void signal(uint8_t);
+  uint8_t add(Task, uint8_t);
+  void setEvents(uint8_t, uint8_t);
+  void setDeadline(uint8_t, uint16_t);
+  void cancelDeadline(uint8_t);
+  bool hasDeadline(uint8_t) const;
+  uint16_t remaining(uint8_t) const;
+  uint16_t now(void) const;
+  void advance(uint16_t);
+  void run(SleepMode);
+};
+}   // namespace Sched
+#endif
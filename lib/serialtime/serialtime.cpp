@@ -0,0 +1,208 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file serialtime.cpp
+/// @author Kai R.
+/// @brief Serial time messages with a PPS output (SERIAL_TIME).
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifdef SERIAL_TIME
+#include <Arduino.h>
+#include <digitalWriteFast.h>
+#include "serialtime.hpp"
+#include "timecalc.hpp"
+
+namespace {
+constexpr uint8_t BIT_TICKS{(F_CPU / SerialTime::TIMER0_PRESCALER + SerialTime::BAUD_RATE / 2) /
+                            SerialTime::BAUD_RATE};   // 26 ticks of 8 us = 4808 baud
+constexpr uint8_t BITS_PER_CHAR{10};                  // Start bit, 8 data bits, stop bit
+constexpr uint16_t STOP_BIT{0x200};
+constexpr uint8_t MAX_RUN{9};   // Bits of the same level: the start bit and the stop bit break every longer run
+static_assert(MAX_RUN * BIT_TICKS <= 0xFF, "A run of bits must fit into the 8 bit Timer0");
+
+uint8_t buffer[2][SerialTime::MESSAGE_SIZE];
+volatile uint8_t nextBuffer{0};   // Buffer of the next message
+volatile bool nextValid{false};
+volatile bool known{false};       // The time has been set
+volatile uint32_t epoch{0};       // RTC second that is running
+volatile uint8_t second{0};       // epoch % 60
+volatile bool sending{false};
+uint32_t ageSyncEpoch{0};         // Sync epoch of the cached age
+uint8_t age{SerialTime::AGE_UNKNOWN};
+
+// Interrupt state of the message being sent
+const uint8_t *line;
+uint8_t charIndex;
+uint16_t shift;      // Remaining bits of the current character, next bit in bit 0
+uint8_t bitsLeft;
+bool level;          // Level of the line since the last change
+uint8_t nextRun;     // Ticks of the run after the current one, 0 = end of the message
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Takes the bits of the given level from the line (start bits, data
+///        bits, stop bits) up to the next change. Interrupts must be disabled.
+///
+/// @param runLevel
+/// @return uint8_t   Length of the run in Timer0 ticks, 0 at the end of the message
+//////////////////////////////////////////////////////////////////////////////
+uint8_t takeRun(bool runLevel) {
+  uint8_t ticks = 0;
+  for (;;) {
+    if (bitsLeft == 0) {
+      if (charIndex == SerialTime::MESSAGE_SIZE) { break; }
+      shift = (static_cast<uint16_t>(line[charIndex++]) << 1) | STOP_BIT;
+      bitsLeft = BITS_PER_CHAR;
+    }
+    if (static_cast<bool>(shift & 1) != runLevel) { break; }
+    shift >>= 1;
+    --bitsLeft;
+    ticks += BIT_TICKS;
+  }
+  return ticks;
+}
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Compare match A of Timer0: the next change of the line level. At
+///        the end of the last stop bit the PPS pulse ends.
+///
+//////////////////////////////////////////////////////////////////////////////
+ISR(TIMER0_COMPA_vect) {
+  if (nextRun == 0) {
+    digitalWriteFast(SerialTime::PPS_PIN, LOW);
+    TIMSK0 &= ~bit(OCIE0A);
+    sending = false;
+    return;
+  }
+  level = !level;
+  if (level) {
+    digitalWriteFast(SerialTime::TX_PIN, HIGH);
+  } else {
+    digitalWriteFast(SerialTime::TX_PIN, LOW);
+  }
+  OCR0A += nextRun;
+  nextRun = takeRun(!level);
+}
+
+namespace SerialTime {
+void begin() {
+  pinModeFast(TX_PIN, OUTPUT);
+  digitalWriteFast(TX_PIN, HIGH);   // Idle
+  pinModeFast(PPS_PIN, OUTPUT);
+  digitalWriteFast(PPS_PIN, LOW);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Start of an RTC second (interrupt). Raises PPS_PIN and starts the
+///        message prepared for this second. The pins are set first, so the
+///        latency is that of the interrupt.
+///
+/// @return true    A message is sent, Timer0 must run until its end
+/// @return false   No message (no time, not prepared in time)
+//////////////////////////////////////////////////////////////////////////////
+bool tick() {
+  if (!known) { return false; }
+  bool send = nextValid && !sending;
+  if (send) {
+    digitalWriteFast(PPS_PIN, HIGH);
+    digitalWriteFast(TX_PIN, LOW);   // Start bit
+  }
+  epoch = epoch + 1;
+  second = (second + 1 == TimeCalc::SECONDS_PER_MINUTE) ? 0 : second + 1;
+  nextValid = false;
+  if (!send) { return false; }
+  line = buffer[nextBuffer];
+  nextBuffer ^= 1;
+  charIndex = 0;
+  bitsLeft = 0;
+  level = false;
+  OCR0A = TCNT0 + takeRun(false);
+  nextRun = takeRun(true);
+  TIFR0 = bit(OCF0A);
+  TIMSK0 |= bit(OCIE0A);
+  sending = true;
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The output needs the RTC time: no time yet, after resync() or
+///        once a minute to check the count of the seconds.
+///
+//////////////////////////////////////////////////////////////////////////////
+bool needsTime() { return !known || second == TimeCalc::SECONDS_PER_MINUTE - 1; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the RTC second that is running. Must be called in the
+///        second that has been read (after its tick).
+///
+/// @param rtcEpoch   TimeCalc epoch
+//////////////////////////////////////////////////////////////////////////////
+void setTime(uint32_t rtcEpoch) {
+  noInterrupts();
+  epoch = rtcEpoch;
+  second = rtcEpoch % TimeCalc::SECONDS_PER_MINUTE;
+  known = true;
+  nextValid = false;
+  interrupts();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Prepares the message of the next second. Must be called once in
+///        every second (main context). If the second ends in the meantime,
+///        the message is discarded.
+///
+/// @param zone        DCF77_ZONE_CET or DCF77_ZONE_CEST
+/// @param syncEpoch   RTC time of the last DCF77 sync, 0 = none
+//////////////////////////////////////////////////////////////////////////////
+void prepare(uint8_t zone, uint32_t syncEpoch) {
+  noInterrupts();
+  bool valid = known;
+  uint32_t running = epoch;
+  bool newMinute = (second == TimeCalc::SECONDS_PER_MINUTE - 1);
+  nextValid = false;
+  interrupts();
+  if (!valid) { return; }
+  uint32_t time = running + 1;
+  if (newMinute || syncEpoch != ageSyncEpoch) {   // The age changes at most once an hour, divide once a minute
+    ageSyncEpoch = syncEpoch;
+    age = AGE_UNKNOWN;
+    if (syncEpoch) {
+      uint32_t hours = (time > syncEpoch) ? (time - syncEpoch) / TimeCalc::SECONDS_PER_HOUR : 0;
+      age = (hours < AGE_UNKNOWN) ? hours : AGE_UNKNOWN - 1;
+    }
+  }
+  uint8_t *m = buffer[nextBuffer];
+  m[0] = SYNC;
+  m[1] = time & 0xFF;
+  m[2] = (time >> 8) & 0xFF;
+  m[3] = (time >> 16) & 0xFF;
+  m[4] = time >> 24;
+  m[5] = zone;
+  m[6] = age;
+  uint8_t checksum = 0;
+  for (uint8_t i = 1; i < MESSAGE_SIZE - 1; ++i) { checksum ^= m[i]; }
+  m[MESSAGE_SIZE - 1] = checksum;
+  noInterrupts();
+  if (epoch == running) { nextValid = true; }
+  interrupts();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Stops the messages until the next setTime(), e.g. after the RTC
+///        has been set.
+///
+//////////////////////////////////////////////////////////////////////////////
+void resync() {
+  noInterrupts();
+  known = false;
+  nextValid = false;
+  interrupts();
+}
+
+bool isSending() { return sending; }
+}   // namespace SerialTime
+#endif
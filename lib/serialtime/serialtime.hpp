@@ -0,0 +1,70 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file serialtime.hpp
+/// @author Kai R.
+/// @brief Declaration of the serial time messages with a PPS output (build
+///        flag SERIAL_TIME) for other equipment that needs the time of the
+///        clock.
+///        At the start of every RTC second a message with the time of this
+///        second is sent at TX_PIN (4800 baud 8N1, the NMEA 0183 rate). Its
+///        start bit and the rising edge of PPS_PIN are set by the pin change
+///        interrupt of the 1Hz edge that begins the second (tick()). PPS_PIN
+///        falls at the end of the stop bit of the last byte (16.7 ms).
+///
+///        Message (8 bytes, binary):
+///        SYNC(0x5A) time(4 bytes, LSB first) zone age checksum
+///        time     = TimeCalc epoch of the second (seconds since
+///                   2000-01-01 00:00:00 of the RTC time, which is the
+///                   DCF77 time CET/CEST)
+///        zone     = DCF77_ZONE_CEST (1) or DCF77_ZONE_CET (2) of the last
+///                   received DCF77 sequence
+///        age      = hours since the RTC was last confirmed by DCF77 (0 ...
+///                   254), AGE_UNKNOWN (255): not since the reset
+///        checksum = XOR of time ... age
+///
+///        The ATtiny88 has no UART. The bits are timed with the compare
+///        unit A of Timer0 (the millis() timer, its tick is kept by
+///        lib/cpuclock): an interrupt at every change of the line level,
+///        not at every bit. The baud rate has the accuracy of the internal
+///        RC oscillator (like the trace channel). The messages are prepared
+///        in the main context (prepare()), the interrupts only copy bits.
+///        Latency of the start bit and the PPS edge after the 1Hz edge:
+///        the interrupt response, the prologue of PCINT2_vect and the call
+///        of tick(), about 60 cycles (60 us at 1 MHz, counted from the
+///        code path), plus any interrupt or cli() section that is running.
+///        Shares pin 6 with the trace channel and the capture.
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SERIALTIME_HPP_
+#define _SERIALTIME_HPP_
+
+#include <stdint.h>
+
+#if defined(SERIAL_TIME) && (defined(TRACE_ENABLED) || defined(CAPTURE_ENABLED))
+#error "SERIAL_TIME uses the serial line of TRACE_ENABLED and CAPTURE_ENABLED. Only one of them can be used."
+#endif
+
+namespace SerialTime {
+constexpr uint8_t TX_PIN{6};              // PD6, serial TX of the trace channel
+constexpr uint8_t PPS_PIN{18};            // PC1 (A1)
+constexpr uint32_t BAUD_RATE{4800};
+constexpr uint8_t TIMER0_PRESCALER{8};    // Setting of the core at 1 MHz
+constexpr uint8_t SYNC{0x5A};
+constexpr uint8_t MESSAGE_SIZE{8};
+constexpr uint8_t AGE_UNKNOWN{0xFF};
+
+void begin(void);
+bool tick(void);
+bool needsTime(void);
+void setTime(uint32_t);
+void prepare(uint8_t, uint32_t);
+void resync(void);
+bool isSending(void);
+}   // namespace SerialTime
+
+#endif
@@ -0,0 +1,211 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file timebase.cpp
+/// @author Kai R.
+/// @brief Time base with the 32.768 kHz output of the DS3231 (RTC_TIMEBASE).
+///
+/// @date 2023-01-21
+/// @version 1.0
+///
+/// @date 2023-02-11
+/// One-shot timer (after()): compare match B of Timer1. The ticks are counted in 32 bit
+/// (tickBase), so the compare value follows the mode of the timer.
+///
+/// @date 2023-02-25
+/// setTimer0Wakeup(): Timer0 overflow interrupt on demand.
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include "timebase.hpp"
+
+#ifdef RTC_TIMEBASE
+namespace {
+// One tick = 1/32768 s = 15625/512 us = 125/4096 ms. The remainders are
+// accumulated, so millis() and micros() do not drift against the ticks.
+constexpr uint16_t MICROS_PER_TICK_512{15625};
+constexpr uint8_t MICROS_SHIFT{9};
+constexpr uint8_t MILLIS_PER_TICK_4096{125};
+constexpr uint8_t MILLIS_SHIFT{12};
+constexpr uint8_t CS_EXT_RISING{bit(CS12) | bit(CS11) | bit(CS10)};   // External clock on T1, rising edge
+constexpr uint32_t PERIOD_NORMAL{0x10000};                             // Ticks per overflow, normal mode
+constexpr uint32_t PERIOD_PWM{0x100};                                  // Fast PWM 8 bit
+
+volatile uint32_t microsBase{0};
+volatile uint16_t microsFract{0};   // 1/512 us
+volatile uint32_t millisBase{0};
+volatile uint16_t millisFract{0};   // 1/4096 ms
+volatile uint32_t tickBase{0};   // Ticks up to the last overflow
+volatile bool pwm{false};
+volatile uint32_t alarmTick{0};
+void (*volatile alarmCallback)(void){nullptr};
+
+uint32_t period() { return pwm ? PERIOD_PWM : PERIOD_NORMAL; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Adds ticks to the time. Interrupts must be disabled.
+///
+/// @param ticks   Up to 2 * PERIOD_NORMAL
+//////////////////////////////////////////////////////////////////////////////
+void add(uint32_t ticks) {
+  tickBase += ticks;
+  uint32_t scaled = ticks * MICROS_PER_TICK_512 + microsFract;
+  microsBase += scaled >> MICROS_SHIFT;
+  microsFract = scaled & (bit(MICROS_SHIFT) - 1);
+  scaled = ticks * MILLIS_PER_TICK_4096 + millisFract;
+  millisBase += scaled >> MILLIS_SHIFT;
+  millisFract = scaled & (bit(MILLIS_SHIFT) - 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Ticks since the last overflow that has been added. Contains an
+///        overflow whose interrupt is still pending. Interrupts must be
+///        disabled.
+///
+/// @return uint32_t
+//////////////////////////////////////////////////////////////////////////////
+uint32_t elapsed() {
+  uint16_t count = TCNT1;
+  if ((TIFR1 & bit(TOV1)) && count < (period() >> 1)) { return count + period(); }
+  return count;
+}
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Compare value of the one-shot timer in the current mode. In the
+///        PWM mode (and in normal mode for more than one period) the match
+///        comes once per period; the interrupt waits for the one at
+///        alarmTick. In the PWM modes OCR1B is taken over at the end of the
+///        period (double buffered), the match of the previous value in the
+///        current period is ignored in the same way.
+///
+//////////////////////////////////////////////////////////////////////////////
+void setCompare() { OCR1B = (alarmTick - tickBase) & (period() - 1); }
+
+ISR(TIMER1_OVF_vect) { add(period()); }
+
+ISR(TIMER1_COMPB_vect) {
+  if (static_cast<int32_t>(tickBase + elapsed() - alarmTick) < 0) { return; }
+  TIMSK1 &= ~bit(OCIE1B);
+  void (*callback)(void) = alarmCallback;
+  alarmCallback = nullptr;
+  if (callback) { callback(); }
+}
+
+namespace TimeBase {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Timer1 counts the external clock (normal mode). The Timer0
+///        overflow interrupt (millis() of the core) is switched off.
+///        Must be called before CpuClock::begin(); the 32 kHz output of
+///        the RTC is switched on with RTC::enable32kHz().
+///
+//////////////////////////////////////////////////////////////////////////////
+void begin() {
+  pinMode(T1_PIN, INPUT_PULLUP);   // The 32K output of the DS3231 is open drain (RV-3028 CLKOUT: push-pull)
+  uint8_t sreg = SREG;
+  cli();
+  TCCR1A = 0;
+  TCCR1B = CS_EXT_RISING;
+  TCNT1 = 0;
+  TIFR1 = bit(TOV1);
+  TIMSK1 = bit(TOIE1);
+  TIMSK0 &= ~bit(TOIE0);
+  pwm = false;
+  SREG = sreg;
+}
+
+uint32_t millis() {
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t base = millisBase;
+  uint32_t scaled = elapsed() * MILLIS_PER_TICK_4096 + millisFract;
+  SREG = sreg;
+  return base + (scaled >> MILLIS_SHIFT);
+}
+
+uint32_t micros() {
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t base = microsBase;
+  uint32_t scaled = elapsed() * MICROS_PER_TICK_512 + microsFract;
+  SREG = sreg;
+  return base + (scaled >> MICROS_SHIFT);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches Timer1 between normal mode (few wake-ups) and fast PWM
+///        mode (backlight on). The elapsed ticks are added and the counter
+///        restarts, at most one tick is lost.
+///        Switch on before analogWrite(), switch off after it.
+///
+/// @param on
+//////////////////////////////////////////////////////////////////////////////
+void setPwm(bool on) {
+  if (on == pwm) { return; }
+  uint8_t sreg = SREG;
+  cli();
+  add(elapsed());
+  TCNT1 = 0;
+  TIFR1 = bit(TOV1);
+  pwm = on;
+  if (TIMSK1 & bit(OCIE1B)) { setCompare(); }
+  if (on) {
+    TCCR1A = (TCCR1A & ~bit(WGM11)) | bit(WGM10);   // Fast PWM 8 bit (mode 5)
+    TCCR1B = (TCCR1B & ~bit(WGM13)) | bit(WGM12);
+  } else {
+    TCCR1A &= ~(bit(WGM11) | bit(WGM10));   // Normal mode
+    TCCR1B &= ~(bit(WGM13) | bit(WGM12));
+  }
+  SREG = sreg;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Calls the function (in the interrupt) after the given number of
+///        ticks. A pending call is replaced. The jitter is the interrupt
+///        latency, during the backlight PWM the call may come one PWM
+///        period (7.8 ms) late if setPwm() switches the mode in between.
+///        The MCU must not power down before the call (Timer1 stops).
+///
+/// @param ticks      1/32768 s
+/// @param callback
+//////////////////////////////////////////////////////////////////////////////
+void after(uint16_t ticks, void (*callback)(void)) {
+  uint8_t sreg = SREG;
+  cli();
+  alarmTick = tickBase + elapsed() + ticks;
+  alarmCallback = callback;
+  setCompare();
+  TIFR1 = bit(OCF1B);
+  TIMSK1 |= bit(OCIE1B);
+  SREG = sreg;
+}
+
+void cancel() {
+  uint8_t sreg = SREG;
+  cli();
+  TIMSK1 &= ~bit(OCIE1B);
+  alarmCallback = nullptr;
+  SREG = sreg;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches the Timer0 overflow interrupt on or off (off after
+///        begin()). While it is on, it wakes the MCU from idle every 2 ms,
+///        so a time can be awaited in idle sleep instead of a busy wait.
+///        millis() and micros() of the core count again, but their values
+///        remain invalid.
+///
+/// @param on
+//////////////////////////////////////////////////////////////////////////////
+void setTimer0Wakeup(bool on) {
+  uint8_t sreg = SREG;
+  cli();
+  if (on) {
+    TIMSK0 |= bit(TOIE0);
+  } else {
+    TIMSK0 &= ~bit(TOIE0);
+  }
+  SREG = sreg;
+}
+}   // namespace TimeBase
+#endif
@@ -0,0 +1,69 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file timebase.hpp
+/// @author Kai R.
+/// @brief Declaration of the time base for the sub-second timing (DCF77
+///        pulse widths, time stamps of the second marks and of the 1Hz
+///        signal, trace time).
+///
+///        Default: millis() and micros() of the core (Timer0, clocked by the
+///        internal RC oscillator, which can be off by several percent).
+///
+///        Build flag RTC_TIMEBASE: Timer1 counts the 32.768 kHz output of the
+///        DS3231 (TCXO) at its external clock input T1 (PD5). The timer runs
+///        in normal mode (16 bit, overflow interrupt every 2 s). While the
+///        backlight is on, it runs in fast PWM mode (8 bit, 128 Hz) for the
+///        backlight PWM at OC1A (setPwm()). The resolution is one tick
+///        (30.5 us). The Timer0 overflow interrupt is switched off, so
+///        millis(), micros() and delay() of the core must not be used after
+///        begin(). Like Timer0, Timer1 does not count in power down mode
+///        (the external clock is synchronized with the I/O clock).
+///        Wiring: DS3231 32K (RV-3028: CLKOUT) -> PD5 (T1). The date button
+///        moves from PD5 to PD0 (see display.hpp).
+///
+/// @date 2023-01-21
+/// @version 1.0
+///
+/// @date 2023-02-11
+/// RV-3028 (RTC_RV3028): CLKOUT instead of 32K.
+///
+/// @date 2023-02-11
+/// One-shot timer with the compare unit B of Timer1 (after()), e.g. for the end of
+/// the pulses of the DCF77 output (lib/dcf77out).
+///
+/// @date 2023-02-25
+/// setTimer0Wakeup(): the Timer0 overflow wakes the MCU from idle every 2 ms while the
+/// firmware waits for a time (RTC write), also with RTC_TIMEBASE.
+/// With RTC_TIMEBASE the core timing (millis(), micros(), delay()) is invalid after begin():
+/// its overflow count stands still, delay() does not return. Libraries wait with
+/// delayMicroseconds() (cycle count, e.g. lib/DOGM_7036).
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _TIMEBASE_HPP_
+#define _TIMEBASE_HPP_
+
+#include <Arduino.h>
+
+namespace TimeBase {
+#ifdef RTC_TIMEBASE
+constexpr uint8_t T1_PIN{5};   // PD5: external clock input of Timer1
+constexpr uint32_t TICKS_PER_SECOND{32768};
+
+void begin(void);
+uint32_t millis(void);
+uint32_t micros(void);
+void setPwm(bool);
+void after(uint16_t, void (*)(void));
+void cancel(void);
+void setTimer0Wakeup(bool);
+#else
+inline void begin(void) {}
+inline uint32_t millis(void) { return ::millis(); }
+inline uint32_t micros(void) { return ::micros(); }
+inline void setPwm(bool) {}
+inline void setTimer0Wakeup(bool) {}   // The Timer0 overflow interrupt is always on
+#endif
+}   // namespace TimeBase
+#endif
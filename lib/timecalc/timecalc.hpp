@@ -0,0 +1,160 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file timecalc.hpp
+/// @author Kai R.
+/// @brief Calendar and epoch calculations for the DCF77 decoder and the RTC.
+///        Date-times are converted into seconds since 2000-01-01 00:00:00
+///        and back. The supported range is 2000-2099 (two-digit years of
+///        DCF77 and DS3231), in which every fourth year is a leap year.
+///        This allows 16 bit day arithmetic. Only epoch <-> time of day
+///        needs 32 bit operations.
+///
+///        All functions are constexpr (C++11), so constant values are
+///        calculated by the compiler.
+///
+/// @date 2022-11-12
+/// @version 1.0
+///
+/// @date 2023-02-18
+/// Cycle counts on the AVR are open. The cost of fromEpoch() is in its 32 bit divisions
+/// (epoch / SECONDS_PER_DAY with the remainder, secondOfDay / SECONDS_PER_MINUTE, libgcc
+/// __udivmodsi4). toEpoch() has no 32 bit division, only 32 bit multiplications and the 16 bit
+/// division in daysBeforeMonth(). To be measured with Timer1 at prescaler 1 around a call with a
+/// volatile argument, or with the cycle counter of simavr.
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _TIMECALC_HPP_
+#define _TIMECALC_HPP_
+
+#include <stdint.h>
+#include "bcdconv.hpp"
+
+namespace TimeCalc {
+constexpr uint8_t SECONDS_PER_MINUTE{60};
+constexpr uint8_t MINUTES_PER_HOUR{60};
+constexpr uint32_t SECONDS_PER_HOUR{3600};   // 32 bit: hour * SECONDS_PER_HOUR must not overflow on AVR
+constexpr uint32_t SECONDS_PER_DAY{86400};
+constexpr uint16_t DAYS_PER_YEAR{365};
+constexpr uint16_t DAYS_PER_4_YEARS{1461};
+constexpr uint8_t DAYS_JAN{31};
+constexpr uint8_t DAYS_JAN_FEB{59};   // without leap day
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Date and time in decimal values. year 0-99 = 2000-2099
+///
+//////////////////////////////////////////////////////////////////////////////
+struct DateTime {
+  uint8_t year;     // 0-99
+  uint8_t month;    // 1-12
+  uint8_t day;      // 1-31
+  uint8_t hour;     // 0-23
+  uint8_t minute;   // 0-59
+  uint8_t second;   // 0-59
+};
+
+constexpr bool operator==(const DateTime &a, const DateTime &b) {
+  return a.year == b.year && a.month == b.month && a.day == b.day && a.hour == b.hour && a.minute == b.minute &&
+         a.second == b.second;
+}
+constexpr bool operator!=(const DateTime &a, const DateTime &b) { return !(a == b); }
+
+constexpr bool isLeapYear(uint8_t year) { return (year & 0x03) == 0; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Days of the year before the first day of the month. From March
+///        on the month lengths (31,30,31,30,31) repeat, so the table can be
+///        replaced by (153 * m + 2) / 5 (m = months since March).
+///
+//////////////////////////////////////////////////////////////////////////////
+constexpr uint16_t daysBeforeMonth(uint8_t month, bool leap) {
+  return month <= 2 ? (month - 1) * DAYS_JAN : DAYS_JAN_FEB + leap + (153 * (month - 3) + 2) / 5;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Days since 2000-01-01. (year + 3) / 4 = leap years before year.
+///
+//////////////////////////////////////////////////////////////////////////////
+constexpr uint16_t daysFromCivil(uint8_t year, uint8_t month, uint8_t day) {
+  return DAYS_PER_YEAR * year + (year + 3) / 4 + daysBeforeMonth(month, isLeapYear(year)) + day - 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Day of the week as in DCF77: 1 = Monday ... 7 = Sunday.
+///        2000-01-01 was a Saturday.
+///
+//////////////////////////////////////////////////////////////////////////////
+constexpr uint8_t dayOfWeek(uint16_t days) { return (days + 5) % 7 + 1; }
+
+constexpr uint32_t toEpoch(const DateTime &dt) {
+  return daysFromCivil(dt.year, dt.month, dt.day) * SECONDS_PER_DAY + dt.hour * SECONDS_PER_HOUR +
+         dt.minute * SECONDS_PER_MINUTE + dt.second;
+}
+
+constexpr uint8_t dayOfWeek(const DateTime &dt) { return dayOfWeek(daysFromCivil(dt.year, dt.month, dt.day)); }
+
+// Helper functions for fromEpoch(). C++11 constexpr functions consist of one return statement,
+// so intermediate values are passed on as parameters.
+namespace detail {
+constexpr uint8_t yearOfCycle(uint16_t dayOfCycle) { return dayOfCycle < 366 ? 0 : (dayOfCycle - 1) / DAYS_PER_YEAR; }
+
+constexpr uint8_t yearFromDays(uint16_t days) { return (days / DAYS_PER_4_YEARS) * 4 + yearOfCycle(days % DAYS_PER_4_YEARS); }
+
+constexpr uint8_t monthFromDayOfYear(uint16_t doy, bool leap) {
+  return doy < DAYS_JAN ? 1 : (doy < DAYS_JAN_FEB + leap ? 2 : 3 + (5 * (doy - DAYS_JAN_FEB - leap) + 2) / 153);
+}
+
+constexpr DateTime fromMonth(uint8_t year, uint16_t doy, uint8_t month, uint16_t minutes, uint8_t second) {
+  return DateTime{year,
+                  month,
+                  static_cast<uint8_t>(doy - daysBeforeMonth(month, isLeapYear(year)) + 1),
+                  static_cast<uint8_t>(minutes / MINUTES_PER_HOUR),
+                  static_cast<uint8_t>(minutes % MINUTES_PER_HOUR),
+                  second};
+}
+
+constexpr DateTime fromYear(uint8_t year, uint16_t doy, uint32_t secondOfDay) {
+  return fromMonth(year, doy, monthFromDayOfYear(doy, isLeapYear(year)), secondOfDay / SECONDS_PER_MINUTE,
+                   secondOfDay % SECONDS_PER_MINUTE);
+}
+
+constexpr DateTime fromDays(uint16_t days, uint8_t year, uint32_t secondOfDay) {
+  return fromYear(year, days - daysFromCivil(year, 1, 1), secondOfDay);
+}
+}   // namespace detail
+
+constexpr DateTime fromEpoch(uint32_t epoch) {
+  return detail::fromDays(epoch / SECONDS_PER_DAY, detail::yearFromDays(epoch / SECONDS_PER_DAY),
+                          epoch % SECONDS_PER_DAY);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Date-time from the BCD values of the DCF77 sequence or the RTC registers.
+///
+//////////////////////////////////////////////////////////////////////////////
+constexpr DateTime fromBcd(uint8_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+  return DateTime{BCDConv::bcdToDec(year), BCDConv::bcdToDec(month),  BCDConv::bcdToDec(day),
+                  BCDConv::bcdToDec(hour), BCDConv::bcdToDec(minute), BCDConv::bcdToDec(second)};
+}
+
+constexpr DateTime addSeconds(const DateTime &dt, int32_t seconds) { return fromEpoch(toEpoch(dt) + seconds); }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The expected date-time of the next DCF77 sequence.
+///
+//////////////////////////////////////////////////////////////////////////////
+constexpr DateTime nextMinute(const DateTime &dt) { return addSeconds(dt, SECONDS_PER_MINUTE); }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Signed difference a - b in seconds.
+///
+//////////////////////////////////////////////////////////////////////////////
+constexpr int32_t diff(const DateTime &a, const DateTime &b) { return static_cast<int32_t>(toEpoch(a) - toEpoch(b)); }
+
+static_assert(toEpoch(DateTime{0, 1, 1, 0, 0, 0}) == 0, "Epoch starts 2000-01-01");
+static_assert(daysFromCivil(0, 3, 1) == 60 && daysFromCivil(1, 3, 1) == 425, "Leap year 2000");
+static_assert(dayOfWeek(DateTime{22, 11, 12, 0, 0, 0}) == 6, "2022-11-12 is a Saturday");
+static_assert(nextMinute(DateTime{24, 2, 28, 23, 59, 0}) == DateTime{24, 2, 29, 0, 0, 0}, "Leap day");
+}   // namespace TimeCalc
+#endif
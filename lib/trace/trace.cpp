@@ -0,0 +1,92 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file trace.cpp
+/// @author Kai R.
+/// @brief Binary trace channel.
+///
+/// @date 2022-12-10
+/// @version 1.0
+///
+/// @date 2023-01-21
+/// Record time from TimeBase::millis().
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifdef TRACE_ENABLED
+#include <Arduino.h>
+#include "trace.hpp"
+#include "timebase.hpp"
+
+namespace {
+Trace::Record buffer[Trace::BUFFER_SIZE];
+volatile uint8_t head{0};   // Next record to write (ISR)
+volatile uint8_t tail{0};   // Next record to send (main)
+volatile uint16_t lost{0};
+
+void send(uint8_t data, uint8_t &checksum) {
+  Serial.write(data);
+  checksum ^= data;
+}
+}   // namespace
+
+namespace Trace {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Initialize the serial output.
+///        With ATtiny controllers, the serial output is via the Serial -TX pin.
+///        An FTD232 adapter is required.
+///
+//////////////////////////////////////////////////////////////////////////////
+void begin() { Serial.begin(BAUD_RATE); }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Stores a record. May be called from an ISR. If the buffer is
+///        full, the record is counted as lost.
+///
+/// @param event
+/// @param arg
+/// @param value
+//////////////////////////////////////////////////////////////////////////////
+void add(Event event, uint8_t arg, uint16_t value) {
+  uint8_t sreg = SREG;
+  cli();
+  uint8_t next = (head + 1) & (BUFFER_SIZE - 1);
+  if (next == tail) {
+    ++lost;
+  } else {
+    buffer[head] = {event, arg, value, static_cast<uint16_t>(TimeBase::millis())};
+    head = next;
+  }
+  SREG = sreg;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sends all stored records. Must be called in the main context.
+///        Waits until the last byte has been sent, so the clock may be
+///        changed (lib/cpuclock) or the MCU may power down afterwards.
+///
+//////////////////////////////////////////////////////////////////////////////
+void drain() {
+  noInterrupts();
+  uint16_t lostRecords = lost;
+  lost = 0;
+  interrupts();
+  if (lostRecords) { add(Event::LOST, 0, lostRecords); }
+  if (head == tail) { return; }
+  while (head != tail) {
+    Record r = buffer[tail];   // Only the ISR writes head, so the record at tail is stable
+    tail = (tail + 1) & (BUFFER_SIZE - 1);
+    uint8_t checksum = 0;
+    Serial.write(SYNC);
+    send(static_cast<uint8_t>(r.event), checksum);
+    send(r.arg, checksum);
+    send(r.value & 0xFF, checksum);
+    send(r.value >> 8, checksum);
+    send(r.time & 0xFF, checksum);
+    send(r.time >> 8, checksum);
+    Serial.write(checksum);
+  }
+  Serial.flush();
+}
+}   // namespace Trace
+#endif
@@ -0,0 +1,100 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file trace.hpp
+/// @author Kai R.
+/// @brief Declaration of the binary trace channel.
+///        Trace points store fixed-size records in a ring buffer (ISR safe).
+///        The buffer is sent in the main context via Serial (9600 baud).
+///        The host tool tools/trace_decode.py converts the records to text.
+///
+///        Record on the serial line (8 bytes):
+///        SYNC(0xA5) event arg value(lo,hi) time(lo,hi) checksum
+///        time = TimeBase::millis() (low 16 bit), checksum = XOR of event ... time(hi)
+///
+///        Build flag TRACE_ENABLED switches the trace on. Without it the
+///        TRACE() macro is empty and its arguments are not evaluated.
+///
+/// @date 2022-12-10
+/// @version 1.0
+///
+/// @date 2023-01-14
+/// Event STACK (unused stack, lib/memcheck).
+///
+/// @date 2023-01-28
+/// Event THRESHOLD (adaptive pulse thresholds of lib/dcf77).
+///
+/// @date 2023-02-04
+/// Events RECEIVER_OFF (receiver off time, reason) and RECEIVER_CYCLE (power-cycle).
+/// Event POWER_LEVEL (supply voltage, BATTERY_MONITOR).
+///
+/// @date 2023-02-11
+/// Event PARTIAL (fields of an incomplete minute, PARTIAL_FRAMES).
+///
+/// @date 2023-02-11
+/// Event VERIFY (comparison of the minutes and hours with the RTC, VERIFY_ONLY). Reason 3 of
+/// RECEIVER_OFF.
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _TRACE_HPP_
+#define _TRACE_HPP_
+
+#include <stdint.h>
+
+namespace Trace {
+// Keep in sync with tools/trace_decode.py
+enum class Event : uint8_t {
+  EDGE = 1,         // arg: 1 = start of signal, 0 = end of signal       value: duration before the edge (ms)
+  BIT,              // arg: second                                       value: bit (0/1)
+  FRAME,            // arg: DCF77Sequence flag                           value: number of seconds received
+  DECODE,           // arg: bit0 start bit, bit1 time OK, bit2 date OK   value: BCD hours << 8 | BCD minutes
+  RTC_WRITE,        // arg: second written                               value: measured offset before (ms, int16)
+  RTC_PHASE,        // arg: 0                                            value: phase error after setting (us, int16)
+  RTC_TIME,         // arg: BCD seconds                                  value: BCD hours << 8 | BCD minutes
+  LOST,             // arg: 0                                            value: number of records lost (buffer full)
+  STACK,            // arg: 0                                            value: stack bytes never used (lib/memcheck)
+  THRESHOLD,        // arg: minute threshold / 10 ms                     value: short threshold << 8 | long threshold (ms)
+  RECEIVER_OFF,     // arg: 0 window end, 1 synchronized, 2 timeout,     value: time until the receiver is on again (min)
+                    //      3 verified
+  RECEIVER_CYCLE,   // arg: 0 no second marks, 1 no complete frames      value: time since the start of the attempt (s)
+  POWER_LEVEL,      // arg: 0 normal, 1 saving, 2 critical               value: supply voltage (mV)
+  PARTIAL,          // arg: bit0-2 minutes/hours/date kept, bit3 time    value: number of seconds received
+  VERIFY,           // arg: 0 agree, 1 second marks, 2 bits, 3 phase     value: offset RTC - DCF77 (us, int16)
+};
+
+constexpr uint8_t SYNC{0xA5};
+constexpr uint8_t BUFFER_SIZE{8};   // Power of 2
+constexpr uint32_t BAUD_RATE{9600};
+
+struct Record {
+  Event event;
+  uint8_t arg;
+  uint16_t value;
+  uint16_t time;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Limits a signed value to the int16 range of a record value.
+///
+/// @param value
+/// @return constexpr uint16_t  value as int16 (two's complement)
+//////////////////////////////////////////////////////////////////////////////
+constexpr uint16_t clip(int32_t value) {
+  return static_cast<uint16_t>(value > 32767 ? 32767 : (value < -32768 ? -32768 : value));
+}
+
+void begin(void);
+void add(Event, uint8_t, uint16_t);
+void drain(void);
+}   // namespace Trace
+
+#ifdef TRACE_ENABLED
+#define TRACE(event, arg, value) Trace::add(Trace::Event::event, (arg), (value))
+#else
+#define TRACE(event, arg, value)                                                                                       \
+  do {                                                                                                                 \
+  } while (0)
+#endif
+
+#endif
@@ -1,7 +1,7 @@
 //////////////////////////////////////////////////////////////////////////////
 /// @file main.cpp
 /// @author Kai R.
-/// @brief Clock with DCF77 receiver and DS3231 RTC module.
+/// @brief Clock with DCF77 receiver and DS3231 (or RV-3028) RTC module.
 ///        The RTC module is synchronized using the DCF77 receiver.
 ///
 ///        Used PINS:
@@ -21,12 +21,18 @@
 ///
 ///        Other Control Pins
 ///          Pin 02: Interrupt Pin 0 = Processing of dcf77 signal.
-///          Pin 03: Interrupt Pin 1 = evaluate the 1Hz signal of the RTC.
+///          Pin 03: Pin change interrupt (PCINT19) = evaluate the 1Hz signal of the RTC.
+///                  NIGHT_MODE: alarm output of the RTC while the 1Hz signal is off
+///                  RTC_RV3028: INT of the RV-3028 (1Hz pulses and alarms)
 ///          Pin 04: Button for switching the backlight
 ///          Pin 05: Button to switch on the date
+///                  RTC_TIMEBASE: 32kHz signal of the RTC (T1), the button is at Pin 00
 ///          PIN 06 if not ATtiny88
 ///     else PIN 14:                 Switch DCF77 Receiver on or off
-///          Pin 06: Reserved for debug output (Serial.print - Only Attiny88)
+///          Pin 06: Reserved for trace output (Serial TX - Only Attiny88)
+///                  SERIAL_TIME: time messages (lib/serialtime)
+///          Pin 17: (A0) DCF77_OUTPUT: DCF77 time code for slave clocks (lib/dcf77out)
+///          Pin 18: (A1) SERIAL_TIME: pulse per second
 ///
 ///
 /// @date 2022-05-20
@@ -43,6 +49,108 @@
 /// @date 2022-10-08
 /// Button status designations changed
 ///
+/// @date 2022-11-05
+/// The RTC is set with one burst write exactly at the start of a DCF77 second.
+/// The phase between the DCF77 second marks and the 1Hz signal of the RTC is
+/// measured and the remaining phase error after setting is reported.
+///
+/// @date 2022-11-12
+/// Time differences between RTC and DCF77 are calculated with TimeCalc (epoch seconds).
+///
+/// @date 2022-11-19
+/// loop() replaced by tasks of a cooperative scheduler (lib/scheduler). The tasks are
+/// started by the interrupts (INT0 sequence complete, INT1 second tick) or by deadlines.
+/// Between the tasks the MCU sleeps (idle mode).
+///
+/// @date 2022-11-26
+/// Buttons are interrupt driven (lib/buttons). The 1Hz signal of the RTC is evaluated with the
+/// pin change interrupt of port D (shared with the buttons), so it can wake the MCU from power down.
+/// If neither the DCF77 receiver nor the backlight is on, the MCU sleeps in power down mode.
+///
+/// @date 2022-12-03
+/// Dynamic clock scaling (lib/cpuclock): decoding and I2C bursts run with a higher clock.
+/// Fixes the I2C bit rate at 1 MHz (Wire::setClock() calculated TWBR = 253, approx. 2 kHz).
+///
+/// @date 2022-12-10
+/// Serial debug output (DEBUG_..., PRINT_TIME_SERIAL) replaced by the binary trace channel
+/// (lib/trace, build flag TRACE_ENABLED). DEBUG_ENABLED no longer disables program parts.
+///
+/// @date 2022-12-17
+/// Raw edge capture of the DCF77 signal (lib/capture, build flag CAPTURE_ENABLED).
+/// Captures are replayed on the host with tools/replay.
+///
+/// @date 2022-12-31
+/// A long press of the date button shows the DCF77 reception quality instead of the time
+/// (antenna alignment). The receiver stays on while the quality is shown.
+///
+/// @date 2023-01-14
+/// The trace reports the unused stack once a minute (stack painting, lib/memcheck).
+///
+/// @date 2023-01-21
+/// Sub-second timing with lib/timebase. Build flag RTC_TIMEBASE: Timer1 counts the 32kHz
+/// output of the RTC instead of using millis()/micros() of the RC oscillator.
+///
+/// @date 2023-01-28
+/// Build flag NIGHT_MODE: from NIGHT_START_HOUR to NIGHT_END_HOUR the display is off. While
+/// the receiver is off, the 1Hz signal of the RTC is switched off too and the MCU sleeps until an
+/// RTC alarm (receiver on, end of the night) or a button wakes it.
+///
+/// @date 2023-02-04
+/// A DCF77 frame from before the receiver was switched off is discarded. The RTC is only set
+/// at the second mark that follows the measured one.
+/// Build flag RECEPTION_WINDOWS: the receiver is switched on at the start of the next
+/// reception window (RTC time of day, RECEPTION_WINDOW). Outside the windows an attempt is
+/// ended unless the last sync is older than SYNC_MAX_AGE (drift bound).
+/// Reception budget: an attempt without sync ends after RECEIVER_BUDGET, the next one starts
+/// after RETRY_MIN, doubled after every failed attempt. A receiver without second marks or
+/// without complete frames is power-cycled (AGC reset). Trace events RECEIVER_OFF, RECEIVER_CYCLE.
+/// Build flag BATTERY_MONITOR: the supply voltage is measured every BATTERY_CHECK_INTERVAL
+/// (lib/battery). Below VCC_LOW the backlight is dimmed and shortened and the receiver sleeps twice
+/// as long, below VCC_CRITICAL the backlight is off, the display is blanked (the date button shows
+/// it) and the receiver sleeps four times as long. The normal behavior returns VCC_HYSTERESIS above
+/// the thresholds. Trace event POWER_LEVEL.
+///
+/// @date 2023-02-11
+/// The RTC is accessed through lib/rtc. Build flag RTC_RV3028: RV-3028-C7 instead of the DS3231.
+/// The 1Hz edge and its phase within the RTC second come from the backend (RTC::TICK_RISING,
+/// RTC::tickPhase()). In the night mode the receiver is switched on by RTC::setTimer().
+///
+/// @date 2023-02-11
+/// Build flag DCF77_OUTPUT (needs RTC_TIMEBASE): the RTC time is sent as DCF77 time code
+/// (lib/dcf77out). The pulses start at the 1Hz edge that begins the RTC second. While a pulse
+/// is sent the MCU does not power down. With NIGHT_MODE the 1Hz signal stays on at night.
+///
+/// @date 2023-02-11
+/// Build flag SERIAL_TIME: at the start of every RTC second a binary time message is sent on pin 6
+/// (4800 baud, interrupt driven with Timer0) and a pulse per second on pin A1 (lib/serialtime). Both
+/// start at the 1Hz edge that begins the RTC second. The MCU does not power down while a message is
+/// sent. With NIGHT_MODE the 1Hz signal stays on at night.
+///
+/// @date 2023-02-11
+/// Build flag PARTIAL_FRAMES: the DCF77 bits are placed at their second of the RTC minute (the RTC
+/// is read once after the receiver has been switched on, the 1Hz edges count the seconds). The time
+/// is also assembled from the fields of incomplete minutes (DCF77Clock::decodePartial()), so minutes
+/// with a dropout still lead to a sync.
+///
+/// @date 2023-02-11
+/// Build flag VERIFY_ONLY: after a sync the next check only verifies the RTC. The receiver is switched
+/// on VERIFY_LEAD seconds before the minute mark predicted by the RTC. As soon as bit 35 has been
+/// received, the start bit, minutes and hours (bits 20-35) and the phase of the second marks are
+/// compared with the RTC. If they agree, the receiver is switched off at once, otherwise the attempt
+/// goes on with a full decode. Trace event VERIFY.
+///
+/// @date 2023-02-18
+/// The decoder accepts a second mark only at the end of its pulse (spikes no longer start a second).
+/// setRtcAtNextSecond() writes the RTC a whole number of measured RTC seconds after the accepted mark
+/// instead of waiting for the next mark.
+///
+/// @date 2023-02-25
+/// Build flag CLOCK_BOOST (needs BATTERY_MONITOR): the dynamic clock scaling is off by default.
+/// The clock is only boosted at the power level NORMAL (8 MHz needs 2.7 V, CpuClock::enable()).
+/// taskSync() updates the adaptive pulse thresholds of the decoder (no longer in the ISR).
+/// The RTC write waits in idle sleep (state WRITE, taskSync() at every wake-up) and busy-waits only
+/// for the last RTC_WRITE_SPIN, instead of up to 1.25 s with the scheduler blocked.
+///
 /// @copyright Copyright (c) 2022
 ///
 //////////////////////////////////////////////////////////////////////////////
@@ -51,11 +159,22 @@
 #include <digitalWriteFast.h>
 #include <avr/wdt.h>
 #include <avr/power.h>
-#include <Button_SL.hpp>
+#include <avr/sleep.h>
+#include "battery.hpp"
 #include "bcdconv.hpp"
+#include "buttons.hpp"
+#include "capture.hpp"
+#include "cpuclock.hpp"
 #include "dcf77.hpp"
+#include "dcf77out.hpp"
 #include "display.hpp"
-#include "DS3231Wire.h"
+#include "timecalc.hpp"
+#include "memcheck.hpp"
+#include "rtc.hpp"
+#include "scheduler.hpp"
+#include "serialtime.hpp"
+#include "timebase.hpp"
+#include "trace.hpp"
 
 //////////////////////////////////////////////////
 // Definitions
@@ -72,21 +191,46 @@
 // off.
 // #define DEV_BOARD
 
-// Uncomment for debug output on the serial console or to switch on I2C/Wire Fast Mode
+// Uncomment for binary trace output on the serial console (tools/trace_decode.py), for the raw DCF77 edge
+// capture (tools/replay), to switch on I2C/Wire Fast Mode, to boost the CPU clock for decoding and I2C
+// bursts (lib/cpuclock, needs BATTERY_MONITOR), for the 32kHz time base (lib/timebase),
+// for the night mode (display and 1Hz signal off), to receive in the reception windows, for the
+// power saving with a low battery, for the RV-3028 RTC (lib/rtc), for the DCF77 time code output
+// (lib/dcf77out), for the serial time messages with PPS (lib/serialtime), to assemble the time from
+// incomplete DCF77 minutes (lib/dcf77) or to only verify the RTC time after a sync
 // #define WIRE_FAST_MODE
-// #define PRINT_TIME_SERIAL
-// #define DEBUG_DCF77CONTROL
-// #define DEBUG_ISR
-// #define DEBUG_INT1
-// #define DEBUG_DCF77_SEQ_ADD_CHECK
-// #define DEBUG_DCF77_SEQ
+// #define CLOCK_BOOST
+// #define RTC_TIMEBASE
+// #define NIGHT_MODE
+// #define RECEPTION_WINDOWS
+// #define BATTERY_MONITOR
+// #define RTC_RV3028
+// #define DCF77_OUTPUT
+// #define SERIAL_TIME
+// #define PARTIAL_FRAMES
+// #define VERIFY_ONLY
+// #define TRACE_ENABLED
+// #define CAPTURE_ENABLED
 // #define SET_TEST_TIME
 
-// If DEBUG_ENABLED is defined, then certain parts of the program are disabled ( in loop() ) to
-// free up space for the debug output on the serial console.
-#if defined(PRINT_TIME_SERIAL) || defined(DEBUG_DCF77CONTROL) || defined(DEBUG_ISR) || defined(DEBUG_INT1) ||          \
-    defined(DEBUG_DCF77_SEQ_ADD_CHECK) || defined(DEBUG_DCF77_SEQ)
-#define DEBUG_ENABLED
+#if defined(DCF77_OUTPUT) && !defined(RTC_TIMEBASE)
+#error DCF77_OUTPUT needs RTC_TIMEBASE (the pulse widths are counted with the 32 kHz output of the RTC)
+#endif
+
+#if defined(CLOCK_BOOST) && !defined(BATTERY_MONITOR)
+#error CLOCK_BOOST needs BATTERY_MONITOR (8 MHz only with a measured supply voltage of at least 2.7 V)
+#endif
+
+#if defined(SERIAL_TIME) && defined(DEV_BOARD)
+#error SERIAL_TIME sends on pin 6, which switches the DCF77 receiver on the development boards
+#endif
+
+#if defined(DCF77_OUTPUT) || defined(SERIAL_TIME)
+#define SECOND_OUTPUT   // The 1Hz edge starts an output (the 1Hz signal is needed at night too)
+#endif
+
+#if defined(NIGHT_MODE) || defined(BATTERY_MONITOR)
+#define DISPLAY_ON_OFF   // The display is switched off at night or with a critical battery
 #endif
 
 #ifdef WIRE_FAST_MODE
@@ -104,28 +248,195 @@ constexpr uint8_t DCF77_ON_OFF_PIN{6};   // Switch DCF77 Receiver on or off
 constexpr uint8_t DCF77_ON_OFF_PIN{14};   // Switch DCF77 Receiver on or off
 #endif
 
+constexpr uint8_t RTC_SQW_PIN{3};   // 1Hz signal of the RTC (PCINT19)
+
 constexpr uint32_t DCF77_SLEEP{28790};   // Period (in seconds) for which the radio clock is switched off.
 // Here 28790 Seconds.
+constexpr uint16_t RECEIVER_BUDGET{1800};   // Max. time (s) of a reception attempt
+constexpr uint16_t RETRY_MIN{900};          // Receiver off time (s) after a failed attempt, doubled after every
+constexpr uint8_t RETRY_MAX_SHIFT{5};       // further one up to DCF77_SLEEP
+constexpr uint16_t STUCK_NO_MARK{120};      // No second mark for this time (s): power-cycle the receiver
+constexpr uint16_t STUCK_NO_FRAME{600};     // Second marks, but no complete frame for this time (s): power-cycle
+constexpr uint8_t POWER_CYCLE_OFF{3};       // Receiver off time (s) of a power-cycle
+constexpr uint16_t MAX_DEADLINE{0x7FFF};    // Longer sleep times are split (Scheduler::setDeadline())
+
+constexpr int32_t RTC_PHASE_TOLERANCE{10000};   // Max. phase error (microseconds) between RTC and DCF77 time
+constexpr uint32_t SECOND_MICROS{1000000};
+constexpr int8_t MAX_SECONDS_DIFF{2};   // Larger differences are not measured in microseconds (int32 overflow)
+constexpr uint8_t MAX_EDGE_SECOND{MAX_SECONDS - 2};   // Last second mark from which the RTC may be set
+constexpr int32_t OFFSET_UNKNOWN{0x7FFFFFFF};         // Offset too big to be measured
+constexpr int32_t RTC_WRITE_LEAD{50000};   // Min. time (us) from the preparation of the RTC write to the write
+constexpr int32_t RTC_WRITE_SPIN{10000};   // Busy wait (us) before the RTC write, longer than a wake-up period
+
+#ifdef RECEPTION_WINDOWS
+struct ReceptionWindow {
+  uint8_t startHour;   // RTC time
+  uint8_t endHour;     // Excluded
+};
+// The sky wave makes the reception at a long distance much better at night.
+const ReceptionWindow RECEPTION_WINDOW[] PROGMEM{{1, 5}};
+constexpr uint32_t SYNC_MAX_AGE{36 * TimeCalc::SECONDS_PER_HOUR};    // Drift bound: receive at any time if older
+constexpr uint32_t RECEIVER_MIN_SLEEP{TimeCalc::SECONDS_PER_HOUR};   // A window starting sooner is skipped
+#endif
+
+#ifdef NIGHT_MODE
+constexpr uint8_t NIGHT_START_HOUR{22};   // Night mode from 22:00 ...
+constexpr uint8_t NIGHT_END_HOUR{6};      // ... to 06:00 (RTC time)
+constexpr uint16_t NIGHT_MIN_ALARM{5};    // The receiver is switched on sooner (s): keep the 1Hz signal
+#endif
+
+#ifdef VERIFY_ONLY
+// The receiver module needs this time after switching on for valid pulses (ELV DCF-2: a few seconds).
+constexpr uint8_t VERIFY_LEAD{10};      // Receiver on (s) before the minute mark predicted by the RTC
+constexpr uint8_t VERIFY_LATE{3};       // Still switched on if the deadline was missed by up to this time (s)
+constexpr uint8_t VERIFY_TIMEOUT{40};   // Bit 35 not received this time (s) after the minute mark: full decode
+// Start bit, minutes and hours with their parity bits
+constexpr uint64_t VERIFY_BITS{((1ULL << (DCF77Bit::PARITY_HOURS + 1)) - 1) & ~((1ULL << DCF77Bit::START) - 1)};
+
+// Results of the verification (trace event VERIFY)
+enum class VerifyResult : uint8_t { AGREE, SECOND_MARKS, BITS, PHASE };
+#endif
+
+#ifdef BATTERY_MONITOR
+constexpr uint16_t BATTERY_CHECK_INTERVAL{600};   // Seconds between two measurements of the supply voltage
+constexpr uint16_t VCC_LOW{2800};                 // mV, below: dimmed backlight, longer receiver sleep
+constexpr uint16_t VCC_CRITICAL{2600};            // mV, below: no backlight, display blanked
+constexpr uint16_t VCC_HYSTERESIS{150};           // mV above a threshold to leave the level again
+constexpr uint8_t BL_BRIGHTNESS_LOW{4};
+constexpr uint8_t BL_BURN_DURATION_LOW{3};        // Time in sec
+
+// Power levels by the supply voltage. The value is the exponent of the receiver sleep time (sleepStretch()).
+enum class PowerLevel : uint8_t { NORMAL, SAVING, CRITICAL };
+static_assert(VCC_LOW >= CpuClock::MIN_BOOST_MV, "The clock is boosted at the power level NORMAL");
+#endif
+
+// Reasons for switching the receiver off (trace event RECEIVER_OFF)
+enum class ReceiverOff : uint8_t { WINDOW_END, SYNCHRONIZED, TIMEOUT, VERIFIED };
+
+// States of the synchronization between DCF77 time and RTC
+enum class SyncState : uint8_t { WAIT_FRAME, MEASURE, WRITE, VERIFY };
+SyncState syncState{SyncState::WAIT_FRAME};
 
 // int1_second is just a counter that increases every second.
 // It is not necessarily in sync with the RTC seconds
-volatile uint8_t int1_second{0};   // Second Tick in loop(), set in INT1
+volatile uint8_t int1_second{0};           // Second Tick in loop(), set in INT1
+volatile uint32_t int1_edgeMicros{0};      // TimeBase::micros() at the last counted edge of the 1Hz signal
+volatile uint32_t int1_periodMicros{SECOND_MICROS};   // Measured length of one RTC second (in TimeBase::micros())
+int32_t rtcPhaseError{0};   // Remaining phase error (microseconds) after the last RTC setting
+volatile bool rtcAlarmMode{false};   // The RTC pin is the alarm output, the 1Hz signal is off (NIGHT_MODE)
 
 DCF77Clock dcf77;
 ClockData clockData;
 dogm_7036 lcd;
+Sched::Scheduler scheduler;
 
-#ifndef DEBUG_ENABLED
-Btn::ButtonSL dtButton(BUTTON_DT_PIN);
-Btn::ButtonSL blButton(BUTTON_BL_PIN);
+// Ids of the scheduler tasks
+uint8_t taskIdSync;
+uint8_t taskIdReceiverOn;
+uint8_t taskIdDateOff;
+#ifdef BATTERY_MONITOR
+uint8_t taskIdBattery;
 #endif
 
+bool showDate{false};         // Date instead of time on the display
+bool showQuality{false};      // DCF77 reception quality instead of time on the display
+bool dcf77PoweredOn{true};   // The DCF77 receiver needs the time base (Timer0 or Timer1) for the pulse timing
+uint16_t receiverOnSince{0};   // Scheduler time (s) at the start of the reception attempt
+uint16_t lastMarkAt{0};        // Scheduler time (s) of the last second mark ...
+uint16_t lastFrameAt{0};       // ... and of the last complete frame
+uint8_t retryShift{0};         // Failed attempts since the last sync (exponent of the retry time)
+bool receiverPowerCycle{false};   // The receiver is off for a power-cycle, the attempt goes on
+uint32_t receiverWait{0};         // Receiver off time left after the current deadline (s)
+#if defined(RECEPTION_WINDOWS) || defined(SERIAL_TIME)
+uint32_t lastSyncEpoch{0};   // RTC time (TimeCalc epoch) of the last sync, 0 = none since the reset
+#endif
+#ifdef VERIFY_ONLY
+bool verifyNext{false};      // The last attempt ended with a sync: the next one only verifies the RTC
+bool verifying{false};       // The current attempt compares bits 20-35 with the RTC
+uint32_t verifyMark{0};      // RTC time (TimeCalc epoch) of the predicted minute mark
+#endif
+#ifdef DISPLAY_ON_OFF
+bool displayOn{true};
+#endif
+#ifdef BATTERY_MONITOR
+PowerLevel powerLevel{PowerLevel::NORMAL};
+#endif
+#ifdef NIGHT_MODE
+bool night{false};              // RTC time between NIGHT_START_HOUR and NIGHT_END_HOUR
+uint32_t alarmModeStart{0};     // RTC second of the day at which the 1Hz signal was switched off
+#endif
+
+Btn::ButtonIRQ dtButton(BUTTON_DT_PIN);
+Btn::ButtonIRQ blButton(BUTTON_BL_PIN);
+
 //////////////////////////////////////////////////
 // Function forward declaration
 //////////////////////////////////////////////////
 void optimizePowerConsumption(void);
 bool rtcNeedsSync(void);
+int32_t measureRtcOffset(uint32_t &, uint8_t &);
+bool prepareRtcWrite(uint32_t &, uint8_t &, uint32_t, uint8_t *);
+bool writeRtcAt(uint32_t, const uint8_t *);
+void waitForRtcWrite(bool);
 void check1HzSig(void);
+void dcf77SequenceReceived(void);
+void buttonEvent(void);
+uint8_t sleepMode(void);
+void taskSync(void);
+uint32_t rtcConfirmed(void);
+void switchReceiverOff(uint32_t);
+void setReceiverDeadline(uint32_t);
+uint8_t sleepStretch(void);
+void superviseReception(void);
+void powerCycleReceiver(void);
+void taskReceiverOn(void);
+void taskButtons(void);
+void taskDateOff(void);
+void taskDisplay(void);
+bool isHourInRange(uint8_t, uint8_t, uint8_t);
+#ifdef RECEPTION_WINDOWS
+uint32_t receiverSleepTime(uint32_t);
+bool isReceptionWindow(uint32_t);
+#endif
+#if defined(RECEPTION_WINDOWS) || defined(SECOND_OUTPUT) || defined(PARTIAL_FRAMES) || defined(VERIFY_ONLY)
+uint32_t rtcEpoch(void);
+#endif
+#ifdef VERIFY_ONLY
+bool startVerify(void);
+bool verifyReception(void);
+VerifyResult compareWithRtc(uint8_t, uint64_t, uint32_t, int32_t &);
+#endif
+#ifdef DCF77_OUTPUT
+void taskDcf77Out(void);
+#endif
+#ifdef SERIAL_TIME
+void taskSerialTime(void);
+#endif
+#ifdef PARTIAL_FRAMES
+void taskRtcAlign(void);
+#endif
+#ifdef DISPLAY_ON_OFF
+void taskDisplayOnOff(void);
+#endif
+#ifdef BATTERY_MONITOR
+void taskBattery(void);
+PowerLevel nextPowerLevel(uint16_t);
+PowerLevel powerLevelBelow(uint16_t, uint16_t);
+void applyPowerLevel(void);
+#endif
+#ifdef NIGHT_MODE
+void taskWake(void);
+void enterAlarmMode(void);
+uint8_t leaveAlarmMode(void);
+uint32_t rtcSecondOfDay(void);
+bool isNightTime(uint32_t);
+#endif
+#ifdef TRACE_ENABLED
+void taskTrace(void);
+#endif
+#ifdef CAPTURE_ENABLED
+void taskCapture(void);
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 /// @brief Initialize the program.
@@ -134,174 +445,994 @@ void check1HzSig(void);
 void setup() {
   optimizePowerConsumption();
 
-  // With ATtiny controllers, the serial output is via the Serial -TX pin. An FTD232 adapter is required.
-#ifdef DEBUG_ENABLED
-  Serial.begin(9600);
-#ifndef ESP8266
-  while (!Serial)
-    ;   // wait for serial port to connect. Needed for native USB
+#ifdef TRACE_ENABLED
+  Trace::begin();
 #endif
+#ifdef CAPTURE_ENABLED
+  Capture::begin();
 #endif
 
   pinModeFast(DCF77_ON_OFF_PIN, OUTPUT);
   digitalWriteFast(DCF77_ON_OFF_PIN, LOW);   // Switch DCF77 receiver on (P-Channel MOSFet as switch)
-#ifndef DEBUG_ENABLED
   dtButton.begin();
   blButton.begin();
-#endif
+  Btn::ButtonIRQ::setEventCallback(buttonEvent);
   // init DOGM-LCD
   initDisplay(lcd);
 
   // init DCF77
   dcf77.begin();
   dcf77.setActiveLow(true);   // ELV DCF77 Modul works with active low signals
+#ifdef DCF77_OUTPUT
+  DCF77Out::begin();
+#endif
+#ifdef SERIAL_TIME
+  SerialTime::begin();
+#endif
 
   // Init RTC
   Wire.begin();
   Wire.setClock(WIRE_SPEED);
-  DS3231::disable32kHz();
-  DS3231::enableSw1Hz();
-  attachInterrupt(digitalPinToInterrupt(PIND3), check1HzSig, RISING);
+  TimeBase::begin();             // Before CpuClock: Timer1 with external clock is not scaled
+  CpuClock::begin(WIRE_SPEED);   // After Wire and SPI (display) have been initialized
+#ifdef RTC_TIMEBASE
+  RTC::enable32kHz();
+#else
+  RTC::disable32kHz();
+#endif
+  RTC::enable1Hz();
+  *digitalPinToPCMSK(RTC_SQW_PIN) |= bit(digitalPinToPCMSKbit(RTC_SQW_PIN));
+  *digitalPinToPCICR(RTC_SQW_PIN) |= bit(digitalPinToPCICRbit(RTC_SQW_PIN));
 #ifdef SET_TEST_TIME
-  DS3231::setDateTime(BCDConv::decToBcd(0), BCDConv::decToBcd(1), BCDConv::decToBcd(1), BCDConv::decToBcd(17),
-                      BCDConv::decToBcd(1),
-                      BCDConv::decToBcd(15));   // Reset RTC for testing purposes
+  const uint8_t testTime[RTC::TIME_REGS]{0x15, 0x01, 0x17, 6, 0x01, 0x01, 0x00};   // 2000-01-01 17:01:15
+  RTC::writeTime(testTime);   // Reset RTC for testing purposes
+#endif
+#ifdef NIGHT_MODE
+  night = isNightTime(rtcSecondOfDay());
+#endif
+
+  // The order of the tasks is the order of execution.
+  taskIdSync = scheduler.add(taskSync, Sched::EV_SECOND | Sched::EV_DCF77);
+#ifdef PARTIAL_FRAMES
+  scheduler.add(taskRtcAlign, Sched::EV_SECOND);
+#endif
+  taskIdReceiverOn = scheduler.add(taskReceiverOn, Sched::EV_NONE);
+#ifdef NIGHT_MODE
+  scheduler.add(taskWake, Sched::EV_BUTTON | Sched::EV_ALARM);   // Before taskButtons
+#endif
+  scheduler.add(taskButtons, Sched::EV_BUTTON | Sched::EV_SECOND);   // Every second for the backlight timeout
+  taskIdDateOff = scheduler.add(taskDateOff, Sched::EV_NONE);
+#ifdef DISPLAY_ON_OFF
+  scheduler.add(taskDisplayOnOff, Sched::EV_SECOND | Sched::EV_BUTTON | Sched::EV_ALARM);   // After taskButtons
+#endif
+  scheduler.add(taskDisplay, Sched::EV_SECOND);
+#ifdef DCF77_OUTPUT
+  scheduler.add(taskDcf77Out, Sched::EV_SECOND);
+#endif
+#ifdef SERIAL_TIME
+  scheduler.add(taskSerialTime, Sched::EV_SECOND);
+#endif
+#ifdef BATTERY_MONITOR
+  taskIdBattery = scheduler.add(taskBattery, Sched::EV_NONE);
+#endif
+#ifdef TRACE_ENABLED
+  scheduler.add(taskTrace, Sched::EV_WAKEUP);   // Last task: Serial is idle before the MCU sleeps
+#endif
+#ifdef CAPTURE_ENABLED
+  scheduler.add(taskCapture, Sched::EV_WAKEUP);
+#endif
+  dcf77.setSequenceCallback(dcf77SequenceReceived);
+#ifdef BATTERY_MONITOR
+  taskBattery();        // Measures at once, then every BATTERY_CHECK_INTERVAL
+  applyPowerLevel();    // Also if the level stays NORMAL: allows the clock boost
 #endif
 }
 
 //////////////////////////////////////////////////////////////////////////////
-/// @brief Time display and time synchronization.
+/// @brief Run the tasks. The MCU sleeps until the next interrupt if there
+///        is nothing to do.
 ///
 //////////////////////////////////////////////////////////////////////////////
-void loop() {
-  static uint8_t tickSecond{LEAP_SECOND + 1};   // 61 to prevent initial tickSecond = int1_second.
-  static bool showDate{false};
-  static bool dcf77PoweredOn{true};
-#ifndef DEBUG_ENABLED
-  static uint8_t dateVisibleOffTime{0};
-  static uint32_t dcf77SleepCounter{0};
+void loop() { scheduler.run(sleepMode); }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the deepest sleep mode that is possible at the moment.
+///        The time base (Timer0 or Timer1, lib/timebase) is needed for the DCF77
+///        pulse timing and Timer1 for the backlight PWM. They stop in power
+///        down mode. The pin change
+///        interrupts (1Hz signal, buttons) and the watchdog (button debouncing)
+///        wake the MCU from power down.
+///        DCF77_OUTPUT: Timer1 ends the pulses of the output.
+///        SERIAL_TIME: Timer0 sends the bits of the message.
+///
+/// @return uint8_t   SLEEP_MODE_IDLE or SLEEP_MODE_PWR_DOWN
+//////////////////////////////////////////////////////////////////////////////
+uint8_t sleepMode() {
+#ifdef DCF77_OUTPUT
+  if (DCF77Out::isPulse()) { return SLEEP_MODE_IDLE; }
+#endif
+#ifdef SERIAL_TIME
+  if (SerialTime::isSending()) { return SLEEP_MODE_IDLE; }
 #endif
+  return (dcf77PoweredOn || isBacklightOn()) ? SLEEP_MODE_IDLE : SLEEP_MODE_PWR_DOWN;
+}
 
-  if (dcf77PoweredOn) {
-    if (!rtcNeedsSync()) {   // If returns 0 (false) both clocks are synchronous.
-#ifndef DEBUG_ENABLED
-      // If both clocks synchronous switch dcf77 clock off for the DCF77_SLEEP time.
-      digitalWriteFast(DCF77_ON_OFF_PIN, HIGH);
-      dcf77PoweredOn = false;
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Time synchronization. Active while the DCF77 receiver is on.
+///        If both clocks are synchronous the receiver is switched off for
+///        the DCF77_SLEEP time (RECEPTION_WINDOWS: until the next window),
+///        longer with a low battery (sleepStretch()).
+///        Otherwise the reception is supervised (superviseReception()).
+///        RECEPTION_WINDOWS: outside the windows the attempt is ended once
+///        a minute, unless the last sync is older than SYNC_MAX_AGE.
+///        VERIFY_ONLY: a verification runs first (verifyReception()).
+///        The adaptive pulse thresholds of the decoder are updated here,
+///        outside of the ISR (DCF77Receive::updateThresholds()).
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskSync() {
+  dcf77.updateThresholds();
+#ifdef VERIFY_ONLY
+  if (verifying && verifyReception()) { return; }
 #endif
-      clockData.clockSeparator().setTimeSeparator(Separators::COLUP, 0);
+  if (!rtcNeedsSync() && !showQuality) {   // If returns 0 (false) both clocks are synchronous.
+    uint32_t sleep = rtcConfirmed();
+    TRACE(RECEIVER_OFF, static_cast<uint8_t>(ReceiverOff::SYNCHRONIZED), sleep / TimeCalc::SECONDS_PER_MINUTE);
+    switchReceiverOff(sleep);
+    return;
+  }
+  if (syncState != SyncState::WAIT_FRAME || showQuality) { return; }
+  superviseReception();
+#ifdef RECEPTION_WINDOWS
+  if (dcf77PoweredOn && int1_second == 0 && lastSyncEpoch) {
+    uint32_t now = rtcEpoch();
+    if (now - lastSyncEpoch < (SYNC_MAX_AGE << sleepStretch()) && !isReceptionWindow(now)) {
+      uint32_t sleep = receiverSleepTime(now);
+      TRACE(RECEIVER_OFF, static_cast<uint8_t>(ReceiverOff::WINDOW_END), sleep / TimeCalc::SECONDS_PER_MINUTE);
+      switchReceiverOff(sleep);
     }
   }
+#endif
+}
 
-#ifndef DEBUG_ENABLED
-  if (dtButton.tick() != Btn::ButtonState::notPressed) {
-    showDate = true;
-    printRtcTime(lcd, clockData,
-                 showDate);   // Don't wait until the next second after the button is pressed to show the date.
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Reception budget and stuck receiver. An attempt longer than
+///        RECEIVER_BUDGET ends, the next one starts after the retry time
+///        (exponential backoff). Without second marks for STUCK_NO_MARK
+///        (no edges, constant level) or without complete frames for
+///        STUCK_NO_FRAME (edges without second structure) the receiver is
+///        power-cycled to reset its AGC.
+///
+//////////////////////////////////////////////////////////////////////////////
+void superviseReception() {
+  static uint8_t edgeCount;
+  static uint8_t frameCount;
+  uint16_t now = scheduler.now();
+  if (dcf77.getEdgeCount() != edgeCount) {
+    edgeCount = dcf77.getEdgeCount();
+    lastMarkAt = now;
   }
-  switchBacklight(int1_second, blButton.tick());   // Switch backlight on if button has been pressed.
+  if (dcf77.getFrameCount() != frameCount) {
+    frameCount = dcf77.getFrameCount();
+    lastFrameAt = now;
+  }
+
+  if (static_cast<uint16_t>(now - receiverOnSince) >= RECEIVER_BUDGET) {
+    uint32_t sleep = static_cast<uint32_t>(RETRY_MIN) << retryShift;
+    if (sleep > DCF77_SLEEP) { sleep = DCF77_SLEEP; }
+    sleep <<= sleepStretch();
+    if (retryShift < RETRY_MAX_SHIFT) { ++retryShift; }
+    TRACE(RECEIVER_OFF, static_cast<uint8_t>(ReceiverOff::TIMEOUT), sleep / TimeCalc::SECONDS_PER_MINUTE);
+    switchReceiverOff(sleep);
+  } else if (static_cast<uint16_t>(now - lastMarkAt) >= STUCK_NO_MARK) {
+    TRACE(RECEIVER_CYCLE, 0, now - receiverOnSince);
+    powerCycleReceiver();
+  } else if (static_cast<uint16_t>(now - lastFrameAt) >= STUCK_NO_FRAME) {
+    TRACE(RECEIVER_CYCLE, 1, now - receiverOnSince);
+    powerCycleReceiver();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The RTC agrees with DCF77: the retry time starts again and the
+///        receiver sleeps for the DCF77_SLEEP time (RECEPTION_WINDOWS: until
+///        the next window), longer with a low battery (sleepStretch()).
+///
+/// @return uint32_t  Receiver off time (s)
+//////////////////////////////////////////////////////////////////////////////
+uint32_t rtcConfirmed() {
+  retryShift = 0;
+#ifdef VERIFY_ONLY
+  verifyNext = true;
+#endif
+#if defined(RECEPTION_WINDOWS) || defined(SERIAL_TIME)
+  lastSyncEpoch = rtcEpoch();
+#endif
+#ifdef RECEPTION_WINDOWS
+  uint32_t sleep = receiverSleepTime(lastSyncEpoch);
+#else
+  uint32_t sleep = DCF77_SLEEP << sleepStretch();
 #endif
+  return sleep;
+}
 
-  // Do the following every second.
-  // To limit the read operations to the RTC (read the second), use the count variable of INT1.
-  // Using millis() is too imprecise.
-  // The clock comes from the 1Hz signal of the RTC which is present at the INT1 pin.
-  if (int1_second != tickSecond) {
-    tickSecond = int1_second;
-
-#ifndef DEBUG_ENABLED
-    if (!dcf77PoweredOn) {
-      ++dcf77SleepCounter;
-      if (dcf77SleepCounter == DCF77_SLEEP) {
-        digitalWriteFast(DCF77_ON_OFF_PIN, LOW);   // Switch DCFAvtive-Pin - Clock ON
-        dcf77PoweredOn = true;
-        dcf77SleepCounter = 0;
-        clockData.clockSeparator().setTimeSeparator(Separators::SPACE, 0);
-      }
-    }
-    if (showDate) {
-      switch (dateVisibleOffTime < SHOW_DATE_DURATION) {
-        case true: ++dateVisibleOffTime; break;
-        case false:
-          showDate = false;   // showDate becomes false when the display time for the date has passed.
-          dateVisibleOffTime = 0;
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches the receiver off for POWER_CYCLE_OFF seconds. The
+///        reception attempt goes on.
+///
+//////////////////////////////////////////////////////////////////////////////
+void powerCycleReceiver(void) {
+  receiverPowerCycle = true;
+  switchReceiverOff(POWER_CYCLE_OFF);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches the DCF77 receiver off.
+///
+/// @param sleep  Time (s) until the receiver is switched on again
+//////////////////////////////////////////////////////////////////////////////
+void switchReceiverOff(uint32_t sleep) {
+  digitalWriteFast(DCF77_ON_OFF_PIN, HIGH);
+  dcf77PoweredOn = false;
+  if (syncState == SyncState::WRITE) {   // The DCF77 time is lost
+    waitForRtcWrite(false);
+    syncState = SyncState::WAIT_FRAME;
+  }
+  scheduler.setEvents(taskIdSync, Sched::EV_NONE);
+#ifdef PARTIAL_FRAMES
+  dcf77.resyncRtc();   // The 1Hz signal may be switched off (NIGHT_MODE)
+#endif
+  setReceiverDeadline(sleep);
+  clockData.clockSeparator().setTimeSeparator(Separators::COLUP, 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the deadline of taskReceiverOn. The scheduler counts up to
+///        MAX_DEADLINE seconds, the rest is kept in receiverWait.
+///
+/// @param sleep  Time (s) until the receiver is switched on
+//////////////////////////////////////////////////////////////////////////////
+void setReceiverDeadline(uint32_t sleep) {
+  uint16_t step = sleep < MAX_DEADLINE ? sleep : MAX_DEADLINE;
+  receiverWait = sleep - step;
+  scheduler.setDeadline(taskIdReceiverOn, step);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switch the DCF77 receiver on after the DCF77_SLEEP time.
+///        A longer sleep time is a chain of deadlines.
+///        VERIFY_ONLY: a verification waits for its second (startVerify()).
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskReceiverOn() {
+  if (receiverWait) {
+    setReceiverDeadline(receiverWait);
+    return;
+  }
+#ifdef VERIFY_ONLY
+  if (verifyNext && !receiverPowerCycle && !showQuality && !startVerify()) { return; }
+#endif
+  digitalWriteFast(DCF77_ON_OFF_PIN, LOW);   // Switch DCFAvtive-Pin - Clock ON
+  dcf77PoweredOn = true;
+  dcf77.discardFrame();   // Received before the receiver was switched off
+  uint16_t now = scheduler.now();
+  if (!receiverPowerCycle) { receiverOnSince = now; }   // New attempt
+  receiverPowerCycle = false;
+  lastMarkAt = lastFrameAt = now;
+  scheduler.setEvents(taskIdSync, Sched::EV_SECOND | Sched::EV_DCF77);
+  clockData.clockSeparator().setTimeSeparator(Separators::SPACE, 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Evaluate the buttons. Show the date for SHOW_DATE_DURATION seconds,
+///        switch the reception quality display on/off (long press) or
+///        switch the backlight on.
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskButtons() {
+  switch (dtButton.tick()) {
+    case Btn::ButtonState::shortPressed:
+      showDate = true;
+      scheduler.setDeadline(taskIdDateOff, SHOW_DATE_DURATION);
+      taskDisplay();   // Don't wait until the next second after the button is pressed to show the date.
+      break;
+    case Btn::ButtonState::longPressed:
+      showQuality = !showQuality;
+      if (showQuality && !dcf77PoweredOn) {
+        scheduler.cancelDeadline(taskIdReceiverOn);
+        receiverWait = 0;
+        taskReceiverOn();
       }
-    }
+      taskDisplay();
+      break;
+    default: break;
+  }
+  switchBacklight(int1_second, blButton.tick());   // Switch backlight on if button has been pressed.
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The display time for the date has passed.
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskDateOff() { showDate = false; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Update the display every second.
+///        The clock comes from the 1Hz signal of the RTC which is present at the INT1 pin.
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskDisplay() {
+#ifdef DISPLAY_ON_OFF
+  if (!displayOn) { return; }
 #endif
+  if (showQuality && !showDate) {
+    DCF77Quality quality = dcf77.getQuality();
+    printQuality(lcd, quality.score, quality.second);
+  } else {
     printRtcTime(lcd, clockData, showDate);
   }
 }
 
+#ifdef DISPLAY_ON_OFF
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches the display off at night (NIGHT_MODE) or with a critical
+///        battery (BATTERY_MONITOR), unless the backlight, the date or the
+///        reception quality is shown.
+///        NIGHT_MODE: if the receiver is off as well, the RTC stops the 1Hz
+///        signal at night and the MCU sleeps in power down until an alarm
+///        (receiver on, end of the night) or a button. The night is checked
+///        once a minute and after every wake-up.
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskDisplayOnOff() {
+  bool blank = false;
+#ifdef NIGHT_MODE
+  if (int1_second == 0) { night = isNightTime(rtcSecondOfDay()); }
+  blank = night;
+#endif
+#ifdef BATTERY_MONITOR
+  blank = blank || powerLevel == PowerLevel::CRITICAL;
+#endif
+
+  bool show = !blank || showDate || showQuality || isBacklightOn();
+  if (show != displayOn) {
+    displayOn = show;
+    lcd.displ_onoff(show);
+    if (show) { taskDisplay(); }
+  }
+#if defined(NIGHT_MODE) && !defined(SECOND_OUTPUT)
+  if (!show && night && !dcf77PoweredOn) { enterAlarmMode(); }
+#endif
+}
+#endif
+
+#ifdef BATTERY_MONITOR
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Measures the supply voltage every BATTERY_CHECK_INTERVAL and
+///        changes the power level if necessary.
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskBattery() {
+  scheduler.setDeadline(taskIdBattery, BATTERY_CHECK_INTERVAL);
+  uint16_t vcc = Battery::readVcc();
+  PowerLevel level = nextPowerLevel(vcc);
+  if (level == powerLevel) { return; }
+  TRACE(POWER_LEVEL, static_cast<uint8_t>(level), vcc);
+  powerLevel = level;
+  applyPowerLevel();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Power level for the supply voltage. A level is entered below its
+///        threshold (VCC_LOW, VCC_CRITICAL) and left VCC_HYSTERESIS above
+///        it.
+///
+/// @param vcc            mV
+/// @return PowerLevel
+//////////////////////////////////////////////////////////////////////////////
+PowerLevel nextPowerLevel(uint16_t vcc) {
+  PowerLevel falling = powerLevelBelow(vcc, 0);
+  PowerLevel rising = powerLevelBelow(vcc, VCC_HYSTERESIS);
+  PowerLevel level = rising < powerLevel ? rising : powerLevel;   // Better only with the hysteresis
+  return falling > level ? falling : level;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Power level for the supply voltage with thresholds raised by
+///        offset.
+///
+/// @param vcc            mV
+/// @param offset         mV
+/// @return PowerLevel
+//////////////////////////////////////////////////////////////////////////////
+PowerLevel powerLevelBelow(uint16_t vcc, uint16_t offset) {
+  if (vcc < VCC_CRITICAL + offset) { return PowerLevel::CRITICAL; }
+  return vcc < VCC_LOW + offset ? PowerLevel::SAVING : PowerLevel::NORMAL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Backlight limits and clock boost of the power level. The display
+///        is switched by taskDisplayOnOff(), the receiver sleep time is
+///        stretched at the next switch-off (sleepStretch()).
+///
+//////////////////////////////////////////////////////////////////////////////
+void applyPowerLevel() {
+  CpuClock::enable(powerLevel == PowerLevel::NORMAL);   // Not boosted here (taskBattery())
+  switch (powerLevel) {
+    case PowerLevel::NORMAL: limitBacklight(int1_second, BL_BRIGHTNESS_ON, BL_BURN_DURATION); break;
+    case PowerLevel::SAVING: limitBacklight(int1_second, BL_BRIGHTNESS_LOW, BL_BURN_DURATION_LOW); break;
+    case PowerLevel::CRITICAL: limitBacklight(int1_second, BL_BRIGHTNESS_OFF, 0); break;
+  }
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The receiver sleep time is multiplied by 2 ^ sleepStretch().
+///
+/// @return uint8_t   0 without BATTERY_MONITOR, otherwise the power level
+//////////////////////////////////////////////////////////////////////////////
+uint8_t sleepStretch() {
+#ifdef BATTERY_MONITOR
+  return static_cast<uint8_t>(powerLevel);
+#else
+  return 0;
+#endif
+}
+
+#ifdef NIGHT_MODE
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Wake-up from the alarm mode by an alarm or a button. Runs before
+///        taskButtons: the scheduler has to catch up before new deadlines
+///        are set (date display, receiver).
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskWake() {
+  if (!rtcAlarmMode) { return; }
+  if (leaveAlarmMode() & RTC::ALARM_TIMER) {
+    scheduler.cancelDeadline(taskIdReceiverOn);
+    taskReceiverOn();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches the 1Hz signal off. The daily alarm ends the night, the
+///        timer switches the receiver on when its deadline is reached. The
+///        deadlines of the scheduler stop until leaveAlarmMode().
+///
+//////////////////////////////////////////////////////////////////////////////
+void enterAlarmMode() {
+  CpuClock::Boost boost;
+  uint32_t now = rtcSecondOfDay();
+  uint8_t alarms = RTC::ALARM_DAILY;
+  if (scheduler.hasDeadline(taskIdReceiverOn)) {
+    uint16_t left = scheduler.remaining(taskIdReceiverOn);
+    if (left < NIGHT_MIN_ALARM) { return; }
+    RTC::setTimer(left, now);
+    alarms |= RTC::ALARM_TIMER;
+  }
+  RTC::setDailyAlarm(BCDConv::decToBcd(NIGHT_END_HOUR), 0);
+  alarmModeStart = now;
+  rtcAlarmMode = true;   // Before the pin changes: it is not a second edge
+  RTC::enableAlarms(alarms);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Switches the 1Hz signal on again. The scheduler catches up with
+///        the seconds without the signal.
+///
+/// @return uint8_t   Alarms that have occurred (RTC::ALARM_TIMER | RTC::ALARM_DAILY)
+//////////////////////////////////////////////////////////////////////////////
+uint8_t leaveAlarmMode() {
+  CpuClock::Boost boost;
+  uint8_t alarms = RTC::clearAlarms();
+  RTC::enable1Hz();
+  rtcAlarmMode = false;
+  uint32_t now = rtcSecondOfDay();
+  scheduler.advance((now + TimeCalc::SECONDS_PER_DAY - alarmModeStart) % TimeCalc::SECONDS_PER_DAY);
+  night = isNightTime(now);
+  return alarms;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Reads the time of the day from the RTC.
+///
+/// @return uint32_t  Seconds since midnight
+//////////////////////////////////////////////////////////////////////////////
+uint32_t rtcSecondOfDay() {
+  CpuClock::Boost boost;
+  uint8_t rtc[RTC::HOURS + 1];
+  RTC::readTime(rtc, sizeof(rtc));
+  return BCDConv::bcdToDec(rtc[RTC::HOURS]) * TimeCalc::SECONDS_PER_HOUR +
+         BCDConv::bcdToDec(rtc[RTC::MINUTES]) * TimeCalc::SECONDS_PER_MINUTE + BCDConv::bcdToDec(rtc[RTC::SECONDS]);
+}
+
+bool isNightTime(uint32_t secondOfDay) {
+  return isHourInRange(secondOfDay / TimeCalc::SECONDS_PER_HOUR, NIGHT_START_HOUR, NIGHT_END_HOUR);
+}
+#endif
+
+#ifdef RECEPTION_WINDOWS
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Time until the receiver is switched on: the start of the next
+///        reception window that is at least RECEIVER_MIN_SLEEP away, but
+///        not later than SYNC_MAX_AGE after the last sync. With a low
+///        battery the windows of the next days are skipped and SYNC_MAX_AGE
+///        is longer (sleepStretch()).
+///
+/// @param now        RTC time (TimeCalc epoch)
+/// @return uint32_t  Receiver off time (s)
+//////////////////////////////////////////////////////////////////////////////
+uint32_t receiverSleepTime(uint32_t now) {
+  uint32_t secondOfDay = now % TimeCalc::SECONDS_PER_DAY;
+  uint8_t stretch = sleepStretch();
+  uint32_t sleep = (SYNC_MAX_AGE << stretch) - (now - lastSyncEpoch);
+  uint32_t skipped = ((1UL << stretch) - 1) * TimeCalc::SECONDS_PER_DAY;
+  for (const ReceptionWindow &window : RECEPTION_WINDOW) {
+    uint32_t start = pgm_read_byte(&window.startHour) * TimeCalc::SECONDS_PER_HOUR;
+    uint32_t wait = (start + TimeCalc::SECONDS_PER_DAY - secondOfDay) % TimeCalc::SECONDS_PER_DAY;
+    if (wait < RECEIVER_MIN_SLEEP) { wait += TimeCalc::SECONDS_PER_DAY; }
+    wait += skipped;
+    if (wait < sleep) { sleep = wait; }
+  }
+  return sleep;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Checks if the time is in one of the reception windows.
+///
+/// @param now      RTC time (TimeCalc epoch)
+/// @return true    In a reception window
+//////////////////////////////////////////////////////////////////////////////
+bool isReceptionWindow(uint32_t now) {
+  uint8_t hour = now % TimeCalc::SECONDS_PER_DAY / TimeCalc::SECONDS_PER_HOUR;
+  for (const ReceptionWindow &window : RECEPTION_WINDOW) {
+    if (isHourInRange(hour, pgm_read_byte(&window.startHour), pgm_read_byte(&window.endHour))) { return true; }
+  }
+  return false;
+}
+#endif
+
+#if defined(RECEPTION_WINDOWS) || defined(SECOND_OUTPUT) || defined(PARTIAL_FRAMES) || defined(VERIFY_ONLY)
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Reads date and time from the RTC.
+///
+/// @return uint32_t  Seconds since 2000-01-01 (TimeCalc epoch)
+//////////////////////////////////////////////////////////////////////////////
+uint32_t rtcEpoch() {
+  CpuClock::Boost boost;
+  uint8_t rtc[RTC::TIME_REGS];
+  RTC::readTime(rtc, RTC::TIME_REGS);
+  return TimeCalc::toEpoch(TimeCalc::fromBcd(rtc[RTC::YEAR], rtc[RTC::MONTH] & RTC::MONTH_MASK, rtc[RTC::DATE],
+                                             rtc[RTC::HOURS], rtc[RTC::MINUTES], rtc[RTC::SECONDS]));
+}
+#endif
+
+#ifdef DCF77_OUTPUT
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Gives the DCF77 output the RTC time when it needs it (once a
+///        minute for the frame of the next minute, after the RTC has been
+///        set).
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskDcf77Out() {
+  if (DCF77Out::needsTime()) { DCF77Out::setTime(rtcEpoch(), dcf77.getZone()); }
+}
+#endif
+
+#ifdef SERIAL_TIME
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Prepares the time message of the next second. The RTC is read
+///        once a minute and after it has been set, in between the seconds
+///        are counted.
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskSerialTime() {
+  if (SerialTime::needsTime()) { SerialTime::setTime(rtcEpoch()); }
+  SerialTime::prepare(dcf77.getZone(), lastSyncEpoch);
+}
+#endif
+
+#ifdef PARTIAL_FRAMES
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Gives the DCF77 decoder the RTC time for the alignment of the bits
+///        while the receiver is on: after switching it on and after the RTC
+///        has been set. Runs after the 1Hz edge, so the second that is read
+///        is the counted one.
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskRtcAlign() {
+  if (dcf77PoweredOn && dcf77.needsRtcTime()) { dcf77.setRtcTime(rtcEpoch()); }
+}
+#endif
+
+#ifdef VERIFY_ONLY
+//////////////////////////////////////////////////////////////////////////////
+/// @brief A verification switches the receiver on VERIFY_LEAD seconds before
+///        the minute mark predicted by the RTC. Earlier the deadline of
+///        taskReceiverOn is moved to this second.
+///
+/// @return true    Switch the receiver on now
+/// @return false   Deadline set
+//////////////////////////////////////////////////////////////////////////////
+bool startVerify() {
+  uint32_t now = rtcEpoch();
+  uint8_t toMark = TimeCalc::SECONDS_PER_MINUTE - now % TimeCalc::SECONDS_PER_MINUTE;
+  uint8_t wait = (toMark + TimeCalc::SECONDS_PER_MINUTE - VERIFY_LEAD) % TimeCalc::SECONDS_PER_MINUTE;
+  if (wait != 0 && wait < TimeCalc::SECONDS_PER_MINUTE - VERIFY_LATE) {
+    scheduler.setDeadline(taskIdReceiverOn, wait);
+    return false;
+  }
+  verifyMark = now + toMark;
+  verifying = true;
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Verification of the RTC with the minute being received, as soon
+///        as bit 35 has been classified (compareWithRtc()). If the RTC
+///        agrees the receiver is switched off, the date bits are not waited
+///        for. Otherwise, or without bit 35 VERIFY_TIMEOUT after the minute
+///        mark, the attempt goes on with a full decode and the next one is a
+///        full attempt too unless it synchronizes.
+///
+/// @return true    The verification goes on or the receiver is off
+/// @return false   The attempt goes on with a full decode
+//////////////////////////////////////////////////////////////////////////////
+bool verifyReception() {
+  if (showQuality) {
+    verifying = false;
+    return false;
+  }
+  uint64_t bits;
+  uint32_t edgeMicros;
+  uint8_t second = dcf77.getSequence(bits, edgeMicros);
+  uint16_t onTime = scheduler.now() - receiverOnSince;
+  int32_t offset = 0;
+  VerifyResult result = VerifyResult::SECOND_MARKS;
+  // Until the first second mark the count is that of the last attempt (switched off after bit 35)
+  if (second > DCF77Bit::PARITY_HOURS && onTime > VERIFY_LEAD - VERIFY_LATE + DCF77Bit::PARITY_HOURS) {
+    result = compareWithRtc(second, bits, edgeMicros, offset);
+  } else if (onTime < VERIFY_LEAD + VERIFY_TIMEOUT) {
+    return true;
+  }
+  TRACE(VERIFY, static_cast<uint8_t>(result), Trace::clip(offset));
+  verifying = false;
+  if (result != VerifyResult::AGREE) {
+    verifyNext = false;
+    return false;
+  }
+  uint32_t sleep = rtcConfirmed();
+  TRACE(RECEIVER_OFF, static_cast<uint8_t>(ReceiverOff::VERIFIED), sleep / TimeCalc::SECONDS_PER_MINUTE);
+  switchReceiverOff(sleep);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Compares the minute being received with the RTC: the count of the
+///        seconds since the minute mark, the start bit, the minutes and the
+///        hours (bits 20-35) and the phase of the last second mark (as
+///        measureRtcOffset()). Must be called shortly after a counted edge of
+///        the RTC 1Hz signal.
+///
+/// @param second       Seconds since the minute mark (DCF77Receive::getSequence())
+/// @param bits         Bits received since the minute mark
+/// @param edgeMicros   Time stamp of the last second mark
+/// @param offset       Offset RTC - DCF77 in microseconds (AGREE, PHASE)
+/// @return VerifyResult
+//////////////////////////////////////////////////////////////////////////////
+VerifyResult compareWithRtc(uint8_t second, uint64_t bits, uint32_t edgeMicros, int32_t &offset) {
+  CpuClock::Boost boost;
+  noInterrupts();
+  uint32_t rtcSecondStart = int1_edgeMicros - RTC::tickPhase(int1_periodMicros);
+  interrupts();
+  // A missed minute mark or second mark shifts the count against the RTC
+  int32_t diff = static_cast<int32_t>(rtcEpoch() - verifyMark) - second;
+  if (diff > 1 || diff < -1) { return VerifyResult::SECOND_MARKS; }
+  // The frame sent in a minute holds the time of the next minute mark
+  uint64_t expected =
+      DCF77Clock::encodeSequence(TimeCalc::fromEpoch(verifyMark + TimeCalc::SECONDS_PER_MINUTE), dcf77.getZone());
+  if ((bits ^ expected) & VERIFY_BITS) { return VerifyResult::BITS; }
+  offset = diff * static_cast<int32_t>(SECOND_MICROS) + static_cast<int32_t>(edgeMicros - rtcSecondStart);
+  return abs(offset) < RTC_PHASE_TOLERANCE ? VerifyResult::AGREE : VerifyResult::PHASE;
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Checks if an hour is in the range start (included) ... end
+///        (excluded). The range may contain midnight (start > end).
+///
+/// @param hour
+/// @param start
+/// @param end
+/// @return true    In the range
+//////////////////////////////////////////////////////////////////////////////
+bool isHourInRange(uint8_t hour, uint8_t start, uint8_t end) {
+  if (start > end) { return hour >= start || hour < end; }
+  return hour >= start && hour < end;
+}
+
+#ifdef TRACE_ENABLED
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Send the trace records. Once a minute the unused stack is
+///        reported (high-water mark, lib/memcheck).
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskTrace() {
+  static uint8_t lastSecond{0};
+  uint8_t second = int1_second;
+  if (second == 0 && lastSecond != 0) { TRACE(STACK, 0, MemCheck::stackUnused()); }
+  lastSecond = second;
+  Trace::drain();
+}
+#endif
+
+#ifdef CAPTURE_ENABLED
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Send the captured edges of the DCF77 signal.
+///
+//////////////////////////////////////////////////////////////////////////////
+void taskCapture() { Capture::drain(); }
+#endif
+
 //////////////////////////////////////////////////////////////////////////////
 /// @brief Control the synchronization between the two clocks
 ///
+///        1. WAIT_FRAME: Wait for a correctly received DCF77 sequence.
+///        2. MEASURE:    At the next 1Hz edge of the RTC (DS3231: in the middle of a
+///                       second) read the RTC and measure the time offset to the DCF77
+///                       time. If it is too big, the RTC write is prepared for the start
+///                       of a following DCF77 second.
+///        3. WRITE:      At every wake-up: shortly before that second the RTC is set with
+///                       one burst write. If a long task missed it, the next second is taken.
+///        4. VERIFY:     At the next 1Hz edge the remaining phase error is measured.
+///
 /// @return true        There is a time difference between the dcf77 and the RTC time.
 /// @return false       There is no time difference. Both clocks are synchronous.
 //////////////////////////////////////////////////////////////////////////////
 bool rtcNeedsSync() {
+  static uint8_t tick;
+  static uint32_t setEdgeMicros;
+  static uint8_t setSecond;
+#ifdef TRACE_ENABLED
+  static uint16_t setOffsetMs;   // Measured offset for the RTC_WRITE record
+#endif
+  static uint8_t setRegs[RTC::TIME_REGS];
+  static uint32_t periodMicros;
   decltype(rtcNeedsSync()) rtcSetTime{true};
-  //
-  // If the sequenceflag != MAX_SECOND  then the sequence was not received correctly,
-  // unless it is a leap second sequence.
-  // In this case, the second counter must not be unequal to MAX_SECONDS + 1.
-  //
-  DCF77Sequence state = dcf77.getSequenceFlag();
-  if (state == MAX_SECONDS || (state == LEAP_SECOND && dcf77.getLeapSecond())) {
-
-    switch (dcf77.decodeSequence()) {
-      case false:
-        break;   // if the parity of the data sequence is not OK do nothing here.
-
-      // Compare the DCF77 time with the RTC time. The RTC will only be set if there is a time difference
-      // Because only every full minute is checked, the dcf77 seconds are always 0.
-      case true:
-        uint8_t dcf77Compare = dcf77.getMinutes() + dcf77.getHours();
-        uint8_t rtcCompare = BCDConv::bcdToDec(DS3231::readRegister(DS3231::SECONDS)) +
-                             BCDConv::bcdToDec(DS3231::readRegister(DS3231::MINUTES)) +
-                             BCDConv::bcdToDec(DS3231::readRegister(DS3231::HOURS));
-        uint8_t timeCompareDiff = rtcCompare - dcf77Compare;
-
-#ifdef DEBUG_DCF77CONTROL
-        Serial.println("");
-        Serial.print(F("int1_second        : "));
-        Serial.println(int1_second);
-        Serial.print(F("RTC   Compare Value: "));
-        Serial.println(rtcCompare);
-        Serial.print(F("DCF77 Compare Value: "));
-        Serial.println(dcf77Compare);
-        Serial.print(F("Diff. RTC to DCF77 : "));
-        Serial.println(timeCompareDiff);
-        Serial.print(F("Parity             : "));
-        Serial.println(parityOK);
-#endif
-        // When timeCompareDiff is non-zero and not 59 at an hour change
-        // there is a time difference -> set RTC Clock.
-        switch (timeCompareDiff && timeCompareDiff != HOUR_CHANGE) {
-          case true:
-            DS3231::setDateTime(dcf77.getBcdYear(), dcf77.getBcdMonth(), dcf77.getBcdDay(), dcf77.getBcdHours(),
-                                dcf77.getBcdMinutes(),
-                                1   // Second.
-            );
-            // no break!
-          case false: rtcSetTime = false; break;
-        }   // Switch2
+
+  switch (syncState) {
+    case SyncState::WAIT_FRAME: {
+      //
+      // If the sequenceflag != MAX_SECOND  then the sequence was not received correctly,
+      // unless it is a leap second sequence.
+      // In this case, the second counter must not be unequal to MAX_SECONDS + 1.
+      //
+      CpuClock::Boost boost;
+      DCF77Sequence seqState = dcf77.getSequenceFlag();
+      bool valid =
+          (seqState == MAX_SECONDS || (seqState == LEAP_SECOND && dcf77.getLeapSecond())) && dcf77.decodeSequence();
+#ifdef PARTIAL_FRAMES
+      valid = valid || dcf77.decodePartial();   // Assembled from incomplete minutes, RTC-aligned seconds
+#endif
+      if (valid) {
+        tick = int1_second;
+        syncState = SyncState::MEASURE;
+      }
+    } break;
+
+    case SyncState::MEASURE: {
+      if (tick == int1_second) { break; }   // Wait for the next 1Hz edge of the RTC
+      noInterrupts();
+      periodMicros = int1_periodMicros;   // Setting the RTC disturbs the next period measurement
+      interrupts();
+      uint32_t edgeMicros;
+      uint8_t edgeSecond;
+      int32_t offset;
+      {
+        CpuClock::Boost boost;
+        offset = measureRtcOffset(edgeMicros, edgeSecond);
+      }
+      syncState = SyncState::WAIT_FRAME;
+      if (abs(offset) < RTC_PHASE_TOLERANCE) {
+        rtcSetTime = false;   // Both clocks are synchronous
+      } else if (prepareRtcWrite(edgeMicros, edgeSecond, periodMicros, setRegs)) {
+        setEdgeMicros = edgeMicros;
+        setSecond = edgeSecond;
+#ifdef TRACE_ENABLED
+        setOffsetMs = Trace::clip(offset / 1000);
+#endif
+        waitForRtcWrite(true);
+        syncState = SyncState::WRITE;
+      }
+    } break;
+
+    case SyncState::WRITE: {
+      if (static_cast<int32_t>(TimeBase::micros() - setEdgeMicros) > 0 &&
+          !prepareRtcWrite(setEdgeMicros, setSecond, periodMicros, setRegs)) {
+        waitForRtcWrite(false);   // Missed and the end of the minute is too near
+        syncState = SyncState::WAIT_FRAME;
         break;
-    }   // Switch1
+      }
+      if (!writeRtcAt(setEdgeMicros, setRegs)) { break; }   // Sleep until a later wake-up
+      TRACE(RTC_WRITE, setSecond, setOffsetMs);
+      waitForRtcWrite(false);
+      tick = int1_second;
+      syncState = SyncState::VERIFY;
+    } break;
+
+    case SyncState::VERIFY: {
+      if (tick == int1_second) { break; }   // The first 1Hz edge after setting the seconds
+      noInterrupts();
+      uint32_t rtcSecondStart = int1_edgeMicros - RTC::tickPhase(periodMicros);
+      interrupts();
+      rtcPhaseError = static_cast<int32_t>(rtcSecondStart - setEdgeMicros);
+      // The first edge can belong to the next second (RV-3028: the reset of the prescaler gives no edge)
+      if (rtcPhaseError > static_cast<int32_t>(periodMicros >> 1)) { rtcPhaseError -= periodMicros; }
+      TRACE(RTC_PHASE, 0, Trace::clip(rtcPhaseError));
+      syncState = SyncState::WAIT_FRAME;
+      // If the RTC was not set accurately enough, it will be checked again with the next sequence.
+      rtcSetTime = (abs(rtcPhaseError) >= RTC_PHASE_TOLERANCE);
+    } break;
   }
   return rtcSetTime;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Measures the time offset between RTC and DCF77 time.
+///        Must be called shortly after a counted edge of the RTC 1Hz signal. The
+///        RTC second started RTC::tickPhase() before this edge. The DCF77 second
+///        started at the last second mark.
+///
+/// @param edgeMicros   Time stamp of the last DCF77 second mark
+/// @param edgeSecond   DCF77 second that started with the last second mark
+/// @return int32_t     Offset RTC - DCF77 in microseconds. OFFSET_UNKNOWN if the offset
+///                     is more than MAX_SECONDS_DIFF seconds.
+//////////////////////////////////////////////////////////////////////////////
+int32_t measureRtcOffset(uint32_t &edgeMicros, uint8_t &edgeSecond) {
+  uint8_t rtc[RTC::TIME_REGS];
+
+  noInterrupts();
+  uint32_t rtcSecondStart = int1_edgeMicros - RTC::tickPhase(int1_periodMicros);
+  interrupts();
+  edgeSecond = dcf77.getLastEdge(edgeMicros);
+  RTC::readTime(rtc, RTC::TIME_REGS);
+
+  int32_t diff = TimeCalc::diff(TimeCalc::fromBcd(rtc[RTC::YEAR], rtc[RTC::MONTH] & RTC::MONTH_MASK, rtc[RTC::DATE],
+                                                  rtc[RTC::HOURS], rtc[RTC::MINUTES], rtc[RTC::SECONDS]),
+                                TimeCalc::addSeconds(dcf77.getDateTime(), edgeSecond));
+  if (diff > MAX_SECONDS_DIFF || diff < -MAX_SECONDS_DIFF) { return OFFSET_UNKNOWN; }
+  return diff * static_cast<int32_t>(SECOND_MICROS) + static_cast<int32_t>(edgeMicros - rtcSecondStart);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Prepares the RTC registers for the start of the next DCF77 second
+///        that is at least RTC_WRITE_LEAD away.
+///        The decoder accepts a second mark only at the end of its pulse, too
+///        late for the write. So the second starts a whole number of RTC
+///        seconds (periodMicros) after the last accepted second mark.
+///
+/// @param edgeMicros     Time stamp of a DCF77 second mark, returns the start of the set second
+/// @param edgeSecond     DCF77 second that started with that second mark, returns the set second
+/// @param periodMicros   Measured length of one RTC second
+/// @param rtc            Returns the registers (RTC::TIME_REGS)
+/// @return true          Prepared, write with writeRtcAt().
+/// @return false         The end of the minute is too near.
+//////////////////////////////////////////////////////////////////////////////
+bool prepareRtcWrite(uint32_t &edgeMicros, uint8_t &edgeSecond, uint32_t periodMicros, uint8_t *rtc) {
+  if (edgeSecond >= MAX_EDGE_SECOND) { return false; }
+  do {
+    edgeMicros += periodMicros;
+    if (++edgeSecond > MAX_EDGE_SECOND + 1) { return false; }
+  } while (static_cast<int32_t>(edgeMicros - TimeBase::micros()) < RTC_WRITE_LEAD);
+
+  const TimeCalc::DateTime t = TimeCalc::addSeconds(dcf77.getDateTime(), edgeSecond);
+  rtc[RTC::SECONDS] = BCDConv::decToBcd(t.second);
+  rtc[RTC::MINUTES] = BCDConv::decToBcd(t.minute);
+  rtc[RTC::HOURS] = BCDConv::decToBcd(t.hour);
+  rtc[RTC::DAY] = TimeCalc::dayOfWeek(t);
+  rtc[RTC::DATE] = BCDConv::decToBcd(t.day);
+  rtc[RTC::MONTH] = BCDConv::decToBcd(t.month);
+  rtc[RTC::YEAR] = BCDConv::decToBcd(t.year);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the RTC with one burst write at the given time, if it is at
+///        most RTC_WRITE_SPIN away (busy wait). Writing the seconds register
+///        resets the countdown chain of the RTC, so the RTC second starts with
+///        the DCF77 second.
+///
+/// @param edgeMicros     Start of the DCF77 second (TimeBase::micros())
+/// @param rtc            Registers of prepareRtcWrite()
+/// @return true          The RTC has been set.
+/// @return false         Too early, the MCU may sleep until the next wake-up.
+//////////////////////////////////////////////////////////////////////////////
+bool writeRtcAt(uint32_t edgeMicros, const uint8_t *rtc) {
+  if (static_cast<int32_t>(edgeMicros - TimeBase::micros()) > RTC_WRITE_SPIN) { return false; }
+  while (static_cast<int32_t>(TimeBase::micros() - edgeMicros) < 0) {}
+  CpuClock::Boost boost;
+  RTC::writeTime(rtc);
+#ifdef DCF77_OUTPUT
+  DCF77Out::resync();
+#endif
+#ifdef SERIAL_TIME
+  SerialTime::resync();
+#endif
+#ifdef PARTIAL_FRAMES
+  dcf77.resyncRtc();
+  dcf77.clearPartial();   // The captures refer to the old RTC minutes
+#endif
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief While an RTC write is pending, taskSync() runs at every wake-up and
+///        the Timer0 overflow wakes the MCU from idle every 2 ms (also with
+///        RTC_TIMEBASE, TimeBase::setTimer0Wakeup()).
+///
+/// @param wait
+//////////////////////////////////////////////////////////////////////////////
+void waitForRtcWrite(bool wait) {
+  constexpr uint8_t events{Sched::EV_SECOND | Sched::EV_DCF77};
+  scheduler.setEvents(taskIdSync, wait ? events | Sched::EV_WAKEUP : events);
+  TimeBase::setTimer0Wakeup(wait);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Pin change interrupt of port D: 1Hz signal of the RTC (edge
+///        RTC::TICK_RISING) or RTC alarm (falling edge, rtcAlarmMode) and buttons.
+///        DCF77_OUTPUT, SERIAL_TIME: the falling edge of the 1Hz signal
+///        starts the RTC second (both backends), the time message with the
+///        PPS pulse (first, its latency is specified) and the DCF77 pulse.
+///
+//////////////////////////////////////////////////////////////////////////////
+ISR(PCINT2_vect) {
+  static bool sqwHigh{false};
+  bool sqw = digitalReadFast(RTC_SQW_PIN);
+  if (sqw != sqwHigh) {
+    if (rtcAlarmMode) {
+      if (!sqw) { Sched::Scheduler::signal(Sched::EV_ALARM); }
+    } else {
+#ifdef SERIAL_TIME
+      if (!sqw && SerialTime::tick()) { Sched::Scheduler::signal(Sched::EV_WAKEUP); }   // New sleep mode (idle)
+#endif
+#ifdef DCF77_OUTPUT
+      if (!sqw && DCF77Out::tick()) { Sched::Scheduler::signal(Sched::EV_WAKEUP); }   // New sleep mode (idle)
+#endif
+      if (sqw == RTC::TICK_RISING) { check1HzSig(); }
+    }
+  }
+  sqwHigh = sqw;
+  Btn::ButtonIRQ::pinChange();
+}
+
 //////////////////////////////////////////////////////////////////////////////
 /// @brief Count the seconds using the 1Hz signal from the RTC.
 ///
 //////////////////////////////////////////////////////////////////////////////
 void check1HzSig() {
+  uint32_t now = TimeBase::micros();
+  int1_periodMicros = now - int1_edgeMicros;
+  int1_edgeMicros = now;
   int1_second = (int1_second + 1) % 60;
-#ifdef DEBUG_INT1
-  Serial.println(int1_second);
+#ifdef PARTIAL_FRAMES
+  dcf77.rtcTick(now - RTC::tickPhase(SECOND_MICROS));   // The measured period is wrong after a pause of the 1Hz signal
 #endif
+  Sched::Scheduler::signal(Sched::EV_SECOND);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Called by the DCF77 ISR when a complete sequence has been received.
+///
+//////////////////////////////////////////////////////////////////////////////
+void dcf77SequenceReceived() { Sched::Scheduler::signal(Sched::EV_DCF77); }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Called by the watchdog ISR when a button has been pressed or released.
+///
+//////////////////////////////////////////////////////////////////////////////
+void buttonEvent() { Sched::Scheduler::signal(Sched::EV_BUTTON); }
+
 //////////////////////////////////////////////////////////////////////////////
 /// @brief Disable unused peripherals and set unused Pins to input with internal
 ///        pullups
@@ -346,6 +1477,8 @@ void optimizePowerConsumption(void) {
   //
   // Pin A4 PC4    Used PC -> 0011 0000
   // Pin A5 PC5
+  // Pin A0 PC0 is an output with DCF77_OUTPUT (DCF77Out::begin())
+  // Pin 06 PD6 and A1 PC1 are outputs with SERIAL_TIME (SerialTime::begin())
 
 #if defined(DEV_BOARD)
 #define PORTSB 0x2F
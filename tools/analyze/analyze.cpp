@@ -0,0 +1,556 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file analyze.cpp
+/// @author Kai R.
+/// @brief Host tool: statistics of archives of raw DCF77 edge captures
+///        (lib/capture) recorded by many clocks over weeks. The captures are
+///        decoded by the unchanged DCF77Receive/DCF77Clock code, like in
+///        tools/replay.
+///
+///        Build:   pio run -e analyze
+///        Usage:   .pio/build/analyze/program [--jobs n] [--chunk kB] [--deglitch pulse,gap] [--fixed] path ...
+///                 path        capture file or directory (all *.dcf files below it)
+///                 --jobs      chunks decoded at the same time (default: number of CPUs)
+///                 --chunk     nominal chunk size (default 1024 kB, about 3 days of signal)
+///                 --deglitch  DCF77Receive::setDeglitch() (ms, 0 = off)
+///                 --fixed     constant pulse thresholds (DCF77Receive::setAdaptive(false))
+///
+///        Archive layout: <archive>/<site>/<capture>.dcf. The site of a
+///        capture is the name of its directory.
+///
+///        The files are memory-mapped and split into chunks of about --chunk
+///        bytes. A chunk starts at the first minute mark (rising edge after a
+///        gap of at least MINUTE_GAP_MS) behind its nominal start and ends
+///        where the next chunk starts, so every edge is decoded once.
+///        DCF77Receive keeps its state in static members, so threads cannot
+///        share the decoder: every chunk is decoded in its own process
+///        (fork()) like a reset clock, up to --jobs at a time. The first
+///        valid sequence of a chunk needs two minutes, so a chunk boundary
+///        costs one valid sequence (less than 0.1 % with the default size).
+///
+///        Per site and in total:
+///        - minutes      receiver on-time. A time without edges longer than
+///                       OFF_GAP_MS is off time (the clock power-cycles a
+///                       receiver without second marks much sooner)
+///        - complete     sequences with 59 (60) seconds
+///        - valid        decodeSequence() == true (the RTC would be set)
+///        - success      valid / minutes
+///        - bit errors   bits 17, 18, 20-58 of the complete sequences that
+///                       differ from the frame of the time given by the
+///                       nearest valid sequence (at most ANCHOR_RANGE_MS
+///                       away). Incomplete minutes are not counted.
+///        - by hour      success by the hour of the DCF77 time, which comes
+///                       from the nearest valid sequence of the chunk. The
+///                       on-time of chunks without a valid sequence has no
+///                       hour.
+///        - pulse widths histogram of the raw pulse widths (before the
+///                       deglitch filter)
+///        The throughput (minutes of signal decoded per second) is printed
+///        to stderr, so the statistics of two decoder versions can be
+///        compared with diff.
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "capture_file.hpp"
+#include "dcf77.hpp"
+#include "timecalc.hpp"
+
+namespace {
+constexpr uint8_t DCF77_INT_PIN{PIND2};
+constexpr uint32_t MINUTE_MS{60000};
+constexpr uint32_t HOUR_MS{3600000};
+constexpr uint32_t MINUTE_GAP_MS{1500};            // A rising edge after a longer gap starts a chunk
+constexpr uint32_t OFF_GAP_MS{300000};             // No edge for a longer time: the receiver is off
+constexpr uint32_t ANCHOR_RANGE_MS{30 * MINUTE_MS};   // The MCU clock may be 1 % wrong: < 30 s
+constexpr uint8_t HOURS_PER_DAY{24};
+constexpr uint8_t HOUR_UNKNOWN{HOURS_PER_DAY};     // Chunk without a valid sequence
+constexpr uint8_t PULSE_BIN_MS{10};
+constexpr uint8_t PULSE_BINS{30};                  // The last bin counts the longer pulses too
+constexpr uint32_t DEFAULT_CHUNK_KB{1024};
+// Zone bits, start bit, time and date with their parities. Not the weather data, the call bit and the announcements.
+constexpr uint64_t COMPARED_BITS{(((1ULL << (DCF77Bit::PARITY_DATE + 1)) - 1) & ~((1ULL << DCF77Bit::START) - 1)) |
+                                 (3ULL << DCF77Bit::ZONE)};
+
+// Statistics of a chunk, a site or all captures. Sent through a pipe by the child process.
+struct Stats {
+  uint64_t onTimeMs;
+  uint64_t offTimeMs;
+  uint32_t complete;
+  uint32_t valid;
+  uint64_t bitsCompared;
+  uint64_t bitErrors;
+  uint32_t unanchored;   // Complete sequences without a valid one within ANCHOR_RANGE_MS
+  uint64_t hourOnTimeMs[HOURS_PER_DAY + 1];
+  uint32_t hourValid[HOURS_PER_DAY + 1];
+  uint32_t pulses[PULSE_BINS];
+  uint32_t skippedBytes;
+  uint32_t droppedEdges;
+  uint32_t chunks;
+};
+static_assert(sizeof(Stats) <= PIPE_BUF, "The result of a chunk is written to the pipe at once");
+
+struct Site {
+  Stats stats;
+  uint32_t files;
+};
+
+struct File {
+  std::string path;
+  std::string site;
+  size_t size;
+};
+
+struct Chunk {
+  uint32_t file;
+  size_t nominalStart;
+  size_t nominalEnd;
+};
+
+struct Frame {
+  uint64_t markMs;   // Minute mark at the end of the sequence (ms on the time line of the chunk)
+  uint64_t bits;
+};
+
+struct Anchor {
+  uint64_t markMs;
+  uint32_t epoch;   // DCF77 time at the minute mark (TimeCalc epoch)
+  uint8_t zone;
+};
+
+struct Segment {
+  uint64_t startMs;
+  uint64_t endMs;
+};
+
+// The complete sequence stays in the mailbox of DCF77Receive until the next minute mark.
+class FrameClock : public DCF77Clock {
+public:
+  uint64_t frameBits(void) const { return _frame.bits; }
+};
+
+volatile bool sequenceReceived{false};
+int minPulse{DEGLITCH_MIN_PULSE};
+int minGap{DEGLITCH_MIN_GAP};
+bool adaptive{true};
+
+void onSequence() { sequenceReceived = true; }
+
+void add(Stats &total, const Stats &s) {
+  total.onTimeMs += s.onTimeMs;
+  total.offTimeMs += s.offTimeMs;
+  total.complete += s.complete;
+  total.valid += s.valid;
+  total.bitsCompared += s.bitsCompared;
+  total.bitErrors += s.bitErrors;
+  total.unanchored += s.unanchored;
+  for (uint8_t h = 0; h <= HOURS_PER_DAY; ++h) {
+    total.hourOnTimeMs[h] += s.hourOnTimeMs[h];
+    total.hourValid[h] += s.hourValid[h];
+  }
+  for (uint8_t i = 0; i < PULSE_BINS; ++i) { total.pulses[i] += s.pulses[i]; }
+  total.skippedBytes += s.skippedBytes;
+  total.droppedEdges += s.droppedEdges;
+  total.chunks += s.chunks;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Start of the chunk with the given nominal start: the first minute
+///        mark at or behind it. Neighbouring chunks agree on their boundary.
+///
+/// @param data
+/// @param size
+/// @param nominal    Byte offset, 0 = start of the file
+/// @return size_t    Start of the value of the minute mark, size if there is none
+//////////////////////////////////////////////////////////////////////////////
+size_t chunkStart(const uint8_t *data, size_t size, size_t nominal) {
+  if (nominal == 0 || nominal >= size) { return nominal < size ? 0 : size; }
+  CaptureFile::Reader reader(data, size, nominal);
+  reader.sync();
+  CaptureFile::Edge edge;
+  for (;;) {
+    size_t start = reader.position();
+    if (!reader.next(edge)) { return size; }
+    if (edge.level && edge.duration >= MINUTE_GAP_MS) { return start; }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Valid sequence nearest to a time of the chunk.
+///
+/// @param anchors    Sorted by the time
+/// @param ms         ms on the time line of the chunk
+/// @return const Anchor*   nullptr without valid sequences
+//////////////////////////////////////////////////////////////////////////////
+const Anchor *nearestAnchor(const std::vector<Anchor> &anchors, uint64_t ms) {
+  if (anchors.empty()) { return nullptr; }
+  auto next = std::lower_bound(anchors.begin(), anchors.end(), ms,
+                               [](const Anchor &a, uint64_t t) { return a.markMs < t; });
+  if (next == anchors.end()) { return &anchors.back(); }
+  if (next == anchors.begin() || next->markMs - ms < ms - (next - 1)->markMs) { return &*next; }
+  return &*(next - 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief DCF77 time (ms since the TimeCalc epoch) at a time of the chunk.
+///
+//////////////////////////////////////////////////////////////////////////////
+int64_t epochMs(const Anchor &anchor, uint64_t ms) {
+  return static_cast<int64_t>(anchor.epoch) * 1000 + static_cast<int64_t>(ms - anchor.markMs);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Adds the on-time of a segment to the hours of the DCF77 time.
+///
+/// @param s
+/// @param anchors
+/// @param segment
+//////////////////////////////////////////////////////////////////////////////
+void addOnTime(Stats &s, const std::vector<Anchor> &anchors, const Segment &segment) {
+  if (anchors.empty()) {
+    s.hourOnTimeMs[HOUR_UNKNOWN] += segment.endMs - segment.startMs;
+    return;
+  }
+  for (uint64_t ms = segment.startMs; ms < segment.endMs;) {
+    int64_t time = epochMs(*nearestAnchor(anchors, ms), ms);
+    uint64_t step = HOUR_MS - time % HOUR_MS;
+    if (step > segment.endMs - ms) { step = segment.endMs - ms; }
+    s.hourOnTimeMs[time / HOUR_MS % HOURS_PER_DAY] += step;
+    ms += step;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Decodes a chunk like a reset clock that receives it, then
+///        compares the complete sequences with the nearest valid one.
+///
+/// @param data
+/// @param start    First byte of the chunk
+/// @param end      First byte behind the chunk
+/// @return Stats
+//////////////////////////////////////////////////////////////////////////////
+Stats analyzeChunk(const uint8_t *data, size_t start, size_t end) {
+  Stats s{};
+  s.chunks = 1;
+  FrameClock dcf77;
+  dcf77.begin(DCF77_INT_PIN);
+  dcf77.setSequenceCallback(onSequence);
+  dcf77.setDeglitch(minPulse, minGap);
+  dcf77.setAdaptive(adaptive);
+
+  std::vector<Frame> frames;
+  std::vector<Anchor> anchors;
+  std::vector<Segment> segments;
+  CaptureFile::Reader reader(data, end, start);
+  CaptureFile::Edge edge;
+  uint64_t now = Host::getMicros();
+  uint64_t ms = 0;   // Since the first edge of the file or the last edge before the chunk
+  Segment segment{0, 0};
+  bool first = (start == 0);   // The first duration of a file is measured from the start of the device
+  bool lastLevel = false;
+
+  while (reader.next(edge)) {
+    if (!first) {
+      if (edge.level == lastLevel) { ++s.droppedEdges; }
+      if (edge.duration >= OFF_GAP_MS) {
+        segment.endMs = ms;
+        if (segment.endMs > segment.startMs) { segments.push_back(segment); }
+        segment.startMs = ms + edge.duration;
+        s.offTimeMs += edge.duration;
+      } else {
+        s.onTimeMs += edge.duration;
+        if (!edge.level) { ++s.pulses[std::min<uint32_t>(edge.duration / PULSE_BIN_MS, PULSE_BINS - 1)]; }
+      }
+      ms += edge.duration;
+    }
+    first = false;
+    lastLevel = edge.level;
+    now += static_cast<uint64_t>(edge.duration) * 1000;
+    Host::setMicros(now);
+    sequenceReceived = false;
+    Host::setPin(DCF77_INT_PIN, edge.level);
+    dcf77.updateThresholds();   // Main context of the firmware (taskSync())
+    if (!sequenceReceived) { continue; }
+
+    // Decoded at once, as taskSync() does on the clock
+    ++s.complete;
+    uint64_t bits = dcf77.frameBits();
+    frames.push_back(Frame{ms, bits});
+    if (dcf77.decodeSequence()) {
+      ++s.valid;
+      uint32_t epoch = TimeCalc::toEpoch(dcf77.getDateTime());
+      anchors.push_back(Anchor{ms, epoch, static_cast<uint8_t>((bits >> DCF77Bit::ZONE) & 0x03)});
+      ++s.hourValid[(epoch - 1) / TimeCalc::SECONDS_PER_HOUR % HOURS_PER_DAY];   // Received before the mark
+    }
+  }
+  segment.endMs = ms;
+  if (segment.endMs > segment.startMs) { segments.push_back(segment); }
+  s.skippedBytes = reader.skippedBytes();
+
+  for (const Frame &frame : frames) {
+    const Anchor *anchor = nearestAnchor(anchors, frame.markMs);
+    uint64_t distance = anchor ? (frame.markMs > anchor->markMs ? frame.markMs - anchor->markMs
+                                                                : anchor->markMs - frame.markMs)
+                               : 0;
+    if (!anchor || distance > ANCHOR_RANGE_MS) {
+      ++s.unanchored;
+      continue;
+    }
+    int64_t minutes = llround(static_cast<int64_t>(frame.markMs - anchor->markMs) / static_cast<double>(MINUTE_MS));
+    uint32_t epoch = anchor->epoch + minutes * TimeCalc::SECONDS_PER_MINUTE;
+    uint64_t expected = DCF77Clock::encodeSequence(TimeCalc::fromEpoch(epoch), anchor->zone);
+    s.bitErrors += __builtin_popcountll((frame.bits ^ expected) & COMPARED_BITS);
+    s.bitsCompared += __builtin_popcountll(COMPARED_BITS);
+  }
+  for (const Segment &on : segments) { addOnTime(s, anchors, on); }
+  return s;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Child process: maps the file and analyzes one chunk.
+///
+/// @param file
+/// @param chunk
+/// @param s
+/// @return true    Analyzed
+/// @return false   File could not be read
+//////////////////////////////////////////////////////////////////////////////
+bool analyzeFileChunk(const File &file, const Chunk &chunk, Stats &s) {
+  s = Stats{};
+  s.chunks = 1;
+  if (file.size == 0) { return true; }
+  int fd = open(file.path.c_str(), O_RDONLY);
+  if (fd < 0) { return false; }
+  void *map = mmap(nullptr, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) { return false; }
+  madvise(map, file.size, MADV_SEQUENTIAL);
+  const uint8_t *data = static_cast<const uint8_t *>(map);
+  size_t start = chunkStart(data, file.size, chunk.nominalStart);
+  size_t end = chunkStart(data, file.size, chunk.nominalEnd);
+  if (start < end) { s = analyzeChunk(data, start, end); }
+  munmap(map, file.size);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Adds a capture file or all *.dcf files below a directory (sorted).
+///
+/// @param path
+/// @param files
+/// @return true    Found
+/// @return false   Not found
+//////////////////////////////////////////////////////////////////////////////
+bool collect(const std::string &path, std::vector<File> &files) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) { return false; }
+  if (S_ISDIR(st.st_mode)) {
+    DIR *dir = opendir(path.c_str());
+    if (!dir) { return false; }
+    std::vector<std::string> names;
+    while (const dirent *entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name != "." && name != "..") { names.push_back(name); }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    for (const std::string &name : names) {
+      std::string child = path + "/" + name;
+      struct stat cst;
+      if (stat(child.c_str(), &cst) != 0) { continue; }
+      bool capture = name.size() > 4 && name.compare(name.size() - 4, 4, ".dcf") == 0;
+      if (S_ISDIR(cst.st_mode) || (S_ISREG(cst.st_mode) && capture)) { collect(child, files); }
+    }
+    return true;
+  }
+  std::string dir = path.substr(0, path.find_last_of('/') == std::string::npos ? 0 : path.find_last_of('/'));
+  std::string site = dir.substr(dir.find_last_of('/') == std::string::npos ? 0 : dir.find_last_of('/') + 1);
+  files.push_back(File{path, site.empty() ? "." : site, static_cast<size_t>(st.st_size)});
+  return true;
+}
+
+void printHours(const Stats &s, uint8_t first) {
+  printf("  hour       ");
+  for (uint8_t h = first; h < first + HOURS_PER_DAY / 2; ++h) { printf("  %5u", h); }
+  printf("\n  success %%  ");
+  for (uint8_t h = first; h < first + HOURS_PER_DAY / 2; ++h) {
+    double minutes = s.hourOnTimeMs[h] / static_cast<double>(MINUTE_MS);
+    if (minutes >= 1) {
+      printf("  %5.1f", 100.0 * s.hourValid[h] / minutes);
+    } else {
+      printf("      -");
+    }
+  }
+  printf("\n");
+}
+
+void printStats(const char *name, uint32_t files, const Stats &s) {
+  double minutes = s.onTimeMs / static_cast<double>(MINUTE_MS);
+  printf("%-24s files %5u  minutes %8.0f  complete %8u  valid %8u  success %5.1f %%", name, files, minutes,
+         s.complete, s.valid, minutes > 0 ? 100.0 * s.valid / minutes : 0.0);
+  if (s.bitsCompared) {
+    printf("  bit errors %.2e\n", static_cast<double>(s.bitErrors) / s.bitsCompared);
+  } else {
+    printf("  bit errors       -\n");
+  }
+  printf("  off-time %.1f h, %u complete sequences without a valid one in %u min, %u bytes skipped, %u edges dropped\n",
+         s.offTimeMs / static_cast<double>(HOUR_MS), s.unanchored, ANCHOR_RANGE_MS / MINUTE_MS, s.skippedBytes,
+         s.droppedEdges);
+  printf("  success by hour of the DCF77 time, %.0f minutes without a valid sequence in the chunk:\n",
+         s.hourOnTimeMs[HOUR_UNKNOWN] / static_cast<double>(MINUTE_MS));
+  printHours(s, 0);
+  printHours(s, HOURS_PER_DAY / 2);
+  uint64_t pulses = 0;
+  uint32_t most = 0;
+  for (uint32_t count : s.pulses) {
+    pulses += count;
+    most = std::max(most, count);
+  }
+  printf("  pulse widths, %llu pulses:\n", static_cast<unsigned long long>(pulses));
+  for (uint8_t i = 0; i < PULSE_BINS; ++i) {
+    if (!s.pulses[i]) { continue; }
+    char range[16];
+    if (i < PULSE_BINS - 1) {
+      snprintf(range, sizeof(range), "%3u-%3u ms", i * PULSE_BIN_MS, (i + 1) * PULSE_BIN_MS - 1);
+    } else {
+      snprintf(range, sizeof(range), "  >=%3u ms", i * PULSE_BIN_MS);
+    }
+    printf("    %s  %6.2f %%  %s\n", range, 100.0 * s.pulses[i] / pulses,
+           std::string((s.pulses[i] * 40ULL + most - 1) / most, '#').c_str());
+  }
+}
+
+double seconds(const timespec &t) { return t.tv_sec + t.tv_nsec / 1e9; }
+}   // namespace
+
+int main(int argc, char *argv[]) {
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned chunkKb = DEFAULT_CHUNK_KB;
+  int first = 1;
+  for (; first < argc && strncmp(argv[first], "--", 2) == 0; ++first) {
+    if (strcmp(argv[first], "--jobs") == 0 && first + 1 < argc && sscanf(argv[first + 1], "%ld", &jobs) == 1 &&
+        jobs > 0) {
+      ++first;
+    } else if (strcmp(argv[first], "--chunk") == 0 && first + 1 < argc &&
+               sscanf(argv[first + 1], "%u", &chunkKb) == 1 && chunkKb > 0) {
+      ++first;
+    } else if (strcmp(argv[first], "--deglitch") == 0 && first + 1 < argc &&
+               sscanf(argv[first + 1], "%d,%d", &minPulse, &minGap) == 2) {
+      ++first;
+    } else if (strcmp(argv[first], "--fixed") == 0) {
+      adaptive = false;
+    } else {
+      first = argc;
+    }
+  }
+  if (first >= argc) {
+    fprintf(stderr, "Usage: %s [--jobs n] [--chunk kB] [--deglitch pulse,gap] [--fixed] path ...\n", argv[0]);
+    return 2;
+  }
+  if (jobs < 1) { jobs = 1; }
+
+  timespec startTime;
+  clock_gettime(CLOCK_MONOTONIC, &startTime);
+  int errors = 0;
+  std::vector<File> files;
+  for (int i = first; i < argc; ++i) {
+    if (!collect(argv[i], files)) {
+      fprintf(stderr, "%s: not found\n", argv[i]);
+      ++errors;
+    }
+  }
+  std::vector<Chunk> chunks;
+  uint64_t bytes = 0;
+  size_t chunkBytes = static_cast<size_t>(chunkKb) * 1024;
+  for (uint32_t f = 0; f < files.size(); ++f) {
+    bytes += files[f].size;
+    size_t nominal = 0;
+    do {
+      chunks.push_back(Chunk{f, nominal, nominal + chunkBytes});
+      nominal += chunkBytes;
+    } while (nominal < files[f].size);
+  }
+
+  std::map<std::string, Site> sites;
+  for (const File &file : files) { ++sites[file.site].files; }
+  std::vector<bool> failed(files.size(), false);
+  std::map<pid_t, std::pair<int, uint32_t>> running;   // Pipe and chunk of the child processes
+  size_t next = 0;
+  fflush(stdout);
+  while (next < chunks.size() || !running.empty()) {
+    if (next < chunks.size() && running.size() < static_cast<size_t>(jobs)) {
+      int fd[2];
+      if (pipe(fd) != 0) {
+        perror("pipe");
+        return 1;
+      }
+      pid_t pid = fork();
+      if (pid == 0) {
+        close(fd[0]);
+        Stats s;
+        const Chunk &chunk = chunks[next];
+        bool ok = analyzeFileChunk(files[chunk.file], chunk, s) && write(fd[1], &s, sizeof(s)) == sizeof(s);
+        _exit(ok ? 0 : 1);
+      }
+      close(fd[1]);
+      if (pid < 0) {
+        perror("fork");
+        close(fd[0]);
+        return 1;
+      }
+      running[pid] = std::make_pair(fd[0], static_cast<uint32_t>(next++));
+      continue;
+    }
+    int status;
+    pid_t pid = waitpid(-1, &status, 0);
+    auto child = running.find(pid);
+    if (child == running.end()) { continue; }
+    const Chunk &chunk = chunks[child->second.second];
+    Stats s;
+    bool ok = read(child->second.first, &s, sizeof(s)) == sizeof(s) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    close(child->second.first);
+    running.erase(child);
+    if (ok) {
+      add(sites[files[chunk.file].site].stats, s);
+    } else if (!failed[chunk.file]) {
+      failed[chunk.file] = true;
+      fprintf(stderr, "%s: cannot read\n", files[chunk.file].path.c_str());
+      ++errors;
+    }
+  }
+
+  Site total{};
+  for (const auto &site : sites) {
+    printStats(site.first.c_str(), site.second.files, site.second.stats);
+    add(total.stats, site.second.stats);
+    total.files += site.second.files;
+  }
+  if (sites.size() > 1) { printStats("total", total.files, total.stats); }
+
+  timespec endTime;
+  clock_gettime(CLOCK_MONOTONIC, &endTime);
+  double wall = seconds(endTime) - seconds(startTime);
+  double minutes = total.stats.onTimeMs / static_cast<double>(MINUTE_MS);
+  fprintf(stderr, "%u files, %.1f MB in %zu chunks, %ld jobs: %.0f minutes of signal in %.2f s = %.0f minutes/s\n",
+          total.files, bytes / 1e6, chunks.size(), jobs, minutes, wall, wall > 0 ? minutes / wall : 0.0);
+  return errors ? 1 : 0;
+}
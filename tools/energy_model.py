@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""Energy model of the DCF77 clock: average current, charge per day and battery life.
+
+Reads the timeline of the simulator (tools/simulator, --timeline) and applies
+a current model of the board:
+- states with a constant current: DCF77 receiver on, backlight on (scaled
+  with the PWM duty cycle), display off (saves the display current)
+- residency of the MCU from the STATS lines: awake (at 1 MHz and with the
+  boosted clock of lib/cpuclock) and idle above power down
+- charge per event: wake-ups, I2C transfers and bytes, SPI and serial bytes
+
+The default model starts from the values measured at 3 V (README):
+2.3 mA with receiver and RTC, 1.5 mA with RTC and display only, 4-5 mA for
+the backlight at the programmed brightness (BL_BRIGHTNESS_ON = 16). The
+other values are datasheet estimates (ATtiny88 at 1 MHz, 4.7 kOhm I2C
+pull-ups at 100 kHz, DOGM display). They can be replaced per board with a
+JSON file (--model) or single values (--set key=value).
+
+The device trace (lib/trace) has no residency of the sleep modes, so the
+model needs a simulator timeline. Several timelines (builds, configurations)
+are compared side by side.
+
+Battery life: the usable charge of the cell (--cell, --usable) divided by
+the net charge per day, after the charge of the solar cell (--solar, e.g.
+2.5@9-15 = 2.5 mA from 09:00 to 15:00, times --efficiency).
+
+Usage:
+    energy_model.py timeline.txt [timeline2.txt ...] [--model board.json] [--set key=value ...]
+                    [--cell 1000] [--usable 0.8] [--solar mA@h-h ...] [--efficiency 0.7] [--show-model]
+"""
+
+import argparse
+import json
+import os
+import sys
+
+SECONDS_PER_DAY = 86400.0
+
+# Current model of the board (mA, charges in uC)
+DEFAULT_MODEL = {
+    "base_ma": 1.5,             # RTC and display, MCU in power down (README: 1.5 mA)
+    "receiver_ma": 0.8,         # DCF77 receiver on (README: 2.3 mA - 1.5 mA)
+    "backlight_ma": 4.5,        # Backlight at backlight_duty (README: 4-5 mA)
+    "backlight_duty": 16,       # PWM duty cycle of the measurement (BL_BRIGHTNESS_ON)
+    "display_ma": 0.25,         # Part of base_ma saved while the display is off (estimate)
+    "mcu_awake_ma": 0.5,        # MCU awake at 1 MHz above power down (estimate)
+    "mcu_boost_ma": 2.8,        # MCU awake at 8 MHz (boost) above power down (datasheet: 1.4 mA at 4 MHz, 3 V)
+    "mcu_idle_ma": 0.15,        # MCU in idle mode above power down (estimate)
+    "wakeup_idle_uc": 0.02,     # Interrupt of a wake-up from idle, about 40 cycles (estimate)
+    "wakeup_pwrdown_uc": 0.05,  # Oscillator start-up and interrupt after power down (estimate)
+    "i2c_transfer_uc": 0.07,    # Start, address and stop through the pull-ups (estimate)
+    "i2c_byte_uc": 0.06,        # 9 bits through the pull-ups (estimate)
+    "spi_byte_uc": 0.001,       # Display controller (estimate)
+    "serial_byte_uc": 0.0,      # TX idles high
+    "supply_v": 3.0,            # Supply voltage of the measurements (energy per second)
+}
+
+# Rows of the table: (key of the result, label)
+ROWS = (
+    ("base", "base (RTC, display)"),
+    ("display_off", "display off"),
+    ("receiver", "receiver"),
+    ("backlight", "backlight"),
+    ("mcu_awake", "MCU awake"),
+    ("mcu_boost", "MCU boosted clock"),
+    ("mcu_idle", "MCU idle"),
+    ("wakeups", "wake-ups"),
+    ("i2c", "I2C"),
+    ("spi", "SPI"),
+    ("serial", "serial"),
+)
+
+
+class Timeline:
+    """States and STATS sums of a simulator timeline."""
+
+    def __init__(self):
+        self.duration = 0.0          # s
+        self.receiver_on = 0.0       # s
+        self.backlight = 0.0         # s * duty
+        self.display_off = 0.0       # s
+        self.stats = {}              # Sums of the STATS values
+
+    @classmethod
+    def parse(cls, lines):
+        timeline = cls()
+        receiver_since = None
+        backlight_since = None
+        backlight_duty = 0
+        display_off_since = None
+        end = 0.0
+        for line in lines:
+            fields = line.split(None, 4)
+            if len(fields) < 4:
+                continue
+            try:
+                time = float(fields[0])
+            except ValueError:
+                continue
+            event = fields[3]
+            details = fields[4].split() if len(fields) > 4 else []
+            end = max(end, time)
+            if event == "RECEIVER_ON" and receiver_since is None:
+                receiver_since = time
+            elif event == "RECEIVER_OFF" and receiver_since is not None:
+                timeline.receiver_on += time - receiver_since
+                receiver_since = None
+            elif event == "BACKLIGHT_ON":
+                if backlight_since is not None:
+                    timeline.backlight += (time - backlight_since) * backlight_duty
+                backlight_since = time
+                backlight_duty = int(details[1]) if len(details) > 1 and details[0] == "duty" else 0
+            elif event == "BACKLIGHT_OFF" and backlight_since is not None:
+                timeline.backlight += (time - backlight_since) * backlight_duty
+                backlight_since = None
+            elif event == "DISPLAY_OFF" and display_off_since is None:
+                display_off_since = time
+            elif event == "DISPLAY_ON" and display_off_since is not None:
+                timeline.display_off += time - display_off_since
+                display_off_since = None
+            elif event == "STATS":
+                for name, value in zip(details[::2], details[1::2]):
+                    timeline.stats[name] = timeline.stats.get(name, 0) + int(value)
+        if receiver_since is not None:
+            timeline.receiver_on += end - receiver_since
+        if backlight_since is not None:
+            timeline.backlight += (end - backlight_since) * backlight_duty
+        if display_off_since is not None:
+            timeline.display_off += end - display_off_since
+        timeline.duration = end
+        return timeline
+
+
+def average_currents(timeline, model):
+    """Mean current (mA) of every row over the timeline."""
+    if timeline.duration <= 0:
+        raise ValueError("empty timeline")
+    if "awake_us" not in timeline.stats:
+        raise ValueError("no STATS lines (simulator --stats)")
+    duration = timeline.duration
+    stats = timeline.stats
+
+    def charge_uc(*pairs):
+        return sum(stats.get(name, 0) * model[key] for name, key in pairs)
+
+    return {
+        "base": model["base_ma"],
+        "display_off": -model["display_ma"] * timeline.display_off / duration,
+        "receiver": model["receiver_ma"] * timeline.receiver_on / duration,
+        "backlight": model["backlight_ma"] * timeline.backlight / model["backlight_duty"] / duration,
+        "mcu_awake": model["mcu_awake_ma"] * (stats["awake_us"] - stats.get("boost_us", 0)) / 1e6 / duration,
+        "mcu_boost": model["mcu_boost_ma"] * stats.get("boost_us", 0) / 1e6 / duration,
+        "mcu_idle": model["mcu_idle_ma"] * stats.get("idle_us", 0) / 1e6 / duration,
+        "wakeups": charge_uc(("wakeups_idle", "wakeup_idle_uc"), ("wakeups_pwrdown", "wakeup_pwrdown_uc")) / 1e3 / duration,
+        "i2c": charge_uc(("i2c_transfers", "i2c_transfer_uc"), ("i2c_bytes", "i2c_byte_uc")) / 1e3 / duration,
+        "spi": charge_uc(("spi_bytes", "spi_byte_uc")) / 1e3 / duration,
+        "serial": charge_uc(("serial_bytes", "serial_byte_uc")) / 1e3 / duration,
+    }
+
+
+def parse_solar(items):
+    """mA@h-h -> list of (mA, start hour, end hour)."""
+    periods = []
+    for item in items:
+        current, _, hours = item.partition("@")
+        start, _, end = hours.partition("-")
+        if not current or not start or not end:
+            raise ValueError("solar period must be mA@h-h: %s" % item)
+        periods.append((float(current), float(start), float(end)))
+    return periods
+
+
+def solar_mah_per_day(periods, efficiency):
+    return sum(current * ((end - start) % 24) for current, start, end in periods) * efficiency
+
+
+def load_model(path, settings):
+    model = dict(DEFAULT_MODEL)
+    if path:
+        with open(path) as file:
+            model.update(json.load(file))
+    for item in settings:
+        key, _, value = item.partition("=")
+        if key not in DEFAULT_MODEL or not value:
+            raise ValueError("unknown model value: %s" % item)
+        model[key] = float(value)
+    return model
+
+
+def report(names, timelines, model, cell, usable, solar, out=sys.stdout):
+    results = [average_currents(timeline, model) for timeline in timelines]
+    totals = [sum(result.values()) for result in results]
+    row = "%-24s" + " %14s" * len(names) + "\n"
+    out.write(row % (("",) + tuple(os.path.basename(name)[-14:] for name in names)))
+    out.write(row % (("simulated days",) + tuple("%.2f" % (t.duration / SECONDS_PER_DAY) for t in timelines)))
+    out.write(row % (("mean current (mA)",) + ("",) * len(names)))
+    for key, label in ROWS:
+        out.write(row % (("  " + label,) + tuple("%.4f" % result[key] for result in results)))
+    out.write(row % (("  total",) + tuple("%.4f" % total for total in totals)))
+    out.write(row % (("energy per second (uJ)",) + tuple("%.1f" % (total * model["supply_v"] * 1e3) for total in totals)))
+    per_day = [total * 24 for total in totals]
+    out.write(row % (("consumption (mAh/day)",) + tuple("%.2f" % value for value in per_day)))
+    out.write(row % (("solar (mAh/day)",) + ("%.2f" % solar,) * len(names)))
+    charge = cell * usable
+    out.write(row % (("autonomy without sun (d)",) + tuple("%.1f" % (charge / value) for value in per_day)))
+    life = []
+    for value in per_day:
+        net = value - solar
+        life.append("neutral" if net <= 0 else "%.1f" % (charge / net))
+    out.write(row % (("battery life (d)",) + tuple(life)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("timelines", nargs="+", help="simulator timeline (--timeline)")
+    parser.add_argument("--model", help="JSON file with the current model of the board")
+    parser.add_argument("--set", nargs="*", default=[], metavar="KEY=VALUE", help="single model values")
+    parser.add_argument("--cell", type=float, default=1000, help="capacity of the cell (mAh)")
+    parser.add_argument("--usable", type=float, default=0.8, help="usable part of the capacity")
+    parser.add_argument("--solar", nargs="*", default=[], metavar="MA@H-H", help="charge current of the solar cell")
+    parser.add_argument("--efficiency", type=float, default=0.7, help="charge efficiency of the cell")
+    parser.add_argument("--show-model", action="store_true", help="print the model values")
+    args = parser.parse_args()
+    try:
+        model = load_model(args.model, args.set)
+        solar = solar_mah_per_day(parse_solar(args.solar), args.efficiency)
+        timelines = []
+        for name in args.timelines:
+            with open(name) as file:
+                timelines.append(Timeline.parse(file))
+        if args.show_model:
+            for key in DEFAULT_MODEL:
+                print("%-20s %g" % (key, model[key]))
+        report(args.timelines, timelines, model, args.cell, args.usable, solar)
+    except (OSError, ValueError) as error:
+        sys.stderr.write("%s\n" % error)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
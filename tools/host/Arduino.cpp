@@ -0,0 +1,601 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file Arduino.cpp
+/// @author Kai R.
+/// @brief Minimal Arduino API for the host tools.
+///
+/// @date 2022-12-17
+/// @version 1.0
+///
+/// @date 2023-01-07
+/// Registers, pending interrupts, sleep and the machine interface.
+///
+/// @date 2023-01-21
+/// Timer1 with an external clock at T1.
+///
+/// @date 2023-02-04
+/// ADC: bandgap measurement with the supply voltage of the machine.
+///
+/// @date 2023-02-11
+/// Timer1 compare match B.
+///
+/// @date 2023-02-11
+/// Timer0 compare match A.
+///
+/// @date 2023-02-25
+/// millis(), micros() and delay() stop the host without the Timer0 overflow interrupt.
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <avr/sleep.h>
+#include <algorithm>
+
+namespace {
+constexpr uint32_t OSCILLATOR_HZ{8000000};   // Internal RC oscillator, divided by CLKPR
+constexpr uint32_t MICROS_CYCLES{40};        // Duration of millis()/micros() in clock cycles
+constexpr uint8_t CLKPS_MASK{0x0F};
+constexpr uint8_t BITS_PER_SERIAL_BYTE{10};
+constexpr uint8_t CS_MASK{0x07};
+constexpr uint8_t CS_EXT_FALLING{6};   // CS1 = 6, 7: external clock at T1
+constexpr uint8_t MUX_MASK{0x0F};
+constexpr uint8_t MUX_BANDGAP{0x0E};
+constexpr double BANDGAP_VOLTS{1.1};
+constexpr uint8_t ADPS_MASK{0x07};
+constexpr uint8_t ADC_CYCLES{13};      // ADC clock cycles of a conversion
+constexpr uint16_t ADC_MAX{1023};
+constexpr uint64_t T0_TICK_MICROS{8};   // Prescaler 8 at 1 MHz, lib/cpuclock keeps the tick
+constexpr uint32_t T0_PERIOD{0x100};
+
+uint64_t now{0};           // Virtual time in microseconds
+uint64_t timerStopped{0};  // Time in power down mode, Timer0 (millis(), micros()) does not count
+bool powerDown{false};
+bool sleeping{false};
+Host::Machine *machine{nullptr};
+volatile uint16_t pending{0};   // Interrupt flags (Host::IRQ_...)
+
+struct {
+  void (*isr)(void);
+  int mode;
+} interrupt[2];
+
+// Timer1 with an external clock. The ticks of the clock are calculated from the
+// timer time (Host::getTimerMicros()): the external clock is synchronized with
+// the I/O clock and is not counted in power down mode.
+struct {
+  double hz{0};              // Frequency at T1 (Host::setT1Clock())
+  uint64_t clockTime{0};     // Timer time of the last change of the frequency
+  uint64_t clockTicks{0};    // Ticks up to clockTime
+  uint64_t origin{0};        // Tick at which the counter was 0
+  uint32_t top{0xFFFF};
+  uint64_t overflows{0};     // Overflows since origin
+  uint64_t synced{0};        // Tick of the last t1Sync() (compare match B after it)
+  uint16_t count{0};         // Counter value while the timer does not count the external clock
+  uint8_t flags{0};          // TIFR1
+} timer1;
+
+// Timer0: the ticks are derived from the timer time. Only the compare match A is simulated.
+struct {
+  uint64_t synced{0};   // Tick of the last t0Sync()
+  uint8_t flags{0};     // TIFR0
+} timer0;
+
+uint64_t t0Ticks() { return Host::getTimerMicros() / T0_TICK_MICROS; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief First tick after the given one at which the counter reaches OCR0A.
+///
+/// @param after
+/// @return uint64_t
+//////////////////////////////////////////////////////////////////////////////
+uint64_t t0NextCompare(uint64_t after) {
+  uint64_t match = after - after % T0_PERIOD + OCR0A;
+  if (match <= after) { match += T0_PERIOD; }
+  return match;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Brings Timer0 up to the current time. Sets OCF0A at a compare
+///        match A and the interrupt flag if the interrupt is enabled.
+///
+//////////////////////////////////////////////////////////////////////////////
+void t0Sync() {
+  uint64_t ticks = t0Ticks();
+  if (ticks > timer0.synced && t0NextCompare(timer0.synced) <= ticks) { timer0.flags |= _BV(OCF0A); }
+  timer0.synced = ticks;
+  if ((timer0.flags & _BV(OCF0A)) && (TIMSK0 & _BV(OCIE0A))) { pending |= Host::IRQ_TIMER0_COMPA; }
+}
+
+uint64_t t1Ticks(uint64_t timerTime) {
+  if (timer1.hz <= 0) { return timer1.clockTicks; }
+  return timer1.clockTicks + static_cast<uint64_t>((timerTime - timer1.clockTime) * timer1.hz / 1e6);
+}
+
+bool t1External() { return (TCCR1B & CS_MASK) >= CS_EXT_FALLING; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief TOP of the waveform generation mode: 8, 9 or 10 bit PWM, else 16 bit
+///        (modes with OCR1A/ICR1 as TOP are not simulated).
+///
+//////////////////////////////////////////////////////////////////////////////
+uint32_t t1Top() {
+  uint8_t wgm = (TCCR1A & (_BV(WGM11) | _BV(WGM10))) | ((TCCR1B & (_BV(WGM13) | _BV(WGM12))) >> 1);
+  switch (wgm) {
+    case 1:
+    case 5: return 0xFF;
+    case 2:
+    case 6: return 0x1FF;
+    case 3:
+    case 7: return 0x3FF;
+    default: return 0xFFFF;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief First tick after the given one at which the counter reaches OCR1B.
+///
+/// @param after        Tick (not before origin)
+/// @return uint64_t    UINT64_MAX if OCR1B is above TOP
+//////////////////////////////////////////////////////////////////////////////
+uint64_t t1NextCompare(uint64_t after) {
+  if (OCR1B > timer1.top) { return UINT64_MAX; }
+  uint64_t period = timer1.top + 1;
+  uint64_t relative = after - timer1.origin;
+  uint64_t match = relative - relative % period + OCR1B;
+  if (match <= relative) { match += period; }
+  return timer1.origin + match;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Brings the counter up to the current time. Sets TOV1 at an overflow,
+///        OCF1B at a compare match B and the interrupt flags if the
+///        interrupts are enabled.
+///
+//////////////////////////////////////////////////////////////////////////////
+void t1Sync() {
+  uint64_t ticks = t1Ticks(Host::getTimerMicros());
+  if (!t1External()) {
+    timer1.origin = ticks - timer1.count;
+    timer1.synced = ticks;
+    return;
+  }
+  uint32_t top = t1Top();
+  if (top != timer1.top) {   // Mode changed: the counter continues with the new TOP
+    timer1.top = top;
+    timer1.origin = ticks - timer1.count % (top + 1);
+    timer1.overflows = 0;
+    timer1.synced = ticks;
+  }
+  uint64_t overflows = (ticks - timer1.origin) / (top + 1);
+  if (overflows > timer1.overflows) {
+    timer1.overflows = overflows;
+    timer1.flags |= _BV(TOV1);
+  }
+  if (ticks > timer1.synced && t1NextCompare(timer1.synced) <= ticks) { timer1.flags |= _BV(OCF1B); }
+  timer1.synced = ticks;
+  timer1.count = (ticks - timer1.origin) % (top + 1);
+  if ((timer1.flags & _BV(TOV1)) && (TIMSK1 & _BV(TOIE1))) { pending |= Host::IRQ_TIMER1_OVF; }
+  if ((timer1.flags & _BV(OCF1B)) && (TIMSK1 & _BV(OCIE1B))) { pending |= Host::IRQ_TIMER1_COMPB; }
+}
+
+constexpr uint8_t interruptPin[2]{PIND2, PIND3};
+
+volatile uint8_t *const pinRegister[]{&PIND, &PINB, &PINC, &PINA};
+volatile uint8_t *const pcmsk[]{&PCMSK2, &PCMSK0, &PCMSK1, &PCMSK3};
+constexpr uint8_t pcintOfPort[]{2, 0, 1, 3};
+
+uint32_t cycles(uint32_t n) { return (n * 1000000ULL + Host::cpuHz() - 1) / Host::cpuHz(); }
+
+void dispatch(uint16_t irq) {
+  void (*vector)(void) = nullptr;
+  switch (irq) {
+    case Host::IRQ_INT0: vector = interrupt[0].isr; break;
+    case Host::IRQ_INT1: vector = interrupt[1].isr; break;
+    case Host::IRQ_PCINT0: vector = PCINT0_vect; break;
+    case Host::IRQ_PCINT1: vector = PCINT1_vect; break;
+    case Host::IRQ_PCINT2: vector = PCINT2_vect; break;
+    case Host::IRQ_PCINT3: vector = PCINT3_vect; break;
+    case Host::IRQ_WDT: vector = WDT_vect; break;
+    case Host::IRQ_TIMER1_COMPB:
+      timer1.flags &= ~_BV(OCF1B);
+      vector = TIMER1_COMPB_vect;
+      break;
+    case Host::IRQ_TIMER1_OVF:
+      timer1.flags &= ~_BV(TOV1);   // Cleared by the execution of the interrupt
+      vector = TIMER1_OVF_vect;
+      break;
+    case Host::IRQ_TIMER0_COMPA:
+      timer0.flags &= ~_BV(OCF0A);
+      vector = TIMER0_COMPA_vect;
+      break;
+  }
+  if (vector) { vector(); }
+}
+}   // namespace
+
+// Registers with their values after reset and init() of the core
+Host::StatusReg SREG{_BV(SREG_I)};   // init() enables the interrupts before setup()
+volatile uint8_t SMCR;
+volatile uint8_t MCUCR;
+volatile uint8_t MCUSR;
+volatile uint8_t WDTCSR;
+volatile uint8_t CLKPR{_BV(CLKPS1) | _BV(CLKPS0)};   // Fuse CKDIV8: 1 MHz
+volatile uint8_t PRR;
+volatile uint8_t DIDR0;
+volatile uint8_t DIDR1;
+volatile uint8_t ACSR;
+volatile uint8_t TCCR0A{_BV(CS01)};   // Prescaler 8 (millis() at 1 MHz)
+Host::Timer0Count TCNT0;
+volatile uint8_t OCR0A;
+Host::Timer0Flags TIFR0;
+volatile uint8_t TCCR1A;
+volatile uint8_t TCCR1B{_BV(CS11)};
+Host::Timer1Count TCNT1;
+volatile uint16_t OCR1B;
+Host::Timer1Flags TIFR1;
+volatile uint8_t TIMSK0{_BV(TOIE0)};   // millis()
+volatile uint8_t TIMSK1;
+volatile uint8_t ADMUX;
+Host::AdcControl ADCSRA;
+volatile uint16_t ADC;
+volatile uint8_t TWBR;
+volatile uint8_t SPCR;
+volatile uint8_t SPSR;
+volatile uint8_t EICRA;
+volatile uint8_t EIMSK;
+volatile uint8_t PCICR;
+volatile uint8_t PCMSK0;
+volatile uint8_t PCMSK1;
+volatile uint8_t PCMSK2;
+volatile uint8_t PCMSK3;
+volatile uint8_t PINA;
+volatile uint8_t PINB;
+volatile uint8_t PINC;
+volatile uint8_t PIND;
+volatile uint8_t DDRA;
+volatile uint8_t DDRB;
+volatile uint8_t DDRC;
+volatile uint8_t DDRD;
+volatile uint8_t PORTA;
+volatile uint8_t PORTB;
+volatile uint8_t PORTC;
+volatile uint8_t PORTD;
+
+HostSerial Serial;
+
+namespace {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The core timing counts the Timer0 overflows. Without the overflow
+///        interrupt (lib/timebase with RTC_TIMEBASE) it stands still on the
+///        MCU and delay() does not return, so the host stops.
+///
+/// @param name   Function of the core
+//////////////////////////////////////////////////////////////////////////////
+void checkCoreTiming(const char *name) {
+  if (TIMSK0 & _BV(TOIE0)) { return; }
+  fprintf(stderr, "%s without the Timer0 overflow interrupt\n", name);
+  abort();
+}
+}   // namespace
+
+unsigned long millis() {
+  checkCoreTiming("millis()");
+  Host::busy(cycles(MICROS_CYCLES));
+  return static_cast<uint32_t>(Host::getTimerMicros() / 1000);
+}
+
+unsigned long micros() {
+  checkCoreTiming("micros()");
+  Host::busy(cycles(MICROS_CYCLES));
+  return static_cast<uint32_t>(Host::getTimerMicros());
+}
+
+void delay(unsigned long ms) {
+  checkCoreTiming("delay()");
+  Host::busy(ms * 1000);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief delayMicroseconds() counts clock cycles for F_CPU. It is too short
+///        with a higher clock (CpuClock::boost()).
+///
+/// @param us
+//////////////////////////////////////////////////////////////////////////////
+void delayMicroseconds(unsigned int us) {
+#ifdef F_CPU
+  Host::busy(cycles(static_cast<uint32_t>(static_cast<uint64_t>(us) * F_CPU / 1000000)));
+#else
+  Host::busy(us);
+#endif
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (mode == INPUT_PULLUP) { Host::setPin(pin, HIGH); }
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  Host::setPin(pin, level);
+  if (machine) { machine->pinWritten(pin, level ? HIGH : LOW); }
+}
+
+int digitalRead(uint8_t pin) { return Host::getPin(pin); }
+
+void analogWrite(uint8_t pin, int value) {
+  Host::setPin(pin, value > 0);
+  if (machine) { machine->analogWritten(pin, value); }
+}
+
+void attachInterrupt(uint8_t num, void (*isr)(void), int mode) {
+  if (num < 2) { interrupt[num] = {isr, mode}; }
+}
+
+void detachInterrupt(uint8_t num) {
+  if (num < 2) { interrupt[num].isr = nullptr; }
+}
+
+void HostSerial::begin(unsigned long baud) { _baud = baud; }
+
+size_t HostSerial::write(uint8_t data) {
+  Host::busy(BITS_PER_SERIAL_BYTE * 1000000UL / _baud);
+  if (machine) { machine->serialWrite(data); }
+  return 1;
+}
+
+namespace Host {
+StatusReg &StatusReg::operator=(uint8_t value) {
+  _value = value;
+  service();
+  return *this;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Reading the counter takes time like micros(), so polling loops
+///        with the Timer1 time (lib/timebase) advance the virtual time.
+///
+//////////////////////////////////////////////////////////////////////////////
+Timer1Count::operator uint16_t() const {
+  busy(cycles(MICROS_CYCLES));
+  t1Sync();
+  return timer1.count;
+}
+
+Timer1Count &Timer1Count::operator=(uint16_t value) {
+  t1Sync();
+  timer1.count = value % (timer1.top + 1);
+  timer1.origin = t1Ticks(getTimerMicros()) - timer1.count;
+  timer1.overflows = 0;
+  timer1.synced = timer1.origin + timer1.count;
+  return *this;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Setting ADSC with the ADC enabled converts the input: the bandgap
+///        with the reference AVCC, every other input gives 0.
+///
+//////////////////////////////////////////////////////////////////////////////
+AdcControl &AdcControl::operator=(uint8_t value) {
+  _value = value & ~_BV(ADSC);
+  if (!(value & _BV(ADSC)) || !(value & _BV(ADEN)) || (PRR & _BV(PRADC))) { return *this; }
+  uint8_t prescaler = value & ADPS_MASK;
+  busy(cycles(ADC_CYCLES << (prescaler ? prescaler : 1)));
+  uint16_t result = 0;
+  if ((ADMUX & MUX_MASK) == MUX_BANDGAP && (ADMUX & _BV(REFS0))) {
+    double vcc = Machine::DEFAULT_VCC;
+    if (machine) { vcc = machine->vcc(); }
+    result = static_cast<uint16_t>(constrain(BANDGAP_VOLTS * 1024 / vcc + 0.5, 0, ADC_MAX));
+  }
+  ADC = result;
+  return *this;
+}
+
+Timer1Flags::operator uint8_t() const {
+  t1Sync();
+  return timer1.flags;
+}
+
+Timer1Flags &Timer1Flags::operator=(uint8_t value) {
+  t1Sync();
+  timer1.flags &= ~value;
+  if (!(timer1.flags & _BV(TOV1))) { pending &= ~IRQ_TIMER1_OVF; }
+  if (!(timer1.flags & _BV(OCF1B))) { pending &= ~IRQ_TIMER1_COMPB; }
+  return *this;
+}
+
+Timer0Count::operator uint8_t() const {
+  t0Sync();
+  return timer0.synced % T0_PERIOD;
+}
+
+Timer0Flags::operator uint8_t() const {
+  t0Sync();
+  return timer0.flags;
+}
+
+Timer0Flags &Timer0Flags::operator=(uint8_t value) {
+  t0Sync();
+  timer0.flags &= ~value;
+  if (!(timer0.flags & _BV(OCF0A))) { pending &= ~IRQ_TIMER0_COMPA; }
+  return *this;
+}
+
+void setMachine(Machine *m) { machine = m; }
+
+Machine *getMachine() { return machine; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the virtual time. millis() and micros() are derived from it,
+///        except for the time in power down mode (Timer0 stopped).
+///
+/// @param micros
+//////////////////////////////////////////////////////////////////////////////
+void setMicros(uint64_t micros) {
+  if (powerDown && micros > now) { timerStopped += micros - now; }
+  now = micros;
+  t0Sync();
+  t1Sync();
+}
+
+uint64_t getMicros() { return now; }
+
+uint64_t getTimerMicros() { return now - timerStopped; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief In power down mode Timer0 stops and the edge interrupts INT0/INT1
+///        are lost (they need the I/O clock). Pin change interrupts and the
+///        watchdog wake the MCU.
+///
+/// @param on
+//////////////////////////////////////////////////////////////////////////////
+void setPowerDown(bool on) { powerDown = on; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the frequency of the external clock at T1 (e.g. the 32kHz
+///        output of the RTC). 0 = no clock.
+///
+/// @param hz
+//////////////////////////////////////////////////////////////////////////////
+void setT1Clock(double hz) {
+  t1Sync();
+  timer1.clockTicks = t1Ticks(getTimerMicros());
+  timer1.clockTime = getTimerMicros();
+  timer1.hz = hz;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Virtual time of the next Timer1 interrupt (overflow or compare
+///        match B), if the MCU does not power down before.
+///
+/// @return uint64_t   UINT64_MAX if there is none
+//////////////////////////////////////////////////////////////////////////////
+uint64_t nextTimer1Interrupt() {
+  t1Sync();
+  if (!t1External() || timer1.hz <= 0) { return UINT64_MAX; }
+  uint64_t tick = UINT64_MAX;
+  if (TIMSK1 & _BV(TOIE1)) { tick = timer1.origin + (timer1.overflows + 1) * (timer1.top + 1); }
+  if (TIMSK1 & _BV(OCIE1B)) { tick = std::min(tick, t1NextCompare(timer1.synced)); }
+  if (tick == UINT64_MAX) { return UINT64_MAX; }
+  uint64_t timerTime = timer1.clockTime + static_cast<uint64_t>((tick - timer1.clockTicks) * 1e6 / timer1.hz);
+  while (t1Ticks(timerTime) < tick) { ++timerTime; }
+  return now + (timerTime - getTimerMicros());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Virtual time of the next Timer0 compare match A interrupt, if the
+///        MCU does not power down before.
+///
+/// @return uint64_t   UINT64_MAX if there is none
+//////////////////////////////////////////////////////////////////////////////
+uint64_t nextTimer0Interrupt() {
+  if (!(TIMSK0 & _BV(OCIE0A))) { return UINT64_MAX; }
+  t0Sync();
+  return now + t0NextCompare(timer0.synced) * T0_TICK_MICROS - getTimerMicros();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The MCU is busy for the given time. The machine runs its events
+///        up to the new time, then the pending interrupts are executed.
+///
+/// @param micros
+//////////////////////////////////////////////////////////////////////////////
+void busy(uint32_t micros) {
+  if (!machine) { return; }
+  machine->advance(now + micros);
+  service();
+}
+
+uint32_t cpuHz() { return OSCILLATOR_HZ >> (CLKPR & CLKPS_MASK); }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the level of a pin. If the level changes, the flags of the
+///        interrupts that are enabled for the pin are set and pending
+///        interrupts are executed (if SREG allows it).
+///
+/// @param pin
+/// @param level
+//////////////////////////////////////////////////////////////////////////////
+void setPin(uint8_t pin, uint8_t level) {
+  if (pin >= NUM_PINS) { return; }
+  uint8_t port = pinPort(pin);
+  uint8_t mask = 1 << pinBit(pin);
+  level = level ? HIGH : LOW;
+  if (static_cast<bool>(*pinRegister[port] & mask) == static_cast<bool>(level)) { return; }
+  *pinRegister[port] ^= mask;
+
+  for (uint8_t num = 0; num < 2; ++num) {
+    if (interruptPin[num] != pin || !interrupt[num].isr || powerDown) { continue; }
+    if (interrupt[num].mode == CHANGE || (interrupt[num].mode == RISING && level == HIGH) ||
+        (interrupt[num].mode == FALLING && level == LOW)) {
+      pending |= IRQ_INT0 << num;
+    }
+  }
+  uint8_t group = pcintOfPort[port];
+  if ((PCICR & _BV(group)) && (*pcmsk[port] & mask)) { pending |= IRQ_PCINT0 << group; }
+  service();
+}
+
+uint8_t getPin(uint8_t pin) { return (pin < NUM_PINS) ? (*pinRegister[pinPort(pin)] >> pinBit(pin)) & 1 : LOW; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets an interrupt flag (e.g. IRQ_WDT by the machine).
+///
+/// @param irq
+//////////////////////////////////////////////////////////////////////////////
+void raise(uint16_t irq) {
+  pending |= irq;
+  service();
+}
+
+uint16_t pendingInterrupts() { return pending; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Executes the pending interrupts in the order of their priority,
+///        if the interrupts are enabled. As on the MCU the I-bit is cleared
+///        during an interrupt function, so interrupts are not nested.
+///        sei() does not call this function: as on the MCU, sleep_cpu()
+///        directly after sei() wakes up by the pending interrupt.
+///
+//////////////////////////////////////////////////////////////////////////////
+void service() {
+  if (sleeping) { return; }   // Host::sleep() executes the interrupts after the wake-up
+  while ((SREG & _BV(SREG_I)) && pending) {
+    uint16_t irq = pending & -pending;
+    pending &= ~irq;
+    SREG &= ~_BV(SREG_I);
+    dispatch(irq);
+    SREG |= _BV(SREG_I);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief sleep_cpu(): The machine runs until an interrupt wakes the MCU.
+///        A pending interrupt wakes it immediately.
+///
+/// @param mode   SLEEP_MODE_...
+//////////////////////////////////////////////////////////////////////////////
+void sleep(uint8_t mode) {
+  if (machine && !pending) {
+    sleeping = true;
+    powerDown = (mode == SLEEP_MODE_PWR_DOWN);
+    machine->sleep(mode);
+    powerDown = false;
+    sleeping = false;
+  }
+  service();
+}
+
+uint8_t pinPort(uint8_t pin) { return (pin < NUM_PINS) ? pin >> 3 : 0; }
+
+uint8_t pinBit(uint8_t pin) {
+  if (pin == 16) { return 7; }   // PC7
+  if (pin > 16 && pin < 24) { return pin - 17; }
+  return pin & 0x07;
+}
+
+uint8_t pcintGroup(uint8_t pin) { return pcintOfPort[pinPort(pin)]; }
+
+volatile uint8_t *portRegister(uint8_t port) { return pinRegister[port & 0x03]; }
+
+volatile uint8_t *pcmskRegister(uint8_t pin) { return pcmsk[pinPort(pin)]; }
+}   // namespace Host
@@ -0,0 +1,187 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file Arduino.h
+/// @author Kai R.
+/// @brief Minimal Arduino API for the host tools (tools/replay, tools/simulator).
+///        Allows compiling the clock (src/main.cpp, lib/...) unchanged on a
+///        PC. Time and pin levels are virtual and are set by the tool
+///        (namespace Host). Changing the level of a pin sets the flag of
+///        the interrupt (INT0/INT1, pin change) attached to it. Pending
+///        interrupts are executed as soon as they are enabled (I-bit in SREG).
+///
+///        Pin numbers are those of ATTinyCore for the ATtiny88:
+///        0-7 = PD0-PD7, 8-15 = PB0-PB7, 16 = PC7, 17-23 = PC0-PC6 (A0 = 17),
+///        24-27 = PA0-PA3.
+///
+///        Without a machine (Host::setMachine()) the time only changes with
+///        Host::setMicros(). With a machine (simulator) every call that takes
+///        time on the MCU (micros(), delay(), bus transfers, sleep) lets the
+///        machine run its events up to the new time.
+///
+/// @date 2022-12-17
+/// @version 1.0
+///
+/// @date 2023-01-07
+/// AVR registers, interrupts, sleep modes, Serial and the machine interface
+/// for the simulator.
+///
+/// @date 2023-01-14
+/// Program memory access (avr/pgmspace.h) as in the Arduino core.
+///
+/// @date 2023-01-21
+/// Timer1 with an external clock at T1 (overflow interrupt), set by the machine.
+///
+/// @date 2023-01-28
+/// constrain().
+///
+/// @date 2023-02-04
+/// Supply voltage of the machine (ADC). I2C transactions are passed to the machine.
+///
+/// @date 2023-02-11
+/// Timer1 compare match B interrupt. The interrupt flags are 16 bit.
+///
+/// @date 2023-02-11
+/// Timer0 compare match A interrupt.
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define bit(b) (1UL << (b))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+constexpr uint8_t SS{10};
+constexpr uint8_t MOSI{11};
+constexpr uint8_t MISO{12};
+constexpr uint8_t SCK{13};
+constexpr uint8_t A0{17};
+constexpr uint8_t A1{18};
+constexpr uint8_t A2{19};
+constexpr uint8_t A3{20};
+constexpr uint8_t A4{21};
+constexpr uint8_t A5{22};
+
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+
+#define digitalPinToPort(p) Host::pinPort(p)
+#define digitalPinToBitMask(p) static_cast<uint8_t>(1 << Host::pinBit(p))
+#define portInputRegister(port) Host::portRegister(port)
+#define digitalPinToPCICR(p) (&PCICR)
+#define digitalPinToPCICRbit(p) Host::pcintGroup(p)
+#define digitalPinToPCMSK(p) Host::pcmskRegister(p)
+#define digitalPinToPCMSKbit(p) Host::pinBit(p)
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int digitalRead(uint8_t);
+void analogWrite(uint8_t, int);
+void attachInterrupt(uint8_t, void (*)(void), int);
+void detachInterrupt(uint8_t);
+inline void noInterrupts(void) { cli(); }
+inline void interrupts(void) { sei(); }
+
+void setup(void);
+void loop(void);
+
+class HostSerial {
+public:
+  void begin(unsigned long);
+  size_t write(uint8_t);
+  void flush(void) {}
+  operator bool() const { return true; }
+
+private:
+  unsigned long _baud{9600};
+};
+
+extern HostSerial Serial;
+
+namespace Host {
+constexpr uint8_t NUM_PINS{28};
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The environment of the MCU (simulator). All functions are called
+///        by the host API.
+///
+//////////////////////////////////////////////////////////////////////////////
+class Machine {
+public:
+  static constexpr double DEFAULT_VCC{3.0};
+
+  virtual ~Machine() {}
+  virtual void advance(uint64_t until) = 0;   // Run the events up to the time (Host::setMicros())
+  virtual void sleep(uint8_t mode) = 0;       // Run the events until an interrupt wakes the MCU
+  virtual void pinWritten(uint8_t, uint8_t) {}
+  virtual void analogWritten(uint8_t, int) {}
+  virtual void spiTransfer(uint8_t) {}
+  virtual void i2cTransfer(uint8_t) {}   // Bytes after the address
+  virtual void serialWrite(uint8_t) {}
+  virtual double vcc(void) { return DEFAULT_VCC; }   // Supply voltage (V), measured by the ADC
+};
+
+// Interrupt flags in the order of their priority
+constexpr uint16_t IRQ_INT0{0x01};
+constexpr uint16_t IRQ_INT1{0x02};
+constexpr uint16_t IRQ_PCINT0{0x04};
+constexpr uint16_t IRQ_PCINT1{0x08};
+constexpr uint16_t IRQ_PCINT2{0x10};
+constexpr uint16_t IRQ_PCINT3{0x20};
+constexpr uint16_t IRQ_WDT{0x40};
+constexpr uint16_t IRQ_TIMER1_COMPB{0x80};
+constexpr uint16_t IRQ_TIMER1_OVF{0x100};
+constexpr uint16_t IRQ_TIMER0_COMPA{0x200};
+
+void setMachine(Machine *);
+Machine *getMachine(void);
+void setMicros(uint64_t);
+uint64_t getMicros(void);
+uint64_t getTimerMicros(void);
+void setPowerDown(bool);
+void setT1Clock(double);
+uint64_t nextTimer1Interrupt(void);
+uint64_t nextTimer0Interrupt(void);
+void busy(uint32_t);
+uint32_t cpuHz(void);
+void setPin(uint8_t, uint8_t);
+uint8_t getPin(uint8_t);
+void raise(uint16_t);
+uint16_t pendingInterrupts(void);
+void service(void);
+void sleep(uint8_t);
+
+uint8_t pinPort(uint8_t);
+uint8_t pinBit(uint8_t);
+uint8_t pcintGroup(uint8_t);
+volatile uint8_t *portRegister(uint8_t);
+volatile uint8_t *pcmskRegister(uint8_t);
+}   // namespace Host
+
+#endif
@@ -0,0 +1,38 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file SPI.cpp
+/// @author Kai R.
+/// @brief SPI for the host tools.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-02-25
+/// SPI2X halves the divider.
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SPI.h"
+
+namespace {
+constexpr uint8_t SPR_MASK{0x03};
+constexpr uint8_t spiDivider[]{4, 16, 64, 128};
+}   // namespace
+
+SPIClass SPI;
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sends a byte. The received byte is always 0 (the display has no
+///        output).
+///
+/// @param data
+/// @return uint8_t
+//////////////////////////////////////////////////////////////////////////////
+uint8_t SPIClass::transfer(uint8_t data) {
+  uint32_t divider = spiDivider[SPCR & SPR_MASK] >> ((SPSR & _BV(SPI2X)) ? 1 : 0);
+  Host::busy(static_cast<uint32_t>(8ULL * divider * 1000000 / Host::cpuHz()));
+  Host::Machine *machine = Host::getMachine();
+  if (machine) { machine->spiTransfer(data); }
+  return 0;
+}
@@ -0,0 +1,46 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file SPI.h
+/// @author Kai R.
+/// @brief SPI for the host tools. Every byte is passed on to the machine
+///        (Host::Machine::spiTransfer()) and takes 8 SPI clocks. The SPI
+///        clock results from SPCR (SPR1:0), SPSR (SPI2X) and the clock (CLKPR),
+///        as on the MCU.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HOST_SPI_H_
+#define _HOST_SPI_H_
+
+#include "Arduino.h"
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+#define SPI_CLOCK_DIV4 0x00
+#define SPI_CLOCK_DIV16 0x01
+#define SPI_CLOCK_DIV64 0x02
+#define SPI_CLOCK_DIV128 0x03
+
+class SPIClass {
+public:
+  static void begin(void) { SPCR |= _BV(MSTR) | _BV(SPE); }
+  static void end(void) { SPCR &= ~_BV(SPE); }
+  static void setBitOrder(uint8_t) {}
+  static void setDataMode(uint8_t) {}
+  static void setClockDivider(uint8_t div) { SPCR = (SPCR & ~(_BV(SPR1) | _BV(SPR0))) | div; }
+  static uint8_t transfer(uint8_t);
+};
+
+extern SPIClass SPI;
+
+#endif
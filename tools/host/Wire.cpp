@@ -0,0 +1,98 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file Wire.cpp
+/// @author Kai R.
+/// @brief I2C (Wire) for the host tools.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-02-04
+/// Every transaction is reported to the machine (energy model).
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Wire.h"
+
+namespace {
+constexpr uint8_t MAX_ADDRESS{0x80};
+constexpr uint8_t BITS_PER_BYTE{9};    // 8 data bits and ACK
+constexpr uint8_t BITS_START_STOP{2};
+constexpr uint8_t NACK_ADDRESS{2};     // endTransmission(): address not acknowledged
+
+Host::I2cDevice *devices[MAX_ADDRESS];
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The bus is busy for a transaction with the address and len bytes.
+///        SCL = CPU clock / (16 + 2 * TWBR), TWI prescaler 1.
+///
+/// @param len
+//////////////////////////////////////////////////////////////////////////////
+void transfer(uint8_t len) {
+  uint32_t bits = BITS_START_STOP + BITS_PER_BYTE * (1 + len);
+  uint32_t sclDivider = 16 + 2 * TWBR;
+  Host::busy(static_cast<uint32_t>(static_cast<uint64_t>(bits) * sclDivider * 1000000 / Host::cpuHz()));
+  if (Host::getMachine()) { Host::getMachine()->i2cTransfer(len); }
+}
+}   // namespace
+
+TwoWire Wire;
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief As Wire of the core: the result is wrong if F_CPU / speed < 16.
+///
+/// @param speed
+//////////////////////////////////////////////////////////////////////////////
+void TwoWire::setClock(uint32_t speed) {
+#ifdef F_CPU
+  TWBR = static_cast<uint8_t>(((F_CPU / speed) - 16) / 2);
+#else
+  (void)speed;
+#endif
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _address = address;
+  _length = 0;
+  _index = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (_length >= BUFFER_LENGTH) { return 0; }
+  _buffer[_length++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t len) {
+  size_t n = 0;
+  while (n < len && write(data[n])) { ++n; }
+  return n;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  transfer(_length);
+  Host::I2cDevice *device = (_address < MAX_ADDRESS) ? devices[_address] : nullptr;
+  if (!device) { return NACK_ADDRESS; }
+  device->i2cWrite(_buffer, _length);
+  _length = 0;
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t len) {
+  if (len > BUFFER_LENGTH) { len = BUFFER_LENGTH; }
+  transfer(len);
+  Host::I2cDevice *device = (address < MAX_ADDRESS) ? devices[address] : nullptr;
+  _index = 0;
+  _length = device ? len : 0;
+  if (device) { device->i2cRead(_buffer, len); }
+  return _length;
+}
+
+int TwoWire::read() { return (_index < _length) ? _buffer[_index++] : -1; }
+
+namespace Host {
+void attachI2c(uint8_t address, I2cDevice *device) {
+  if (address < MAX_ADDRESS) { devices[address] = device; }
+}
+}   // namespace Host
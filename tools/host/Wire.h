@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file Wire.h
+/// @author Kai R.
+/// @brief I2C (Wire) for the host tools. The transactions are passed on to
+///        the device attached to the address (Host::attachI2c()). Every
+///        transaction takes the time of its bits at the bit rate that results
+///        from TWBR and the clock (CLKPR), as on the MCU.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HOST_WIRE_H_
+#define _HOST_WIRE_H_
+
+#include "Arduino.h"
+
+namespace Host {
+class I2cDevice {
+public:
+  virtual ~I2cDevice() {}
+  virtual void i2cWrite(const uint8_t *data, uint8_t len) = 0;   // Master writes
+  virtual void i2cRead(uint8_t *data, uint8_t len) = 0;          // Master reads
+};
+
+void attachI2c(uint8_t address, I2cDevice *);
+}   // namespace Host
+
+class TwoWire {
+public:
+  static constexpr uint8_t BUFFER_LENGTH{32};
+
+  void begin(void) {}
+  void setClock(uint32_t);
+  void beginTransmission(uint8_t);
+  size_t write(uint8_t);
+  size_t write(const uint8_t *, size_t);
+  uint8_t endTransmission(bool stop = true);
+  uint8_t requestFrom(uint8_t, uint8_t);
+  int available(void) const { return _length - _index; }
+  int read(void);
+
+private:
+  uint8_t _address{0};
+  uint8_t _buffer[BUFFER_LENGTH];
+  uint8_t _length{0};
+  uint8_t _index{0};
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file interrupt.h
+/// @author Kai R.
+/// @brief Interrupts for the host tools. ISR(vector) defines a C function
+///        with the name of the vector. The vectors are declared weak, so the
+///        host only calls those that are defined by the program.
+///        INT0/INT1 are used with attachInterrupt() (tools/host/Arduino.cpp).
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-02-11
+/// TIMER1_COMPB_vect.
+///
+/// @date 2023-02-11
+/// TIMER0_COMPA_vect.
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HOST_AVR_INTERRUPT_H_
+#define _HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+extern "C" {
+void PCINT0_vect(void) __attribute__((weak));
+void PCINT1_vect(void) __attribute__((weak));
+void PCINT2_vect(void) __attribute__((weak));
+void PCINT3_vect(void) __attribute__((weak));
+void WDT_vect(void) __attribute__((weak));
+void TIMER1_COMPB_vect(void) __attribute__((weak));
+void TIMER1_OVF_vect(void) __attribute__((weak));
+void TIMER0_COMPA_vect(void) __attribute__((weak));
+}
+
+#define ISR(vector, ...) extern "C" void vector(void)
+
+inline void cli(void) { SREG &= ~_BV(SREG_I); }
+
+namespace Host {
+void service(void);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Enables the interrupts. Pending interrupts are executed.
+///
+//////////////////////////////////////////////////////////////////////////////
+inline void sei(void) {
+  SREG |= _BV(SREG_I);
+  Host::service();
+}
+
+#endif
@@ -0,0 +1,242 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file io.h
+/// @author Kai R.
+/// @brief Registers and bits of the ATtiny88 used by the clock, for the
+///        host tools. The registers are plain variables (tools/host/Arduino.cpp).
+///        Restoring SREG with the I-bit set executes the pending interrupts,
+///        like sei().
+///        Only the pin registers (PINx) and the interrupt registers (SREG,
+///        PCICR, PCMSKx, WDTCSR) are evaluated by the host, CLKPR, TWBR and
+///        SPCR/SPSR for the timing of the bus transfers.
+///        Timer1 is simulated only with an external clock at T1 (CS1 = 6, 7;
+///        Host::setT1Clock()): TCNT1 and TIFR1 are computed from the virtual
+///        time when they are accessed. The compare unit B sets OCF1B when
+///        the counter reaches OCR1B (not double buffered in the PWM modes).
+///        Timer0 counts the timer time (Host::getTimerMicros()) in ticks of
+///        8 us (prescaler 8 at 1 MHz, kept by lib/cpuclock); only its
+///        compare unit A is simulated (TCNT0, OCR0A, OCF0A).
+///        The ADC converts only the bandgap input (MUX = 14) with the
+///        reference AVCC, from the supply voltage of the machine
+///        (Host::Machine::vcc()). Setting ADSC takes the conversion time,
+///        ADSC is clear when it is read again.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-01-21
+/// Timer1 with external clock, TIMSK0/TIMSK1. SREG executes the pending
+/// interrupts when it is restored.
+///
+/// @date 2023-02-04
+/// ADC (bandgap measurement).
+///
+/// @date 2023-02-11
+/// Timer1 compare unit B (OCR1B, OCIE1B, OCF1B).
+///
+/// @date 2023-02-11
+/// Timer0 compare unit A (TCNT0, OCR0A, TIFR0, OCIE0A, OCF0A).
+///
+/// @date 2023-02-25
+/// SPI2X (SPSR).
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HOST_AVR_IO_H_
+#define _HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+namespace Host {
+class StatusReg {   // Assigning a value with the I-bit set executes the pending interrupts
+public:
+  constexpr StatusReg(uint8_t value) : _value(value) {}
+  operator uint8_t() const { return _value; }
+  StatusReg &operator=(uint8_t);
+  StatusReg &operator|=(int value) {
+    _value |= value;
+    return *this;
+  }
+  StatusReg &operator&=(int value) {
+    _value &= value;
+    return *this;
+  }
+
+private:
+  uint8_t _value;
+};
+
+class Timer1Count {
+public:
+  operator uint16_t() const;
+  Timer1Count &operator=(uint16_t);
+};
+
+class AdcControl {   // Setting ADSC converts the input
+public:
+  operator uint8_t() const { return _value; }
+  AdcControl &operator=(uint8_t);
+  AdcControl &operator|=(int value) { return *this = _value | value; }
+  AdcControl &operator&=(int value) { return *this = _value & value; }
+
+private:
+  uint8_t _value{0};
+};
+
+class Timer1Flags {   // Writing a 1 clears the flag
+public:
+  operator uint8_t() const;
+  Timer1Flags &operator=(uint8_t);
+};
+
+class Timer0Count {
+public:
+  operator uint8_t() const;
+};
+
+class Timer0Flags {   // Writing a 1 clears the flag
+public:
+  operator uint8_t() const;
+  Timer0Flags &operator=(uint8_t);
+};
+}   // namespace Host
+
+extern Host::StatusReg SREG;
+extern volatile uint8_t SMCR;
+extern volatile uint8_t MCUCR;
+extern volatile uint8_t MCUSR;
+extern volatile uint8_t WDTCSR;
+extern volatile uint8_t CLKPR;
+extern volatile uint8_t PRR;
+extern volatile uint8_t DIDR0;
+extern volatile uint8_t DIDR1;
+extern volatile uint8_t ACSR;
+extern volatile uint8_t TCCR0A;   // The ATtiny88 has no TCCR0B
+extern Host::Timer0Count TCNT0;
+extern volatile uint8_t OCR0A;
+extern Host::Timer0Flags TIFR0;
+extern volatile uint8_t TCCR1A;
+extern volatile uint8_t TCCR1B;
+extern Host::Timer1Count TCNT1;
+extern volatile uint16_t OCR1B;
+extern Host::Timer1Flags TIFR1;
+extern volatile uint8_t TIMSK0;
+extern volatile uint8_t TIMSK1;
+extern volatile uint8_t ADMUX;
+extern Host::AdcControl ADCSRA;
+extern volatile uint16_t ADC;
+extern volatile uint8_t TWBR;
+extern volatile uint8_t SPCR;
+extern volatile uint8_t SPSR;
+extern volatile uint8_t EICRA;
+extern volatile uint8_t EIMSK;
+extern volatile uint8_t PCICR;
+extern volatile uint8_t PCMSK0;
+extern volatile uint8_t PCMSK1;
+extern volatile uint8_t PCMSK2;
+extern volatile uint8_t PCMSK3;
+extern volatile uint8_t PINA;
+extern volatile uint8_t PINB;
+extern volatile uint8_t PINC;
+extern volatile uint8_t PIND;
+extern volatile uint8_t DDRA;
+extern volatile uint8_t DDRB;
+extern volatile uint8_t DDRC;
+extern volatile uint8_t DDRD;
+extern volatile uint8_t PORTA;
+extern volatile uint8_t PORTB;
+extern volatile uint8_t PORTC;
+extern volatile uint8_t PORTD;
+
+// SREG
+#define SREG_I 7
+// SMCR
+#define SE 0
+#define SM0 1
+#define SM1 2
+// MCUCR
+#define BODSE 5
+#define BODS 6
+// MCUSR
+#define PORF 0
+#define EXTRF 1
+#define BORF 2
+#define WDRF 3
+// WDTCSR
+#define WDP0 0
+#define WDP1 1
+#define WDP2 2
+#define WDE 3
+#define WDCE 4
+#define WDP3 5
+#define WDIE 6
+#define WDIF 7
+// CLKPR
+#define CLKPS0 0
+#define CLKPS1 1
+#define CLKPS2 2
+#define CLKPS3 3
+#define CLKPCE 7
+// PRR
+#define PRADC 0
+#define PRSPI 2
+#define PRTIM1 3
+#define PRTIM0 5
+#define PRTWI 7
+// DIDR0, DIDR1, ACSR
+#define ADC0D 0
+#define ADC1D 1
+#define ADC2D 2
+#define ADC3D 3
+#define ADC4D 4
+#define ADC5D 5
+#define AIN0D 0
+#define AIN1D 1
+#define ACD 7
+// ADMUX, ADCSRA
+#define REFS0 6
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADSC 6
+#define ADEN 7
+// TCCR0A, TCCR1B
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define CS10 0
+#define CS11 1
+#define CS12 2
+// TCCR1A, TCCR1B
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+// TIMSK0, TIMSK1, TIFR0, TIFR1
+#define TOIE0 0
+#define OCIE0A 1
+#define TOIE1 0
+#define OCIE1B 2
+#define OCF0A 1
+#define TOV1 0
+#define OCF1B 2
+// SPCR
+#define SPR0 0
+#define SPR1 1
+#define MSTR 4
+#define SPE 6
+// SPSR
+#define SPI2X 0
+// PCICR
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCIE3 3
+// PIND
+#define PIND2 2
+#define PIND3 3
+
+#define _BV(b) (1 << (b))
+
+#endif
@@ -0,0 +1,30 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file pgmspace.h
+/// @author Kai R.
+/// @brief Program memory access for the host tools. There is only one
+///        address space on the host: PROGMEM is empty and the read
+///        functions access the data directly.
+///
+/// @date 2023-01-14
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HOST_AVR_PGMSPACE_H_
+#define _HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t *>(addr))
+#define pgm_read_word(addr) (*reinterpret_cast<const uint16_t *>(addr))
+
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+
+#endif
@@ -0,0 +1,21 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file power.h
+/// @author Kai R.
+/// @brief Power reduction register macros for the host tools.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HOST_AVR_POWER_H_
+#define _HOST_AVR_POWER_H_
+
+#include <avr/io.h>
+
+#define power_adc_disable() (PRR |= _BV(PRADC))
+#define power_adc_enable() (PRR &= ~_BV(PRADC))
+
+#endif
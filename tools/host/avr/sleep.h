@@ -0,0 +1,38 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file sleep.h
+/// @author Kai R.
+/// @brief Sleep modes for the host tools. sleep_cpu() hands over to the
+///        machine (Host::sleep()), which runs until an interrupt wakes the MCU.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HOST_AVR_SLEEP_H_
+#define _HOST_AVR_SLEEP_H_
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE 0x00
+#define SLEEP_MODE_ADC _BV(SM0)
+#define SLEEP_MODE_PWR_DOWN _BV(SM1)
+
+namespace Host {
+void sleep(uint8_t);
+}
+
+inline void set_sleep_mode(uint8_t mode) { SMCR = (SMCR & ~(_BV(SM0) | _BV(SM1))) | mode; }
+inline void sleep_enable(void) { SMCR |= _BV(SE); }
+inline void sleep_disable(void) { SMCR &= ~_BV(SE); }
+inline void sleep_bod_disable(void) {
+  MCUCR = _BV(BODS) | _BV(BODSE);
+  MCUCR = _BV(BODS);
+}
+inline void sleep_cpu(void) {
+  if (SMCR & _BV(SE)) { Host::sleep(SMCR & (_BV(SM0) | _BV(SM1))); }
+}
+
+#endif
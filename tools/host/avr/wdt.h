@@ -0,0 +1,21 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file wdt.h
+/// @author Kai R.
+/// @brief Watchdog for the host tools. The watchdog interrupt (WDTCSR, WDIE)
+///        is generated by the machine.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HOST_AVR_WDT_H_
+#define _HOST_AVR_WDT_H_
+
+#include <avr/io.h>
+
+inline void wdt_reset(void) {}
+
+#endif
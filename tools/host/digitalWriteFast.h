@@ -0,0 +1,22 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file digitalWriteFast.h
+/// @author Kai R.
+/// @brief digitalWriteFast for the host tools. Maps to the Arduino functions.
+///
+/// @date 2022-12-17
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HOST_DIGITALWRITEFAST_H_
+#define _HOST_DIGITALWRITEFAST_H_
+
+#include "Arduino.h"
+
+#define pinModeFast(pin, mode) pinMode((pin), (mode))
+#define digitalWriteFast(pin, level) digitalWrite((pin), (level))
+#define digitalReadFast(pin) digitalRead(pin)
+
+#endif
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Static RAM usage per module of the DCF77 clock, from the linker map file.
+
+Sums the input sections of .data, .bss and .noinit per module. A module is a
+library archive (lib/dcf77 -> dcf77, Arduino core -> FrameworkArduino,
+avr-libc -> c) or an object file of src. The rest of the RAM is left for
+the stack; the real stack use is measured at runtime (lib/memcheck, trace
+event STACK).
+
+Budgets (bytes) are checked after the table. "total" limits the sum of all
+modules. If a budget is exceeded, the exit code is 1 and the PlatformIO build
+fails.
+
+Usage:
+    ram_report.py firmware.map [--ram 512] [--symbols] [--budget total=448 dcf77=160 ...]
+
+In platformio.ini (all AVR environments, see [env]):
+    extra_scripts = post:tools/ram_report.py
+    custom_ram_budget = total=448 dcf77=160
+"""
+
+import argparse
+import os
+import re
+import sys
+
+RAM_SECTIONS = (".data", ".bss", ".noinit")
+
+# Output section (column 0):      .bss            0x0080012a       0x5c
+OUTPUT_SECTION = re.compile(r"^(\.\w+)\s")
+# Input section:                  .bss.name      0x0080012a        0x4 path/file.o
+INPUT_SECTION = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+# Long section names are followed by the values in the next line
+INPUT_NAME_ONLY = re.compile(r"^ (\.\S+|COMMON)\s*$")
+INPUT_VALUES = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+ARCHIVE_MEMBER = re.compile(r"^(.*)\((.*)\)$")
+
+
+def module_name(path):
+    """libdcf77.a(dcf77.cpp.o) -> dcf77, .../src/main.cpp.o -> main.cpp"""
+    match = ARCHIVE_MEMBER.match(path)
+    if match:
+        name = os.path.basename(match.group(1))
+        if name.startswith("lib"):
+            name = name[3:]
+        return os.path.splitext(name)[0]
+    name = os.path.basename(path)
+    return name[:-2] if name.endswith(".o") else name
+
+
+def parse_map(lines):
+    """Returns a list of (module, output section, input section, size)."""
+    entries = []
+    in_memory_map = False
+    output = None
+    pending = None
+    for line in lines:
+        line = line.rstrip("\n")
+        if not in_memory_map:
+            in_memory_map = line.startswith("Linker script and memory map")
+            continue
+        match = OUTPUT_SECTION.match(line)
+        if match:
+            output = match.group(1) if match.group(1) in RAM_SECTIONS else None
+            pending = None
+            continue
+        if output is None:
+            continue
+        if pending is not None:
+            match = INPUT_VALUES.match(line)
+            if match:
+                entries.append((module_name(match.group(3)), output, pending, int(match.group(2), 16)))
+            pending = None
+            continue
+        match = INPUT_SECTION.match(line)
+        if match:
+            if match.group(1) != "*fill*":
+                entries.append((module_name(match.group(4)), output, match.group(1), int(match.group(3), 16)))
+            continue
+        match = INPUT_NAME_ONLY.match(line)
+        if match:
+            pending = match.group(1)
+    return [entry for entry in entries if entry[3] > 0]
+
+
+def parse_budget(items):
+    budget = {}
+    for item in items:
+        name, _, value = item.partition("=")
+        if not value:
+            raise ValueError("budget must be module=bytes: %s" % item)
+        budget[name] = int(value, 0)
+    return budget
+
+
+def report(entries, ram, budget, symbols, out=sys.stdout):
+    """Prints the table, returns the list of exceeded budgets."""
+    modules = {}
+    for module, output, _, size in entries:
+        sizes = modules.setdefault(module, dict.fromkeys(RAM_SECTIONS, 0))
+        sizes[output] += size
+    totals = dict.fromkeys(RAM_SECTIONS, 0)
+    out.write("%-20s %6s %6s %7s %6s\n" % ("module", ".data", ".bss", ".noinit", "total"))
+    for module, sizes in sorted(modules.items(), key=lambda item: -sum(item[1].values())):
+        for section in RAM_SECTIONS:
+            totals[section] += sizes[section]
+        out.write("%-20s %6u %6u %7u %6u\n" % ((module,) + tuple(sizes[s] for s in RAM_SECTIONS) +
+                                              (sum(sizes.values()),)))
+        if symbols:
+            for entry_module, _, section, size in sorted(entries, key=lambda e: -e[3]):
+                if entry_module == module:
+                    out.write("    %-40s %5u\n" % (section, size))
+    total = sum(totals.values())
+    out.write("%-20s %6u %6u %7u %6u\n" % (("total",) + tuple(totals[s] for s in RAM_SECTIONS) + (total,)))
+    if ram:
+        out.write("left for the stack: %u of %u bytes\n" % (ram - total, ram))
+
+    exceeded = []
+    for name, limit in sorted(budget.items()):
+        used = total if name == "total" else sum(modules.get(name, {}).values())
+        if used > limit:
+            exceeded.append("%s: %u bytes, budget %u bytes" % (name, used, limit))
+    for line in exceeded:
+        out.write("RAM budget exceeded: %s\n" % line)
+    return exceeded
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("map", help="linker map file (-Wl,-Map)")
+    parser.add_argument("--ram", type=int, default=0, help="RAM size of the MCU (bytes)")
+    parser.add_argument("--symbols", action="store_true", help="list the sections of every module")
+    parser.add_argument("--budget", nargs="*", default=[], metavar="MODULE=BYTES")
+    args = parser.parse_args()
+    with open(args.map) as file:
+        entries = parse_map(file)
+    return 1 if report(entries, args.ram, parse_budget(args.budget), args.symbols) else 0
+
+
+def register(env):
+    """PlatformIO: writes the map file and prints the report after linking."""
+    if env.get("PIOPLATFORM") != "atmelavr":
+        return
+    map_file = os.path.join(env.subst("$BUILD_DIR"), "firmware.map")
+    env.Append(LINKFLAGS=["-Wl,-Map,%s" % map_file])
+    budget = parse_budget(env.GetProjectOption("custom_ram_budget", "").split())
+    ram = int(env.BoardConfig().get("upload.maximum_ram_size", 0))
+
+    def post_link(target, source, env):   # pylint: disable=unused-argument
+        print("RAM usage of %s:" % env.subst("$PIOENV"))
+        with open(map_file) as file:
+            return 1 if report(parse_map(file), ram, budget, False) else 0
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", post_link)
+
+
+if "Import" in globals():   # PlatformIO extra script (SCons)
+    Import("env")   # noqa: F821
+    register(env)   # noqa: F821
+elif __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,110 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file capture_file.cpp
+/// @author Kai R.
+/// @brief Reads files with raw DCF77 edge captures.
+///
+/// @date 2022-12-17
+/// @version 1.0
+///
+/// @date 2023-02-11
+/// The values are decoded by Reader, the file is read at once.
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "capture_file.hpp"
+
+namespace {
+constexpr uint8_t MAX_VALUE_BYTES{5};
+constexpr size_t READ_BLOCK{65536};
+}   // namespace
+
+namespace CaptureFile {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Moves to the start of the next value: behind the next byte with
+///        bit 7 cleared, unless the previous byte is one (start of a value).
+///        The bytes in between are skipped.
+///
+//////////////////////////////////////////////////////////////////////////////
+void Reader::sync() {
+  if (_position == 0 || _position >= _size || !(_data[_position - 1] & 0x80)) { return; }
+  size_t start = _position;
+  while (_position < _size && (_data[_position] & 0x80)) { ++_position; }
+  if (_position < _size) { ++_position; }
+  _skippedBytes += _position - start;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Decodes the next value. Values with more than MAX_VALUE_BYTES
+///        bytes are corrupt and are skipped up to the next byte with bit 7
+///        cleared.
+///
+/// @param edge
+/// @return true    Edge decoded
+/// @return false   End of the data
+//////////////////////////////////////////////////////////////////////////////
+bool Reader::next(Edge &edge) {
+  uint64_t value = 0;
+  uint8_t bytes = 0;
+  while (_position < _size) {
+    uint8_t c = _data[_position++];
+    value |= static_cast<uint64_t>(c & 0x7F) << (7 * bytes);
+    ++bytes;
+    if (c & 0x80) {
+      if (bytes == MAX_VALUE_BYTES) {
+        _skippedBytes += bytes;
+        value = 0;
+        bytes = 0;
+      }
+      continue;
+    }
+    if (value >> 33) {
+      _skippedBytes += bytes;
+      value = 0;
+      bytes = 0;
+      continue;
+    }
+    edge = Edge{static_cast<uint32_t>(value >> 1), static_cast<bool>(value & 1)};
+    return true;
+  }
+  _skippedBytes += bytes;
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Reads a capture.
+///
+/// @param path
+/// @param capture
+/// @return true    File read
+/// @return false   File could not be opened
+//////////////////////////////////////////////////////////////////////////////
+bool read(const char *path, Capture &capture) {
+  FILE *file = fopen(path, "rb");
+  if (!file) { return false; }
+  std::vector<uint8_t> data;
+  size_t n;
+  do {
+    data.resize(data.size() + READ_BLOCK);
+    n = fread(data.data() + data.size() - READ_BLOCK, 1, READ_BLOCK, file);
+    data.resize(data.size() - READ_BLOCK + n);
+  } while (n == READ_BLOCK);
+  fclose(file);
+
+  capture = Capture{};
+  Reader reader(data.data(), data.size());
+  Edge edge;
+  bool lastLevel = false;
+  while (reader.next(edge)) {
+    if (!capture.edges.empty() && edge.level == lastLevel) { ++capture.droppedEdges; }
+    lastLevel = edge.level;
+    // The first duration is measured from the start of the device, not from an edge.
+    if (!capture.edges.empty()) { capture.durationMs += edge.duration; }
+    capture.edges.push_back(edge);
+  }
+  capture.skippedBytes = reader.skippedBytes();
+  return true;
+}
+}   // namespace CaptureFile
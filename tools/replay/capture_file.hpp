@@ -0,0 +1,60 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file capture_file.hpp
+/// @author Kai R.
+/// @brief Reads files with raw DCF77 edge captures (format: lib/capture).
+///
+/// @date 2022-12-17
+/// @version 1.0
+///
+/// @date 2023-02-11
+/// Reader: decodes the values of a capture in memory (mapped files of tools/analyze).
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CAPTURE_FILE_HPP_
+#define _CAPTURE_FILE_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace CaptureFile {
+struct Edge {
+  uint32_t duration;   // ms since the previous edge
+  bool level;          // Signal after the edge (true = second mark)
+};
+
+struct Capture {
+  std::vector<Edge> edges;
+  uint32_t skippedBytes;   // Bytes without a complete value (resynchronization)
+  uint32_t droppedEdges;   // Edges dropped by the device (consecutive edges with the same level)
+  uint64_t durationMs;     // Time from the first to the last edge = receiver on-time
+};
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Decodes the values of a capture in memory from position up to
+///        size. A position inside a value is left with sync().
+///
+//////////////////////////////////////////////////////////////////////////////
+class Reader {
+public:
+  Reader(const uint8_t *data, size_t size, size_t position = 0) : _data(data), _size(size), _position(position) {}
+
+  void sync(void);
+  bool next(Edge &);
+  size_t position(void) const { return _position; }   // Start of the next value
+  uint32_t skippedBytes(void) const { return _skippedBytes; }
+
+private:
+  const uint8_t *_data;
+  size_t _size;
+  size_t _position;
+  uint32_t _skippedBytes{0};
+};
+
+bool read(const char *, Capture &);
+}   // namespace CaptureFile
+
+#endif
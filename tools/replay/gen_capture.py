@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Generates synthetic raw DCF77 edge captures (format: lib/capture/capture.hpp).
+
+The signal is modelled like the output of a receiver module: a pulse of
+100 ms (0) or 200 ms (1) at the start of every second, no pulse in second 59.
+Optional disturbances:
+  --jitter ms       random shift of the pulse start (+-ms), the pulse
+                    length varies by half of it
+  --glitches n      n short spikes (5-40 ms) per minute, in the gaps and as
+                    dropouts inside the pulses
+  --fading p        probability that a fading period (5-30 s without any
+                    pulse) starts in a minute
+  --gap-spike ms    a short spike (5-40 ms) ms after the start of second 59
+                    in every minute: late in the minute gap, after the
+                    minute threshold
+  --pulse-offset ms receiver that lengthens (shortens) every pulse by ms
+  --clock-error %   the MCU clock runs slow by %: all durations appear
+                    longer by this factor (negative: fast)
+The random generator is seeded (--seed), so a capture can be regenerated.
+
+Usage:
+    gen_capture.py --start "2022-12-10 11:58:23" --minutes 30 clean.dcf
+"""
+
+import argparse
+import datetime
+import random
+
+def bcd(value):
+    return (value // 10) << 4 | value % 10
+
+
+def parity(value):
+    return bin(value).count("1") & 1
+
+
+def frame_bits(t):
+    """Bits 0..58 transmitted in the minute before t (t = time of the next minute mark)."""
+    bits = [0] * 59
+    summer = t.month in (4, 5, 6, 7, 8, 9)   # good enough for the corpus dates
+    bits[17], bits[18] = (1, 0) if summer else (0, 1)
+    bits[20] = 1
+
+    def put(first, width, value):
+        for i in range(width):
+            bits[first + i] = (value >> i) & 1
+
+    put(21, 7, bcd(t.minute))
+    bits[28] = parity(bcd(t.minute))
+    put(29, 6, bcd(t.hour))
+    bits[35] = parity(bcd(t.hour))
+    date = bcd(t.day) | t.isoweekday() << 6 | bcd(t.month) << 9 | bcd(t.year % 100) << 14
+    put(36, 22, date)
+    bits[58] = parity(date)
+    return bits
+
+
+def generate(start, minutes, jitter, glitches, fading, gap_spike, pulse_offset, rng):
+    """Returns the list of (time ms, level) of all edges."""
+    edges = []
+    t0 = 5000   # ms from the start of the device to the first second in the capture
+    end = start + datetime.timedelta(minutes=minutes)
+    fade_until = None
+
+    def noisy(ms, limit):
+        return ms + (rng.randint(-limit, limit) if limit else 0)
+
+    second = start
+    while second < end:
+        minute_start = second.replace(second=0)
+        bits = frame_bits(minute_start + datetime.timedelta(minutes=1))
+        if second.second == 0 and fading and rng.random() < fading:
+            fade_until = second + datetime.timedelta(seconds=rng.randint(5, 30))
+        ms = t0 + int((second - start).total_seconds() * 1000)
+        if second.second < 59 and not (fade_until and second < fade_until):
+            length = (200 if bits[second.second] else 100) + pulse_offset
+            rise = noisy(ms + 40, jitter)
+            fall = noisy(rise + length, jitter // 2)
+            edges.append((rise, 1))
+            edges.append((fall, 0))
+        elif second.second == 59 and gap_spike:
+            rise = ms + gap_spike
+            edges.append((rise, 1))
+            edges.append((rise + rng.randint(5, 40), 0))
+        second += datetime.timedelta(seconds=1)
+
+    # A disturbance inverts the signal for its duration: spikes in the gaps,
+    # dropouts inside the pulses. Toggles at the same time cancel each other.
+    toggles = [time for time, _ in edges]
+    if glitches:
+        total = t0 + minutes * 60000
+        for _ in range(int(glitches * minutes)):
+            at = rng.randint(t0, total)
+            toggles += [at, at + rng.randint(5, 40)]
+    toggles.sort()
+    result = []
+    for time in toggles:
+        if result and result[-1][0] == time:
+            result.pop()
+        else:
+            result.append((time, 1 - result[-1][1] if result else 1))
+    return result
+
+
+def encode(edges, clock_error):
+    data = bytearray()
+    last = 0
+    for time, level in edges:
+        if clock_error:
+            time = int(round(time * (1 + clock_error / 100.0)))
+        value = (time - last) << 1 | level
+        last = time
+        while True:
+            byte = value & 0x7F
+            value >>= 7
+            if value:
+                data.append(byte | 0x80)
+            else:
+                data.append(byte)
+                break
+    return bytes(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("output")
+    parser.add_argument("--start", default="2022-12-10 11:58:23", help="local time of the first second")
+    parser.add_argument("--minutes", type=int, default=30)
+    parser.add_argument("--jitter", type=int, default=5, help="pulse start jitter +- ms")
+    parser.add_argument("--glitches", type=float, default=0, help="spikes per minute")
+    parser.add_argument("--fading", type=float, default=0, help="probability of a fading period per minute")
+    parser.add_argument("--gap-spike", type=int, default=0, help="spike in the minute gap (ms after second 59)")
+    parser.add_argument("--pulse-offset", type=int, default=0, help="added to every pulse width (ms)")
+    parser.add_argument("--clock-error", type=float, default=0, help="MCU clock error in percent")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    start = datetime.datetime.strptime(args.start, "%Y-%m-%d %H:%M:%S")
+    rng = random.Random(args.seed)
+    edges = generate(start, args.minutes, args.jitter, args.glitches, args.fading, args.gap_spike,
+                     args.pulse_offset, rng)
+    with open(args.output, "wb") as f:
+        f.write(encode(edges, args.clock_error))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,245 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file replay.cpp
+/// @author Kai R.
+/// @brief Host tool: replays raw DCF77 edge captures (lib/capture) through
+///        the unchanged DCF77Receive/DCF77Clock code and reports the result
+///        of every minute.
+///
+///        Build:   pio run -e replay
+///        Usage:   .pio/build/replay/program [--summary] [--deglitch pulse,gap] [--fixed] [--late ms] capture.dcf ...
+///                 --deglitch sets DCF77Receive::setDeglitch() (ms, 0 = off)
+///                 --fixed    constant pulse thresholds (DCF77Receive::setAdaptive(false))
+///                 --late     decode a sequence at the first edge ms after the minute mark
+///                            (a busy main loop, the frame mailbox must keep it)
+///
+///        Every edge sets the virtual time and the level of the INT0 pin
+///        (tools/host). The pin change calls the ISR of DCF77Receive. A
+///        complete sequence is decoded immediately, as taskSync() does on
+///        the clock. The number of minutes is derived from the on-time,
+///        so it does not depend on the decoder.
+///        DCF77Receive keeps its state in static members, so every file is
+///        replayed in its own process (fork()) and starts like a reset clock.
+///
+///        Per file and in total:
+///        - minutes        receiver on-time in minutes
+///        - complete       sequences with 59 (60) seconds
+///        - valid          decodeSequence() == true (the RTC would be set)
+///        - syncs/h        valid / receiver on-time
+///        - first sync     seconds from the first edge to the first valid sequence
+///
+///        The corpus in tools/replay/corpus is the regression suite. Its
+///        results are stored in tools/replay/corpus/expected.txt:
+///        .pio/build/replay/program --summary tools/replay/corpus/*.dcf | diff - tools/replay/corpus/expected.txt
+///
+/// @date 2022-12-17
+/// @version 1.0
+///
+/// @date 2023-01-28
+/// --fixed, the verbose output shows the adaptive thresholds.
+///
+/// @date 2023-02-04
+/// --late.
+///
+/// @copyright Copyright (c) 2022
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <Arduino.h>
+#include "capture_file.hpp"
+#include "dcf77.hpp"
+
+namespace {
+constexpr uint8_t DCF77_INT_PIN{PIND2};
+constexpr uint32_t MINUTE_MS{60000};
+
+struct Result {
+  uint32_t minutes;
+  uint32_t complete;
+  uint32_t valid;
+  uint64_t onTimeMs;
+  uint32_t files;
+  uint32_t filesSynced;
+  uint64_t firstSyncMs;   // Sum over the synced files
+};
+
+volatile bool sequenceReceived{false};
+int minPulse{DEGLITCH_MIN_PULSE};
+int minGap{DEGLITCH_MIN_GAP};
+bool adaptive{true};
+uint32_t lateMs{0};
+
+void onSequence() { sequenceReceived = true; }
+
+void printResult(const char *name, const Result &r) {
+  double hours = r.onTimeMs / 3600000.0;
+  printf("%-32s minutes %5u  complete %5u  valid %5u  on-time %7.2f h  syncs/h %6.1f", name, r.minutes, r.complete,
+         r.valid, hours, hours > 0 ? r.valid / hours : 0.0);
+  if (r.filesSynced) {
+    printf("  first sync %6.1f s", r.firstSyncMs / 1000.0 / r.filesSynced);
+    if (r.files > 1) { printf(" (%u/%u)", r.filesSynced, r.files); }
+  } else {
+    printf("  first sync      - ");
+  }
+  printf("\n");
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Replays one capture.
+///
+/// @param dcf77
+/// @param capture
+/// @param verbose    Print one line per minute
+/// @return Result
+//////////////////////////////////////////////////////////////////////////////
+Result replay(DCF77Clock &dcf77, const CaptureFile::Capture &capture, bool verbose) {
+  Result r{};
+  r.files = 1;
+  r.onTimeMs = capture.durationMs;
+  r.minutes = (capture.durationMs + MINUTE_MS / 2) / MINUTE_MS;
+  uint64_t now = Host::getMicros();
+  uint64_t firstEdge = 0;
+  uint64_t lastSequence = 0;
+  uint64_t pendingSince = 0;
+  bool pending = false;
+  bool synced = false;
+
+  for (size_t i = 0; i < capture.edges.size(); ++i) {
+    const CaptureFile::Edge &edge = capture.edges[i];
+    now += static_cast<uint64_t>(edge.duration) * 1000;
+    if (i == 0) { firstEdge = lastSequence = now; }
+    Host::setMicros(now);
+    sequenceReceived = false;
+    Host::setPin(DCF77_INT_PIN, edge.level);
+    dcf77.updateThresholds();   // Main context of the firmware (taskSync())
+    if (sequenceReceived) {
+      ++r.complete;
+      if (!pending) { pendingSince = now; }
+      pending = true;
+    }
+    if (!pending || now - pendingSince < static_cast<uint64_t>(lateMs) * 1000) { continue; }
+
+    pending = false;
+    bool valid = dcf77.decodeSequence();
+    TimeCalc::DateTime dt = dcf77.getDateTime();
+    uint32_t ms = (now - firstEdge) / 1000;
+    if (valid) {
+      ++r.valid;
+      if (!synced) {
+        synced = true;
+        r.filesSynced = 1;
+        r.firstSyncMs = ms;
+      }
+    }
+    if (verbose) {
+      uint32_t missing = ((now - lastSequence) / 1000 + MINUTE_MS / 2) / MINUTE_MS;
+      if (missing > 1) { printf("%10s    %u minutes incomplete\n", "", missing - 1); }
+      DCF77Quality q = dcf77.getQuality();
+      DCF77Thresholds t = dcf77.getThresholds();
+      printf("%10.1f s  %-10s 20%02u-%02u-%02u %02u:%02u  quality %2u (pulse error %3u ms, spikes %3u/min, missed %3u/min)"
+             "  thresholds %3u/%3u/%4u ms\n",
+             ms / 1000.0, valid ? "valid" : "invalid", dt.year, dt.month, dt.day, dt.hour, dt.minute, q.score,
+             q.pulseError, q.spikes, q.missed, t.shortPulse, t.longPulse, t.minute);
+    }
+    lastSequence = now;
+  }
+  if (verbose) {
+    printf("%u spikes/dropouts removed by the deglitch filter\n", dcf77.getGlitchCount());
+    if (capture.skippedBytes) { printf("%u bytes skipped (corrupt values)\n", capture.skippedBytes); }
+    if (capture.droppedEdges) { printf("%u edges dropped by the device\n", capture.droppedEdges); }
+  }
+  return r;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Replays a file in a child process.
+///
+/// @param path
+/// @param verbose
+/// @param r        Result of the file
+/// @return true    Replayed
+/// @return false   File could not be read
+//////////////////////////////////////////////////////////////////////////////
+bool replayFile(const char *path, bool verbose, Result &r) {
+  int fd[2];
+  if (pipe(fd) != 0) { return false; }
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fd[0]);
+    CaptureFile::Capture capture;
+    bool ok = CaptureFile::read(path, capture);
+    if (ok) {
+      DCF77Clock dcf77;
+      dcf77.begin(DCF77_INT_PIN);
+      dcf77.setSequenceCallback(onSequence);
+      dcf77.setDeglitch(minPulse, minGap);
+      dcf77.setAdaptive(adaptive);
+      r = replay(dcf77, capture, verbose);
+      fflush(stdout);
+      ok = write(fd[1], &r, sizeof(r)) == sizeof(r);
+    }
+    _exit(ok ? 0 : 1);
+  }
+  close(fd[1]);
+  bool ok = pid > 0 && read(fd[0], &r, sizeof(r)) == sizeof(r);
+  close(fd[0]);
+  if (pid > 0) { waitpid(pid, nullptr, 0); }
+  return ok;
+}
+
+void add(Result &total, const Result &r) {
+  total.minutes += r.minutes;
+  total.complete += r.complete;
+  total.valid += r.valid;
+  total.onTimeMs += r.onTimeMs;
+  total.files += r.files;
+  total.filesSynced += r.filesSynced;
+  total.firstSyncMs += r.firstSyncMs;
+}
+}   // namespace
+
+int main(int argc, char *argv[]) {
+  bool summary = false;
+  int first = 1;
+  for (; first < argc && strncmp(argv[first], "--", 2) == 0; ++first) {
+    if (strcmp(argv[first], "--summary") == 0) {
+      summary = true;
+    } else if (strcmp(argv[first], "--deglitch") == 0 && first + 1 < argc &&
+               sscanf(argv[first + 1], "%d,%d", &minPulse, &minGap) == 2) {
+      ++first;
+    } else if (strcmp(argv[first], "--fixed") == 0) {
+      adaptive = false;
+    } else if (strcmp(argv[first], "--late") == 0 && first + 1 < argc &&
+               sscanf(argv[first + 1], "%u", &lateMs) == 1) {
+      ++first;
+    } else {
+      first = argc;
+    }
+  }
+  if (first >= argc) {
+    fprintf(stderr, "Usage: %s [--summary] [--deglitch pulse,gap] [--fixed] [--late ms] capture.dcf ...\n", argv[0]);
+    return 2;
+  }
+
+  Result total{};
+  int errors = 0;
+  for (int i = first; i < argc; ++i) {
+    const char *name = strrchr(argv[i], '/');
+    name = name ? name + 1 : argv[i];
+    if (!summary) { printf("%s\n", name); }
+    Result r;
+    if (!replayFile(argv[i], !summary, r)) {
+      fprintf(stderr, "%s: cannot read\n", argv[i]);
+      ++errors;
+      continue;
+    }
+    printResult(name, r);
+    add(total, r);
+  }
+  if (argc - first > 1) { printResult("total", total); }
+  return errors ? 1 : 0;
+}
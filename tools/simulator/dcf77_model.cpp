@@ -0,0 +1,130 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file dcf77_model.cpp
+/// @author Kai R.
+/// @brief Model of the DCF77 transmitter and receiver module.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-02-04
+/// Fading by day, stuck receiver.
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include "dcf77_model.hpp"
+#include "timecalc.hpp"
+
+namespace {
+constexpr uint8_t NO_PULSE_SECOND{59};
+constexpr uint32_t DAY_START{6 * TimeCalc::SECONDS_PER_HOUR};   // fadingDay (true time)
+constexpr uint32_t DAY_END{22 * TimeCalc::SECONDS_PER_HOUR};
+constexpr uint64_t PULSE_0{100 * Sim::MILLISECOND};
+constexpr uint64_t PULSE_1{200 * Sim::MILLISECOND};
+
+uint8_t parity(uint32_t value) { return __builtin_popcount(value) & 1; }
+}   // namespace
+
+namespace Sim {
+Dcf77Model::Dcf77Model(Simulation &sim, uint8_t outPin, uint8_t powerPin, const Dcf77Config &config)
+    : _sim(sim), _outPin(outPin), _powerPin(powerPin), _config(config), _rng(config.seed) {
+  output();
+  _sim.onPinWritten([this](uint8_t pin, uint8_t level) {
+    if (pin == _powerPin) { power(level == LOW); }
+  });
+  _sim.at(0, [this] { second(0); });
+}
+
+uint64_t Dcf77Model::onTime() const { return _onTime + (_powered ? _sim.now() - _poweredSince : 0); }
+
+bool Dcf77Model::chance(double p) { return std::uniform_real_distribution<double>(0, 1)(_rng) < p; }
+
+uint32_t Dcf77Model::uniform(uint32_t min, uint32_t max) {
+  return std::uniform_int_distribution<uint32_t>(min, max)(_rng);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Bits 0..58 transmitted in the minute before the given minute.
+///
+/// @param epochNextMinute
+/// @return uint64_t    Bit n = second n
+//////////////////////////////////////////////////////////////////////////////
+uint64_t Dcf77Model::frameBits(uint32_t epochNextMinute) {
+  TimeCalc::DateTime t = TimeCalc::fromEpoch(epochNextMinute);
+  bool summer = t.month >= 4 && t.month <= 9;   // Good enough for the simulation
+  uint64_t bits = summer ? (1ULL << 17) : (1ULL << 18);
+  bits |= 1ULL << 20;
+  uint32_t minute = BCDConv::decToBcd(t.minute);
+  uint32_t hour = BCDConv::decToBcd(t.hour);
+  uint32_t date = BCDConv::decToBcd(t.day) | TimeCalc::dayOfWeek(t) << 6 | BCDConv::decToBcd(t.month) << 9 |
+                  static_cast<uint32_t>(BCDConv::decToBcd(t.year)) << 14;
+  bits |= static_cast<uint64_t>(minute | parity(minute) << 7) << 21;
+  bits |= static_cast<uint64_t>(hour | parity(hour) << 6) << 29;
+  bits |= static_cast<uint64_t>(date | parity(date) << 22) << 36;
+  return bits;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Start of the true second n of the simulation.
+///
+/// @param n
+//////////////////////////////////////////////////////////////////////////////
+void Dcf77Model::second(uint64_t n) {
+  _sim.at((n + 1) * SECOND, [this, n] { second(n + 1); });
+  uint32_t epoch = _sim.trueEpoch();
+  uint8_t s = epoch % TimeCalc::SECONDS_PER_MINUTE;
+
+  uint32_t secondOfDay = epoch % TimeCalc::SECONDS_PER_DAY;
+  bool day = _config.fadingDay >= 0 && secondOfDay >= DAY_START && secondOfDay < DAY_END;
+  if (s == 0 && chance(day ? _config.fadingDay : _config.fading)) { _fadeUntil = _sim.now() + uniform(5, 30) * SECOND; }
+  if (chance(_config.spikes / TimeCalc::SECONDS_PER_MINUTE)) {
+    uint64_t start = uniform(0, 999) * MILLISECOND;
+    uint64_t length = uniform(5, 40) * MILLISECOND;
+    _sim.after(start, [this] {
+      _spike = true;
+      output();
+    });
+    _sim.after(start + length, [this] {
+      _spike = false;
+      output();
+    });
+  }
+
+  uint64_t rise = _sim.now() + _config.delayMs * MILLISECOND;
+  if (!_powered || _stuck || rise < _lockedAt || _sim.now() < _fadeUntil || s == NO_PULSE_SECOND) { return; }
+  uint32_t nextMinute = epoch - s + TimeCalc::SECONDS_PER_MINUTE;
+  uint64_t length = ((frameBits(nextMinute) >> s) & 1) ? PULSE_1 : PULSE_0;
+  _sim.at(rise, [this] {
+    _pulse = true;
+    output();
+  });
+  _sim.at(rise + length, [this] {
+    _pulse = false;
+    output();
+  });
+}
+
+void Dcf77Model::power(bool on) {
+  if (on == _powered) { return; }
+  _powered = on;
+  if (on) {
+    _poweredSince = _sim.now();
+    _lockedAt = _sim.now() + _config.lockSeconds * SECOND;
+    ++_switchOns;
+    _stuck = _config.stuck > 0 && chance(_config.stuck);   // Keeps the random sequence without --stuck
+    _sim.log("RECEIVER_ON", _stuck ? "stuck" : "");
+  } else {
+    uint64_t duration = _sim.now() - _poweredSince;
+    _onTime += duration;
+    _sim.log("RECEIVER_OFF", "on_s %.3f", duration / static_cast<double>(SECOND));
+  }
+  output();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Active low output. Without power the output is HIGH (pull-up).
+///
+//////////////////////////////////////////////////////////////////////////////
+void Dcf77Model::output() { Host::setPin(_outPin, !(_powered && (_pulse != _spike))); }
+}   // namespace Sim
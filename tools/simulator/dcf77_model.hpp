@@ -0,0 +1,80 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file dcf77_model.hpp
+/// @author Kai R.
+/// @brief Model of the DCF77 transmitter and receiver module.
+///        The transmitter sends the true time of the simulation: a pulse of
+///        100 ms (0) or 200 ms (1) at the start of every second, no pulse in
+///        second 59 (same frame as tools/replay/gen_capture.py).
+///        The receiver is switched on with a LOW level at the power pin
+///        (P-channel MOSFET). After the lock time it outputs the pulses
+///        active low, delayed by the receiver delay.
+///        Optional disturbances (seeded random generator):
+///        - spikes    short inversions of the output (5-40 ms) per minute
+///        - fading    probability that a period of 5-30 s without pulses
+///                    starts in a minute
+///        - fadingDay the same from 06:00 to 22:00 (true time). The sky wave
+///                    makes the reception at a long distance much better at
+///                    night. Negative: fading all day.
+///        - stuck     probability that the receiver outputs no pulses after
+///                    switching on until it is switched off (AGC stuck)
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-02-04
+/// fadingDay, stuck.
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DCF77_MODEL_HPP_
+#define _DCF77_MODEL_HPP_
+
+#include <random>
+#include "simulation.hpp"
+
+namespace Sim {
+struct Dcf77Config {
+  uint32_t lockSeconds;     // Time from switching on to the first pulses
+  uint32_t delayMs;         // Delay of the pulses after the true second
+  double spikes;            // Spikes per minute
+  double fading;            // Probability of a fading period per minute
+  double fadingDay;         // The same by day, negative: fading
+  double stuck;             // Probability of a stuck receiver per switch-on
+  uint32_t seed;
+};
+
+class Dcf77Model {
+public:
+  Dcf77Model(Simulation &, uint8_t outPin, uint8_t powerPin, const Dcf77Config &);
+
+  uint64_t onTime(void) const;
+  uint32_t switchOns(void) const { return _switchOns; }
+
+private:
+  Simulation &_sim;
+  uint8_t _outPin;
+  uint8_t _powerPin;
+  Dcf77Config _config;
+  std::mt19937 _rng;
+  bool _powered{false};
+  bool _stuck{false};
+  uint64_t _poweredSince{0};
+  uint64_t _onTime{0};
+  uint32_t _switchOns{0};
+  uint64_t _lockedAt{0};
+  uint64_t _fadeUntil{0};
+  bool _pulse{false};
+  bool _spike{false};
+
+  void second(uint64_t);
+  void power(bool);
+  void output(void);
+  bool chance(double);
+  uint32_t uniform(uint32_t, uint32_t);
+  static uint64_t frameBits(uint32_t epochNextMinute);
+};
+}   // namespace Sim
+
+#endif
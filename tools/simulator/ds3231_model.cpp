@@ -0,0 +1,130 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file ds3231_model.cpp
+/// @author Kai R.
+/// @brief Model of the DS3231 RTC (from rtc_model.cpp), aging offset.
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include "ds3231_model.hpp"
+#include "DS3231Wire.h"
+
+namespace {
+constexpr uint8_t NUM_REGS{0x13};
+constexpr uint8_t CONTROL_RESET{0x1C};      // RS2 = RS1 = 1, INTCN = 1
+constexpr uint8_t STATUS_RESET{0x88};       // OSF = 1, EN32kHz = 1
+constexpr uint8_t CONTROL_INTCN{0x04};
+constexpr uint8_t CONTROL_RS{0x18};
+constexpr uint8_t STATUS_EN32KHZ{0x08};
+constexpr uint8_t ALARM_BITS{0x03};         // A1IE/A2IE in CONTROL, A1F/A2F in STATUS
+constexpr uint8_t ALARM_DY{0x40};           // DY/DT: day of the week instead of the date
+constexpr uint8_t HOURS_MASK{0x3F};
+constexpr double AGING_PPM{0.1};            // Per LSB of the aging offset
+}   // namespace
+
+namespace Sim {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The RTC starts with the power-on values of the control registers.
+///
+/// @param sim
+/// @param sqwPin
+/// @param offsetMicros   RTC time - true time at the start
+/// @param driftPpm       The RTC second is longer by driftPpm (runs slow if > 0)
+//////////////////////////////////////////////////////////////////////////////
+Ds3231Model::Ds3231Model(Simulation &sim, uint8_t sqwPin, int64_t offsetMicros, double driftPpm)
+    : RtcModel(sim, DS3231::ADDR, NUM_REGS, sqwPin, offsetMicros, driftPpm) {
+  _regs[DS3231::CONTROL] = CONTROL_RESET;
+  _regs[DS3231::CTL_STATUS] = STATUS_RESET;
+  update32kHz();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief A new RTC second starts now: SQW falls, rises after half a second.
+///
+/// @param period   Length of the second
+//////////////////////////////////////////////////////////////////////////////
+void Ds3231Model::second(uint64_t period) {
+  checkAlarms();
+  setSqw(false);
+  inSecond(period / 2, [this] { setSqw(true); });
+}
+
+double Ds3231Model::calibrationPpm() const {
+  return static_cast<int8_t>(_regs[DS3231::AGING_OFFSET]) * AGING_PPM;
+}
+
+bool Ds3231Model::sqwEnabled() {
+  if (_regs[DS3231::CONTROL] & CONTROL_INTCN) { return false; }
+  if ((_regs[DS3231::CONTROL] & CONTROL_RS) && !_warned) {
+    _warned = true;
+    fprintf(stderr, "RTC: square wave frequency RS = %u not simulated (only 1Hz)\n",
+            (_regs[DS3231::CONTROL] & CONTROL_RS) >> 3);
+  }
+  return !(_regs[DS3231::CONTROL] & CONTROL_RS);
+}
+
+void Ds3231Model::update32kHz() {
+  Host::setT1Clock((_regs[DS3231::CTL_STATUS] & STATUS_EN32KHZ) ? HZ_32K / (1 + driftPpm() * 1e-6) : 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Sets the pin: square wave or (INTCN = 1) the alarm output.
+///
+/// @param level   Phase of the square wave
+//////////////////////////////////////////////////////////////////////////////
+void Ds3231Model::setSqw(bool level) {
+  _sqwLevel = level;
+  if (_regs[DS3231::CONTROL] & CONTROL_INTCN) {
+    Host::setPin(_pin, !(_regs[DS3231::CONTROL] & _regs[DS3231::CTL_STATUS] & ALARM_BITS));
+  } else {
+    Host::setPin(_pin, sqwEnabled() ? level : HIGH);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Compares the alarms with the time of the second that starts now
+///        and sets the flags. Alarm 2 has no seconds register, it matches at
+///        second 00.
+///
+//////////////////////////////////////////////////////////////////////////////
+void Ds3231Model::checkAlarms() {
+  TimeCalc::DateTime t = TimeCalc::fromEpoch(_epoch);
+  if (alarmMatches(DS3231::ALARM1_SECONDS, 4, t)) { _regs[DS3231::CTL_STATUS] |= DS3231::ALARM1; }
+  if (t.second == 0 && alarmMatches(DS3231::ALARM2_MINUTES, 3, t)) { _regs[DS3231::CTL_STATUS] |= DS3231::ALARM2; }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief An alarm matches if every register without mask bit is equal to
+///        the time.
+///
+/// @param reg     First alarm register (seconds or minutes)
+/// @param count   Number of alarm registers (4: with seconds, 3: without)
+/// @param t       RTC time
+//////////////////////////////////////////////////////////////////////////////
+bool Ds3231Model::alarmMatches(uint8_t reg, uint8_t count, const TimeCalc::DateTime &t) const {
+  const uint8_t *alarm = _regs + reg;
+  const uint8_t values[]{BCDConv::decToBcd(t.second), BCDConv::decToBcd(t.minute), BCDConv::decToBcd(t.hour)};
+  for (uint8_t i = 0; i < count - 1; ++i) {
+    uint8_t value = values[i + 4 - count];
+    uint8_t mask = (i + 4 - count == 2) ? HOURS_MASK : 0x7F;
+    if (!(alarm[i] & DS3231::ALARM_MASK) && (alarm[i] & mask) != value) { return false; }
+  }
+  uint8_t dayDate = alarm[count - 1];
+  if (dayDate & DS3231::ALARM_MASK) { return true; }
+  if (dayDate & ALARM_DY) { return (dayDate & 0x0F) == TimeCalc::dayOfWeek(t); }
+  return (dayDate & HOURS_MASK) == BCDConv::decToBcd(t.day);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Square wave or alarm output switched on/off, alarm flags cleared.
+///
+//////////////////////////////////////////////////////////////////////////////
+void Ds3231Model::written() {
+  setSqw(_sqwLevel);
+  update32kHz();
+}
+}   // namespace Sim
@@ -0,0 +1,52 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file ds3231_model.hpp
+/// @author Kai R.
+/// @brief Model of the DS3231 RTC: time registers, control/status registers
+///        and the 1Hz square wave output (SQW).
+///        As on the DS3231, writing the seconds register resets the countdown
+///        chain: the new second starts with the write, SQW falls at the start
+///        of every second and rises in the middle of it.
+///        Only the square wave with 1Hz (INTCN = 0, RS2:1 = 0) is simulated.
+///        With INTCN = 1 the pin is the alarm output: LOW while an enabled
+///        alarm flag (A1F, A2F) is set. The alarms are compared at the start
+///        of every second, with the mask bits AxMy and DY/DT.
+///        The 32kHz output (EN32kHz) clocks Timer1 (T1, Host::setT1Clock()),
+///        with the same drift as the time. The aging offset changes the
+///        drift by 0.1 ppm per LSB (at once, without temperature conversion).
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DS3231_MODEL_HPP_
+#define _DS3231_MODEL_HPP_
+
+#include "rtc_model.hpp"
+
+namespace Sim {
+class Ds3231Model : public RtcModel {
+public:
+  Ds3231Model(Simulation &, uint8_t sqwPin, int64_t offsetMicros, double driftPpm);
+
+protected:
+  void second(uint64_t period) override;
+  void written(void) override;
+  bool secondsWriteResets(void) const override { return true; }
+  double calibrationPpm(void) const override;
+
+private:
+  bool _warned{false};
+  bool _sqwLevel{true};   // Phase of the square wave
+
+  void setSqw(bool);
+  bool sqwEnabled(void);
+  void checkAlarms(void);
+  bool alarmMatches(uint8_t reg, uint8_t count, const TimeCalc::DateTime &) const;
+  void update32kHz(void);
+};
+}   // namespace Sim
+
+#endif
@@ -0,0 +1,102 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file lcd_model.cpp
+/// @author Kai R.
+/// @brief Model of the DOGM081 display.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-01-28
+/// Display on/off.
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include "lcd_model.hpp"
+
+namespace {
+constexpr uint8_t CMD_CLEAR{0x01};
+constexpr uint8_t CMD_HOME_MASK{0xFE};   // 0x02, 0x03
+constexpr uint8_t CMD_FUNCTION_SET_MASK{0xE0};
+constexpr uint8_t CMD_FUNCTION_SET{0x20};
+constexpr uint8_t IS_MASK{0x03};         // Instruction table of the function set
+constexpr uint8_t CMD_CGRAM_MASK{0xC0};
+constexpr uint8_t CMD_CGRAM{0x40};       // Only in instruction table 0
+constexpr uint8_t CMD_DDRAM{0x80};
+constexpr uint8_t CMD_DISPLAY_MASK{0xF8};
+constexpr uint8_t CMD_DISPLAY{0x08};     // Display on/off control, bit 2 = on
+constexpr uint8_t DISPLAY_ON{0x04};
+constexpr uint8_t USER_CHARS{0x08};
+}   // namespace
+
+namespace Sim {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The display content is compared with the last update each time
+///        the MCU goes to sleep. A change counts as one display update.
+///
+/// @param sim
+/// @param csPin
+/// @param rsPin
+//////////////////////////////////////////////////////////////////////////////
+LcdModel::LcdModel(Simulation &sim, uint8_t csPin, uint8_t rsPin) : _sim(sim), _csPin(csPin), _rsPin(rsPin) {
+  memset(_ddram, ' ', sizeof(_ddram));
+  memset(_text, ' ', COLUMNS);
+  _text[COLUMNS] = '\0';
+  _sim.onPinWritten([this](uint8_t pin, uint8_t level) {
+    if (pin == _csPin) { _selected = (level == LOW); }
+    if (pin == _rsPin) { _data = (level == HIGH); }
+  });
+  _sim.onSpi([this](uint8_t data) { transfer(data); });
+  _sim.onSleep([this] { update(); });
+}
+
+void LcdModel::transfer(uint8_t data) {
+  if (!_selected) { return; }
+  if (!_data) {
+    command(data);
+  } else if (_cgram) {
+    ++_address;
+  } else {
+    _ddram[_address % DDRAM_SIZE] = (data < USER_CHARS) ? '~' : static_cast<char>(data);
+    _address = (_address + 1) % DDRAM_SIZE;
+  }
+}
+
+void LcdModel::command(uint8_t cmd) {
+  if (cmd == CMD_CLEAR) {
+    memset(_ddram, ' ', sizeof(_ddram));
+    _address = 0;
+    _cgram = false;
+  } else if ((cmd & CMD_HOME_MASK) == 0x02) {
+    _address = 0;
+    _cgram = false;
+  } else if ((cmd & CMD_FUNCTION_SET_MASK) == CMD_FUNCTION_SET) {
+    _instructionTable = cmd & IS_MASK;
+  } else if ((cmd & CMD_CGRAM_MASK) == CMD_CGRAM && _instructionTable == 0) {
+    _cgram = true;
+  } else if ((cmd & CMD_DISPLAY_MASK) == CMD_DISPLAY) {
+    bool on = cmd & DISPLAY_ON;
+    if (on == _on) { return; }
+    _on = on;
+    if (on) {
+      _offTime += _sim.now() - _offSince;
+    } else {
+      _offSince = _sim.now();
+    }
+    _sim.log(on ? "DISPLAY_ON" : "DISPLAY_OFF");
+  } else if (cmd & CMD_DDRAM) {
+    _address = (cmd & ~CMD_DDRAM) % DDRAM_SIZE;
+    _cgram = false;
+  }
+}
+
+uint64_t LcdModel::offTime() const { return _offTime + (_on ? 0 : _sim.now() - _offSince); }
+
+void LcdModel::update() {
+  if (memcmp(_text, _ddram, COLUMNS) == 0) { return; }
+  memcpy(_text, _ddram, COLUMNS);
+  ++_sim.stats().displayUpdates;
+  if (_logging) { _sim.log("DISPLAY", "\"%s\"", _text); }
+}
+}   // namespace Sim
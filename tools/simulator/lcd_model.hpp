@@ -0,0 +1,61 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file lcd_model.hpp
+/// @author Kai R.
+/// @brief Model of the DOGM081 display (ST7036 controller, 8 characters).
+///        The SPI bytes are commands (RS LOW) or data (RS HIGH) while CS is
+///        LOW. Only the commands needed for the text are interpreted:
+///        clear, return home, function set (instruction table), set CGRAM
+///        and DDRAM address, display on/off. User defined characters are
+///        shown as '~'.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-01-28
+/// Display on/off (DISPLAY_ON, DISPLAY_OFF in the timeline, offTime()).
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _LCD_MODEL_HPP_
+#define _LCD_MODEL_HPP_
+
+#include "simulation.hpp"
+
+namespace Sim {
+class LcdModel {
+public:
+  static constexpr uint8_t COLUMNS{8};
+
+  LcdModel(Simulation &, uint8_t csPin, uint8_t rsPin);
+
+  const char *text(void) const { return _text; }
+  uint64_t offTime(void) const;
+  void setLogging(bool on) { _logging = on; }
+
+private:
+  static constexpr uint8_t DDRAM_SIZE{0x50};
+
+  Simulation &_sim;
+  uint8_t _csPin;
+  uint8_t _rsPin;
+  bool _logging{false};   // Every update in the timeline
+  bool _selected{false};
+  bool _data{false};
+  uint8_t _instructionTable{0};
+  bool _cgram{false};
+  bool _on{true};
+  uint64_t _offSince{0};
+  uint64_t _offTime{0};
+  uint8_t _address{0};
+  char _ddram[DDRAM_SIZE];
+  char _text[COLUMNS + 1];   // Content at the last update
+
+  void transfer(uint8_t);
+  void command(uint8_t);
+  void update(void);
+};
+}   // namespace Sim
+
+#endif
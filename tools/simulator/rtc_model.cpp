@@ -0,0 +1,170 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file rtc_model.cpp
+/// @author Kai R.
+/// @brief Time keeping of the RTC models.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-01-21
+/// 32kHz output.
+///
+/// @date 2023-01-28
+/// Alarms.
+///
+/// @date 2023-02-11
+/// The chip specific parts moved to ds3231_model.cpp and rv3028_model.cpp.
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include "rtc_model.hpp"
+#include "timecalc.hpp"
+
+namespace {
+constexpr uint8_t CEN_MONTH_MASK{0x1F};
+constexpr uint8_t MINUTES{0x01};
+constexpr uint8_t HOURS{0x02};
+constexpr uint8_t DATE{0x04};
+constexpr uint8_t MONTH{0x05};
+}   // namespace
+
+namespace Sim {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The backend sets the power-on values of its registers.
+///
+/// @param sim
+/// @param address        I2C address
+/// @param numRegs        The register pointer wraps around after numRegs
+/// @param pin            Open drain output with pull-up (SQW or INT)
+/// @param offsetMicros   RTC time - true time at the start
+/// @param driftPpm       The RTC second is longer by driftPpm (runs slow if > 0)
+//////////////////////////////////////////////////////////////////////////////
+RtcModel::RtcModel(Simulation &sim, uint8_t address, uint8_t numRegs, uint8_t pin, int64_t offsetMicros,
+                   double driftPpm)
+    : _sim(sim), _pin(pin), _numRegs(numRegs), _driftPpm(driftPpm) {
+  memset(_regs, 0, sizeof(_regs));
+  // The RTC second containing the start: RTC time = true time + offset
+  int64_t rtcMicros = static_cast<int64_t>(_sim.trueEpoch()) * SECOND + offsetMicros;
+  _epoch = static_cast<uint32_t>(rtcMicros / static_cast<int64_t>(SECOND));
+  _secondStart = static_cast<int64_t>(_sim.now()) - rtcMicros % static_cast<int64_t>(SECOND);
+  Host::setPin(_pin, HIGH);
+  Host::attachI2c(address, this);
+  uint32_t generation = _generation;
+  _sim.at(_secondStart + SECOND, [this, generation] {
+    if (generation != _generation) { return; }
+    ++_epoch;
+    startSecond();
+  });
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief A new RTC second starts now.
+///
+//////////////////////////////////////////////////////////////////////////////
+void RtcModel::startSecond() {
+  _secondStart = _sim.now();
+  _driftFraction += driftPpm();
+  double drift = floor(_driftFraction);
+  _driftFraction -= drift;
+  uint64_t period = SECOND + static_cast<int64_t>(drift);
+  uint32_t generation = _generation;
+  second(period);
+  _sim.after(period, [this, generation] {
+    if (generation != _generation) { return; }
+    ++_epoch;
+    startSecond();
+  });
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The current second starts again now (countdown chain reset).
+///        RTC_WRITE reports the error before the reset.
+///
+//////////////////////////////////////////////////////////////////////////////
+void RtcModel::resetCountdown() {
+  if (!_resetPending) { _errorAtReset = errorMicros(); }
+  _resetPending = true;
+  ++_generation;
+  startSecond();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Schedules an event within the current second. It is dropped if
+///        the countdown chain is reset before.
+///
+/// @param delay
+/// @param action
+//////////////////////////////////////////////////////////////////////////////
+void RtcModel::inSecond(uint64_t delay, Simulation::Action action) {
+  uint32_t generation = _generation;
+  _sim.after(delay, [this, generation, action] {
+    if (generation == _generation) { action(); }
+  });
+}
+
+void RtcModel::loadTimeRegisters() {
+  TimeCalc::DateTime t = TimeCalc::fromEpoch(_epoch);
+  _regs[SECONDS] = BCDConv::decToBcd(t.second);
+  _regs[MINUTES] = BCDConv::decToBcd(t.minute);
+  _regs[HOURS] = BCDConv::decToBcd(t.hour);
+  _regs[DAY] = dayOfWeek(t);
+  _regs[DATE] = BCDConv::decToBcd(t.day);
+  _regs[MONTH] = BCDConv::decToBcd(t.month);
+  _regs[YEAR] = BCDConv::decToBcd(t.year);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief First byte: register pointer, then the register values.
+///        The time registers are taken over at the end of the write.
+///
+/// @param data
+/// @param len
+//////////////////////////////////////////////////////////////////////////////
+void RtcModel::i2cWrite(const uint8_t *data, uint8_t len) {
+  if (len == 0) { return; }
+  _pointer = data[0] % _numRegs;
+  if (len == 1) { return; }
+
+  loadTimeRegisters();
+  bool timeWritten = false;
+  bool secondsWritten = false;
+  for (uint8_t i = 1; i < len; ++i) {
+    if (_pointer <= YEAR) { timeWritten = true; }
+    if (_pointer == SECONDS) { secondsWritten = true; }
+    _regs[_pointer] = data[i];
+    _pointer = (_pointer + 1) % _numRegs;
+  }
+  if (timeWritten) {
+    int64_t before = _resetPending ? _errorAtReset : errorMicros();   // Reset by an earlier write
+    _epoch = TimeCalc::toEpoch(TimeCalc::fromBcd(_regs[YEAR], _regs[MONTH] & CEN_MONTH_MASK, _regs[DATE],
+                                                 _regs[HOURS], _regs[MINUTES], _regs[SECONDS]));
+    if (secondsWritten && secondsWriteResets()) { resetCountdown(); }
+    _resetPending = false;
+    ++_timeWrites;
+    _sim.log("RTC_WRITE", "error_before_ms %.3f error_after_ms %.3f", before / 1000.0, errorMicros() / 1000.0);
+  }
+  written();
+}
+
+void RtcModel::i2cRead(uint8_t *data, uint8_t len) {
+  loadTimeRegisters();
+  while (len--) {
+    *data++ = _regs[_pointer];
+    _pointer = (_pointer + 1) % _numRegs;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief RTC time - true time.
+///
+/// @return int64_t   Microseconds
+//////////////////////////////////////////////////////////////////////////////
+int64_t RtcModel::errorMicros() const {
+  int64_t rtc = static_cast<int64_t>(_epoch) * SECOND + (static_cast<int64_t>(_sim.now()) - _secondStart);
+  int64_t trueTime = static_cast<int64_t>(_sim.trueEpoch()) * SECOND + _sim.now() % SECOND;
+  return rtc - trueTime;
+}
+}   // namespace Sim
@@ -0,0 +1,88 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file rtc_model.hpp
+/// @author Kai R.
+/// @brief Time keeping of the RTC models (ds3231_model, rv3028_model): time
+///        registers SECONDS ... YEAR (same layout on both chips), register
+///        pointer and the RTC second. The oscillator can deviate from the
+///        true time (drift in ppm), the calibration register of the chip
+///        corrects it (calibrationPpm()).
+///        resetCountdown() restarts the current second (countdown chain):
+///        the new second starts with the reset. The backend sets its pin at
+///        the start of every second (second()) and schedules the events
+///        within the second with inSecond(), which are dropped after a
+///        reset.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-01-21
+/// 32kHz output.
+///
+/// @date 2023-01-28
+/// Alarm 1 and 2, INT output.
+///
+/// @date 2023-02-11
+/// Split into the time keeping (RtcModel) and the chips (Ds3231Model, Rv3028Model).
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _RTC_MODEL_HPP_
+#define _RTC_MODEL_HPP_
+
+#include <Wire.h>
+#include "simulation.hpp"
+#include "timecalc.hpp"
+
+namespace Sim {
+class RtcModel : public Host::I2cDevice {
+public:
+  void i2cWrite(const uint8_t *, uint8_t) override;
+  void i2cRead(uint8_t *, uint8_t) override;
+
+  int64_t errorMicros(void) const;
+  uint32_t timeWrites(void) const { return _timeWrites; }
+
+protected:
+  static constexpr uint8_t MAX_REGS{0x40};
+  static constexpr uint8_t SECONDS{0x00};   // Time registers of both chips
+  static constexpr uint8_t DAY{0x03};
+  static constexpr uint8_t YEAR{0x06};
+  static constexpr double HZ_32K{32768};
+
+  RtcModel(Simulation &, uint8_t address, uint8_t numRegs, uint8_t pin, int64_t offsetMicros, double driftPpm);
+  virtual ~RtcModel() {}
+
+  Simulation &_sim;
+  uint8_t _pin;
+  uint8_t _regs[MAX_REGS];
+  uint32_t _epoch;   // RTC time of the current second (TimeCalc epoch)
+
+  double driftPpm(void) const { return _driftPpm + calibrationPpm(); }
+  void resetCountdown(void);
+  void inSecond(uint64_t delay, Simulation::Action);
+
+  virtual void second(uint64_t period) = 0;   // A new RTC second starts now
+  virtual void written(void) = 0;             // Registers written (after the time)
+  virtual bool secondsWriteResets(void) const = 0;
+  virtual double calibrationPpm(void) const = 0;
+  virtual uint8_t dayOfWeek(const TimeCalc::DateTime &t) const { return TimeCalc::dayOfWeek(t); }
+
+private:
+  uint8_t _numRegs;
+  double _driftPpm;
+  double _driftFraction{0};
+  uint8_t _pointer{0};
+  int64_t _secondStart;      // Virtual time at which the current second started
+  uint32_t _generation{0};   // Invalidates the scheduled second events after a reset of the countdown chain
+  uint32_t _timeWrites{0};
+  bool _resetPending{false};  // Reset before the time was written
+  int64_t _errorAtReset{0};
+
+  void startSecond(void);
+  void loadTimeRegisters(void);
+};
+}   // namespace Sim
+
+#endif
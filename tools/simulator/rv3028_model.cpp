@@ -0,0 +1,167 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file rv3028_model.cpp
+/// @author Kai R.
+/// @brief Model of the RV-3028-C7 RTC.
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include "rv3028_model.hpp"
+#include "RV3028Wire.h"
+
+namespace {
+constexpr uint8_t NUM_REGS{0x40};
+constexpr uint8_t STATUS_RESET{0x01};   // PORF
+constexpr uint8_t CLKOUT_RESET{0xC0};   // EEPROM default: CLKOE = 1, CLKSY = 1, 32.768 kHz
+constexpr uint8_t STATUS_UF{0x10};
+constexpr uint8_t STATUS_TF{0x08};
+constexpr uint8_t STATUS_AF{0x04};
+constexpr uint8_t CONTROL1_WADA{0x20};
+constexpr uint8_t CONTROL1_USEL{0x10};
+constexpr uint8_t CONTROL1_TE{0x04};
+constexpr uint8_t CONTROL1_TD{0x03};
+constexpr uint8_t TD_1HZ{0x02};
+constexpr uint8_t TD_1_60HZ{0x03};
+constexpr uint8_t CONTROL2_UIE{0x20};
+constexpr uint8_t CONTROL2_TIE{0x10};
+constexpr uint8_t CONTROL2_AIE{0x08};
+constexpr uint8_t CONTROL2_RESET{0x01};
+constexpr uint8_t CLKOUT_CLKOE{0x80};
+constexpr uint8_t CLKOUT_FD{0x07};
+constexpr uint8_t EE_CMD_UPDATE{0x11};
+constexpr uint8_t HOURS_MASK{0x3F};
+constexpr uint8_t WEEKDAY_MASK{0x07};
+constexpr uint8_t DAYS_PER_WEEK{7};
+constexpr uint64_t T_RTN{7813};        // Microseconds INT is LOW after a periodic time update
+constexpr double OFFSET_PPM{0.9537};   // Per offset step
+}   // namespace
+
+namespace Sim {
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The RTC starts with the power-on values and the EEPROM defaults.
+///
+/// @param sim
+/// @param intPin
+/// @param offsetMicros   RTC time - true time at the start
+/// @param driftPpm       The RTC second is longer by driftPpm (runs slow if > 0)
+//////////////////////////////////////////////////////////////////////////////
+Rv3028Model::Rv3028Model(Simulation &sim, uint8_t intPin, int64_t offsetMicros, double driftPpm)
+    : RtcModel(sim, RV3028::ADDR, NUM_REGS, intPin, offsetMicros, driftPpm) {
+  _regs[RV3028::STATUS] = STATUS_RESET;
+  _regs[RV3028::EE_CLKOUT] = CLKOUT_RESET;
+  updateClkout();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief A new RTC second starts now: timer, alarm and periodic time
+///        update. Not after a reset of the countdown chain.
+///
+//////////////////////////////////////////////////////////////////////////////
+void Rv3028Model::second(uint64_t) {
+  if (_reset) { return; }
+  TimeCalc::DateTime t = TimeCalc::fromEpoch(_epoch);
+  countTimer(t);
+  if (t.second == 0 && alarmMatches(t)) { _regs[RV3028::STATUS] |= STATUS_AF; }
+  if (t.second == 0 || !(_regs[RV3028::CONTROL1] & CONTROL1_USEL)) {
+    _regs[RV3028::STATUS] |= STATUS_UF;
+    if (_regs[RV3028::CONTROL2] & CONTROL2_UIE) {
+      _pulse = true;
+      inSecond(T_RTN, [this] {
+        _pulse = false;
+        setInt();
+      });
+    }
+  }
+  setInt();
+}
+
+void Rv3028Model::countTimer(const TimeCalc::DateTime &t) {
+  if (!_timerRunning) { return; }
+  uint8_t clock = _regs[RV3028::CONTROL1] & CONTROL1_TD;
+  if (clock != TD_1HZ && clock != TD_1_60HZ) {
+    if (!_warnedTimer) { fprintf(stderr, "RTC: timer clock TD = %u not simulated\n", clock); }
+    _warnedTimer = true;
+    return;
+  }
+  if (clock == TD_1_60HZ && t.second != 0) { return; }
+  if (_timerCount > 0) { --_timerCount; }
+  if (_timerCount == 0) {
+    _regs[RV3028::STATUS] |= STATUS_TF;
+    _regs[RV3028::CONTROL1] &= ~CONTROL1_TE;   // Single mode
+    _timerRunning = false;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The alarm matches at second 00 if every register without AE bit
+///        is equal to the time (WADA: date instead of weekday).
+///
+/// @param t   RTC time
+//////////////////////////////////////////////////////////////////////////////
+bool Rv3028Model::alarmMatches(const TimeCalc::DateTime &t) const {
+  const uint8_t minutes = _regs[RV3028::ALARM_MINUTES];
+  const uint8_t hours = _regs[RV3028::ALARM_HOURS];
+  const uint8_t dayDate = _regs[RV3028::ALARM_DAY_DATE];
+  if (!(minutes & RV3028::ALARM_MASK) && minutes != BCDConv::decToBcd(t.minute)) { return false; }
+  if (!(hours & RV3028::ALARM_MASK) && (hours & HOURS_MASK) != BCDConv::decToBcd(t.hour)) { return false; }
+  if (dayDate & RV3028::ALARM_MASK) { return true; }
+  if (_regs[RV3028::CONTROL1] & CONTROL1_WADA) { return (dayDate & HOURS_MASK) == BCDConv::decToBcd(t.day); }
+  return (dayDate & WEEKDAY_MASK) == dayOfWeek(t);
+}
+
+void Rv3028Model::setInt() {
+  uint8_t status = _regs[RV3028::STATUS];
+  uint8_t control2 = _regs[RV3028::CONTROL2];
+  bool alarm = ((control2 & CONTROL2_AIE) && (status & STATUS_AF)) ||
+               ((control2 & CONTROL2_TIE) && (status & STATUS_TF));
+  Host::setPin(_pin, !(_pulse || alarm));
+}
+
+void Rv3028Model::updateClkout() {
+  uint8_t clkout = _regs[RV3028::EE_CLKOUT];
+  if ((clkout & CLKOUT_CLKOE) && (clkout & CLKOUT_FD) && !_warnedClkout) {
+    _warnedClkout = true;
+    fprintf(stderr, "RTC: CLKOUT frequency FD = %u not simulated (only 32.768 kHz)\n", clkout & CLKOUT_FD);
+  }
+  bool on = (clkout & CLKOUT_CLKOE) && !(clkout & CLKOUT_FD);
+  Host::setT1Clock(on ? HZ_32K / (1 + driftPpm() * 1e-6) : 0);
+}
+
+double Rv3028Model::calibrationPpm() const {
+  int16_t offset = static_cast<int16_t>(_regs[RV3028::EE_OFFSET] << 1 | _regs[RV3028::EE_BACKUP] >> 7);
+  if (offset & 0x100) { offset -= 0x200; }   // 9 bit two's complement
+  return offset * OFFSET_PPM;
+}
+
+uint8_t Rv3028Model::dayOfWeek(const TimeCalc::DateTime &t) const { return TimeCalc::dayOfWeek(t) % DAYS_PER_WEEK; }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Reset of the prescaler, start of the countdown timer (TE 0 -> 1,
+///        the timer value is loaded), EEPROM update, INT and CLKOUT.
+///
+//////////////////////////////////////////////////////////////////////////////
+void Rv3028Model::written() {
+  if (_regs[RV3028::CONTROL2] & CONTROL2_RESET) {
+    _regs[RV3028::CONTROL2] &= ~CONTROL2_RESET;
+    _pulse = false;   // The end of the pulse was scheduled in the old second
+    _reset = true;
+    resetCountdown();
+    _reset = false;
+  }
+  bool te = _regs[RV3028::CONTROL1] & CONTROL1_TE;
+  if (te && !_timerRunning) {
+    _timerCount = (_regs[RV3028::TIMER_VALUE_1] & 0x0F) << 8 | _regs[RV3028::TIMER_VALUE_0];
+  }
+  _timerRunning = te;
+  if (_regs[RV3028::EE_COMMAND] == EE_CMD_UPDATE) {
+    _regs[RV3028::EE_COMMAND] = 0;
+    _sim.log("RTC_EEPROM", "clkout 0x%02x offset_ppm %.1f", _regs[RV3028::EE_CLKOUT], calibrationPpm());
+  }
+  setInt();
+  updateClkout();
+}
+}   // namespace Sim
@@ -0,0 +1,59 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file rv3028_model.hpp
+/// @author Kai R.
+/// @brief Model of the RV-3028-C7 RTC (build flag RTC_RV3028): time
+///        registers, alarm, countdown timer, status/control registers, INT
+///        output and CLKOUT.
+///        INT (open drain) is LOW for tRTN at every periodic time update
+///        (UIE, every second or with USEL every minute) and while an
+///        enabled flag (AF with AIE, TF with TIE) is set.
+///        The countdown timer counts with 1 Hz or 1/60 Hz at the start of
+///        the seconds (minutes) in single mode (TE is cleared at zero).
+///        Other timer clocks, repeat mode and clock frequencies are not
+///        simulated.
+///        Writing the seconds does not reset the prescaler, the RESET bit
+///        does (without a time update). CLKOUT at 32.768 kHz clocks Timer1
+///        (T1, Host::setT1Clock()). The offset (9 bit, 0.9537 ppm per step)
+///        changes the drift. An EEPROM update is logged (RTC_EEPROM), the
+///        EEPROM is ready at once.
+///
+/// @date 2023-02-11
+/// @version 1.0
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _RV3028_MODEL_HPP_
+#define _RV3028_MODEL_HPP_
+
+#include "rtc_model.hpp"
+
+namespace Sim {
+class Rv3028Model : public RtcModel {
+public:
+  Rv3028Model(Simulation &, uint8_t intPin, int64_t offsetMicros, double driftPpm);
+
+protected:
+  void second(uint64_t period) override;
+  void written(void) override;
+  bool secondsWriteResets(void) const override { return false; }
+  double calibrationPpm(void) const override;
+  uint8_t dayOfWeek(const TimeCalc::DateTime &t) const override;
+
+private:
+  bool _pulse{false};         // Periodic time update: INT LOW for tRTN
+  bool _reset{false};         // The countdown chain is reset, no time update
+  bool _timerRunning{false};
+  uint16_t _timerCount{0};
+  bool _warnedTimer{false};
+  bool _warnedClkout{false};
+
+  void setInt(void);
+  void countTimer(const TimeCalc::DateTime &);
+  bool alarmMatches(const TimeCalc::DateTime &) const;
+  void updateClkout(void);
+};
+}   // namespace Sim
+
+#endif
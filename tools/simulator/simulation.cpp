@@ -0,0 +1,264 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file simulation.cpp
+/// @author Kai R.
+/// @brief Discrete event simulation of the environment of the MCU.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-01-21
+/// Timer1 overflow wake-ups. The Timer0 overflow only wakes the MCU while TOIE0 is set.
+///
+/// @date 2023-02-04
+/// Supply voltage profile. I2C in the STATS lines. logStats() is public: the
+/// simulator writes the last (partial) interval at the end.
+///
+/// @date 2023-02-11
+/// Timer1 compare match B wakes the MCU from idle.
+///
+/// @date 2023-02-11
+/// Timer0 compare match A wakes the MCU from idle. The timer interrupts are executed at their time
+/// while the MCU is busy.
+///
+/// @date 2023-02-18
+/// boost_us in the STATS lines: awake time with a boosted CPU clock.
+///
+/// @date 2023-02-25
+/// Boosted time below CpuClock::MIN_BOOST_MV.
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdarg.h>
+#include <algorithm>
+#include <iterator>
+#include <avr/sleep.h>
+#include "cpuclock.hpp"
+#include "simulation.hpp"
+#include "timecalc.hpp"
+
+namespace {
+constexpr uint64_t WATCHDOG_TICK{16 * Sim::MILLISECOND};   // WDP = 0
+constexpr uint8_t WDP_LOW_MASK{0x07};
+}   // namespace
+
+namespace Sim {
+Simulation::Simulation(uint32_t startEpoch, uint32_t timer0Overflow)
+    : _startEpoch(startEpoch), _timer0Overflow(timer0Overflow) {}
+
+void Simulation::at(uint64_t time, Action action) { _events.push(Event{time, _sequence++, action}); }
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Supply voltage at the current time, interpolated from the profile.
+///
+/// @return double    V, Host::Machine::DEFAULT_VCC without a profile
+//////////////////////////////////////////////////////////////////////////////
+double Simulation::vcc() {
+  if (_vccProfile.empty()) { return DEFAULT_VCC; }
+  auto next = _vccProfile.lower_bound(now());
+  if (next == _vccProfile.begin()) { return next->second; }
+  auto prev = std::prev(next);
+  if (next == _vccProfile.end()) { return prev->second; }
+  double fraction = static_cast<double>(now() - prev->first) / (next->first - prev->first);
+  return prev->second + fraction * (next->second - prev->second);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Writes a line to the timeline: seconds since the start, true
+///        date-time, event and details.
+///
+/// @param event
+/// @param format   printf format of the details
+//////////////////////////////////////////////////////////////////////////////
+void Simulation::log(const char *event, const char *format, ...) {
+  if (!_timeline) { return; }
+  TimeCalc::DateTime t = TimeCalc::fromEpoch(trueEpoch());
+  fprintf(_timeline, "%14.6f 20%02u-%02u-%02u %02u:%02u:%02u %-13s ", now() / static_cast<double>(SECOND), t.year,
+          t.month, t.day, t.hour, t.minute, t.second, event);
+  va_list args;
+  va_start(args, format);
+  vfprintf(_timeline, format, args);
+  va_end(args);
+  fputc('\n', _timeline);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Every interval a STATS line with the values of the interval is
+///        written to the timeline (see logStats()).
+///
+/// @param interval   Microseconds, 0 = off
+//////////////////////////////////////////////////////////////////////////////
+void Simulation::setStatsInterval(uint64_t interval) {
+  _statsInterval = interval;
+  if (interval) { after(interval, [this] { statsTick(); }); }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Statistics including the time in the current mode.
+///
+/// @return Stats
+//////////////////////////////////////////////////////////////////////////////
+Stats Simulation::snapshot() {
+  setMode(_mode);
+  return _stats;
+}
+
+void Simulation::statsTick() {
+  logStats();
+  after(_statsInterval, [this] { statsTick(); });
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Writes a STATS line with the values since the last one. Nothing
+///        if there was one at the same time.
+///
+//////////////////////////////////////////////////////////////////////////////
+void Simulation::logStats() {
+  if (now() == _lastStatsTime) { return; }
+  _lastStatsTime = now();
+  Stats s = snapshot();
+  log("STATS", "awake_us %llu boost_us %llu idle_us %llu pwrdown_us %llu wakeups_idle %u wakeups_timer0 %u "
+               "wakeups_timer1 %u wakeups_pwrdown %u display_updates %u spi_bytes %u i2c_transfers %u i2c_bytes %u "
+               "serial_bytes %u",
+      static_cast<unsigned long long>(s.time[AWAKE] - _lastStats.time[AWAKE]),
+      static_cast<unsigned long long>(s.boostTime - _lastStats.boostTime),
+      static_cast<unsigned long long>(s.time[IDLE] - _lastStats.time[IDLE]),
+      static_cast<unsigned long long>(s.time[PWR_DOWN] - _lastStats.time[PWR_DOWN]),
+      s.wakeups[IDLE] - _lastStats.wakeups[IDLE], s.timerWakeups - _lastStats.timerWakeups,
+      s.timer1Wakeups - _lastStats.timer1Wakeups,
+      s.wakeups[PWR_DOWN] - _lastStats.wakeups[PWR_DOWN], s.displayUpdates - _lastStats.displayUpdates,
+      s.spiBytes - _lastStats.spiBytes, s.i2cTransfers - _lastStats.i2cTransfers, s.i2cBytes - _lastStats.i2cBytes,
+      s.serialBytes - _lastStats.serialBytes);
+  _lastStats = s;
+}
+
+void Simulation::setMode(Mode mode) {
+  _stats.time[_mode] += now() - _modeSince;
+  _modeSince = now();
+  _mode = mode;
+}
+
+void Simulation::runNext() {
+  Event e = _events.top();
+  _events.pop();
+  if (e.time > now()) { Host::setMicros(e.time); }
+  _dispatching = true;
+  e.action();
+  _dispatching = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The MCU is busy up to the given time. Events that occur in the
+///        meantime are executed, the timer interrupts (Timer0 compare A,
+///        Timer1) at their time, if the interrupts are enabled. Calls from
+///        an event (interrupt functions executed by an event) only advance
+///        the time. Awake time with a boosted clock is counted separately,
+///        and again if the supply voltage is below the 8 MHz limit.
+///
+/// @param until
+//////////////////////////////////////////////////////////////////////////////
+void Simulation::advance(uint64_t until) {
+  uint64_t from = now();
+  if (!_dispatching) {
+    checkWatchdog();
+    for (;;) {
+      uint64_t timer = std::min(Host::nextTimer0Interrupt(), Host::nextTimer1Interrupt());
+      bool event = !_events.empty() && _events.top().time <= until;
+      if (timer <= until && (!event || timer < _events.top().time)) {
+        Host::setMicros(timer);
+        Host::service();
+      } else if (event) {
+        runNext();
+      } else {
+        break;
+      }
+    }
+  }
+  if (until > now()) { Host::setMicros(until); }
+#ifdef F_CPU
+  if (_mode == AWAKE && Host::cpuHz() > F_CPU) {
+    _stats.boostTime += now() - from;
+    if (vcc() * 1000 < CpuClock::MIN_BOOST_MV) { _stats.lowVccBoostTime += now() - from; }
+  }
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The MCU sleeps. Events are executed until one of them sets an
+///        interrupt flag. In idle mode the interrupts of Timer0 (overflow
+///        of millis() if TOIE0 is set, compare match A) and of Timer1
+///        (external clock, overflow and compare match B, tools/host) also
+///        wake the MCU. The time in power down mode does not count for the
+///        timers (tools/host).
+///
+/// @param mode   SLEEP_MODE_IDLE or SLEEP_MODE_PWR_DOWN
+//////////////////////////////////////////////////////////////////////////////
+void Simulation::sleep(uint8_t mode) {
+  for (auto &listener : _sleepListeners) { listener(); }
+  checkWatchdog();
+  Mode m = (mode == SLEEP_MODE_PWR_DOWN) ? PWR_DOWN : IDLE;
+  setMode(m);
+  ++_stats.wakeups[m];
+  // Timer0 stops in power down mode (Host::setPowerDown()), the overflow is relative to its count.
+  uint64_t overflow = (TIMSK0 & _BV(TOIE0)) ? now() + _timer0Overflow - Host::getTimerMicros() % _timer0Overflow
+                                             : UINT64_MAX;
+  overflow = std::min(overflow, Host::nextTimer0Interrupt());
+  uint64_t overflow1 = Host::nextTimer1Interrupt();
+  while (!Host::pendingInterrupts()) {
+    uint64_t wakeup = overflow < overflow1 ? overflow : overflow1;
+    if (m == IDLE && wakeup != UINT64_MAX && (_events.empty() || _events.top().time > wakeup)) {
+      Host::setMicros(wakeup);   // Timer0 compare A, Timer1: sets the interrupt flag
+      ++(wakeup == overflow ? _stats.timerWakeups : _stats.timer1Wakeups);
+      break;
+    }
+    if (_events.empty()) { break; }
+    runNext();
+  }
+  setMode(AWAKE);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief The watchdog interrupt (buttons) runs as long as WDIE is set.
+///        The period is 16 ms * 2^WDP.
+///
+//////////////////////////////////////////////////////////////////////////////
+void Simulation::checkWatchdog() {
+  if (_watchdogRunning || !(WDTCSR & _BV(WDIE))) { return; }
+  _watchdogRunning = true;
+  uint8_t wdp = (WDTCSR & WDP_LOW_MASK) | ((WDTCSR & _BV(WDP3)) ? 0x08 : 0);
+  after(WATCHDOG_TICK << wdp, [this] { watchdogTick(); });
+}
+
+void Simulation::watchdogTick() {
+  _watchdogRunning = false;
+  if (WDTCSR & _BV(WDIE)) {
+    Host::raise(Host::IRQ_WDT);
+    checkWatchdog();
+  }
+}
+
+void Simulation::pinWritten(uint8_t pin, uint8_t level) {
+  for (auto &listener : _pinListeners) { listener(pin, level); }
+}
+
+void Simulation::analogWritten(uint8_t pin, int value) {
+  for (auto &listener : _pinListeners) { listener(pin, value > 0); }
+  for (auto &listener : _analogListeners) { listener(pin, value); }
+}
+
+void Simulation::i2cTransfer(uint8_t len) {
+  ++_stats.i2cTransfers;
+  _stats.i2cBytes += len;
+}
+
+void Simulation::spiTransfer(uint8_t data) {
+  ++_stats.spiBytes;
+  if (_spiListener) { _spiListener(data); }
+}
+
+void Simulation::serialWrite(uint8_t data) {
+  ++_stats.serialBytes;
+  if (_serialListener) { _serialListener(data); }
+}
+}   // namespace Sim
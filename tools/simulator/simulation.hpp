@@ -0,0 +1,143 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file simulation.hpp
+/// @author Kai R.
+/// @brief Discrete event simulation of the environment of the MCU.
+///        The models (RTC, DCF77 receiver, display, buttons) schedule their
+///        events on the virtual time axis. The firmware runs until it
+///        sleeps or needs time (Host::busy()), then the events up to the
+///        new time are executed. An event that sets an interrupt flag wakes
+///        the MCU.
+///
+///        Time spent awake is only the time the firmware waits (delay(),
+///        micros() polling, I2C, SPI, Serial). Computations take no time.
+///
+///        The supply voltage (ADC) is interpolated linearly between the
+///        points of a profile (addVccPoint()), before the first and after
+///        the last point it is constant.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-01-21
+/// Timer1 overflow interrupt (external clock) as wake-up source.
+///
+/// @date 2023-02-04
+/// Supply voltage profile. I2C transactions and bytes, analogWrite() listeners.
+///
+/// @date 2023-02-18
+/// Awake time with a boosted CPU clock (Stats::boostTime).
+///
+/// @date 2023-02-25
+/// Boosted time below the supply voltage for 8 MHz (Stats::lowVccBoostTime).
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SIMULATION_HPP_
+#define _SIMULATION_HPP_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+#include <map>
+#include <queue>
+#include <vector>
+#include <Arduino.h>
+
+namespace Sim {
+constexpr uint64_t SECOND{1000000};
+constexpr uint64_t MILLISECOND{1000};
+
+enum Mode : uint8_t { AWAKE, IDLE, PWR_DOWN, MODES };
+
+struct Stats {
+  uint64_t time[MODES];     // Microseconds in each mode
+  uint64_t boostTime;       // Microseconds awake with a CPU clock above F_CPU (CpuClock::boost())
+  uint64_t lowVccBoostTime; // Part of boostTime with a supply voltage below CpuClock::MIN_BOOST_MV
+  uint32_t wakeups[MODES];  // Wake-ups from IDLE and PWR_DOWN
+  uint32_t timerWakeups;    // Wake-ups from IDLE by Timer0: overflow (millis()), compare A (lib/serialtime)
+  uint32_t timer1Wakeups;   // Wake-ups from IDLE by Timer1: overflow, compare B (lib/timebase with RTC_TIMEBASE)
+  uint32_t displayUpdates;
+  uint32_t spiBytes;
+  uint32_t i2cTransfers;
+  uint32_t i2cBytes;        // Without the address bytes
+  uint32_t serialBytes;
+};
+
+class Simulation : public Host::Machine {
+public:
+  using Action = std::function<void()>;
+  using PinListener = std::function<void(uint8_t, uint8_t)>;
+  using AnalogListener = std::function<void(uint8_t, int)>;
+
+  Simulation(uint32_t startEpoch, uint32_t timer0Overflow);
+
+  uint64_t now(void) const { return Host::getMicros(); }
+  uint32_t trueEpoch(void) const { return _startEpoch + now() / SECOND; }
+  void at(uint64_t, Action);
+  void after(uint64_t delay, Action action) { at(now() + delay, action); }
+
+  void onPinWritten(PinListener listener) { _pinListeners.push_back(listener); }
+  void onAnalogWritten(AnalogListener listener) { _analogListeners.push_back(listener); }
+  void onSpi(std::function<void(uint8_t)> listener) { _spiListener = listener; }
+  void onSerial(std::function<void(uint8_t)> listener) { _serialListener = listener; }
+  void onSleep(Action listener) { _sleepListeners.push_back(listener); }
+
+  void setTimeline(FILE *file) { _timeline = file; }
+  void log(const char *event) { log(event, "%s", ""); }
+  void log(const char *event, const char *format, ...) __attribute__((format(printf, 3, 4)));
+  void setStatsInterval(uint64_t);
+  void logStats(void);
+  void addVccPoint(uint64_t time, double volts) { _vccProfile[time] = volts; }
+
+  Stats &stats(void) { return _stats; }
+  Stats snapshot(void);
+
+  // Host::Machine
+  void advance(uint64_t) override;
+  void sleep(uint8_t) override;
+  void pinWritten(uint8_t, uint8_t) override;
+  void analogWritten(uint8_t, int) override;
+  void spiTransfer(uint8_t) override;
+  void i2cTransfer(uint8_t) override;
+  void serialWrite(uint8_t) override;
+  double vcc(void) override;
+
+private:
+  struct Event {
+    uint64_t time;
+    uint64_t sequence;   // Events at the same time in the order of scheduling
+    Action action;
+    bool operator>(const Event &e) const { return time != e.time ? time > e.time : sequence > e.sequence; }
+  };
+
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event>> _events;
+  uint64_t _sequence{0};
+  bool _dispatching{false};
+  uint32_t _startEpoch;
+  uint32_t _timer0Overflow;
+  bool _watchdogRunning{false};
+  Mode _mode{AWAKE};
+  uint64_t _modeSince{0};
+  Stats _stats{};
+  Stats _lastStats{};
+  uint64_t _lastStatsTime{0};
+  uint64_t _statsInterval{0};
+  FILE *_timeline{nullptr};
+  std::vector<PinListener> _pinListeners;
+  std::vector<AnalogListener> _analogListeners;
+  std::vector<Action> _sleepListeners;
+  std::function<void(uint8_t)> _spiListener;
+  std::function<void(uint8_t)> _serialListener;
+  std::map<uint64_t, double> _vccProfile;   // Time -> supply voltage (V)
+
+  void runNext(void);
+  void checkWatchdog(void);
+  void watchdogTick(void);
+  void setMode(Mode);
+  void statsTick(void);
+};
+}   // namespace Sim
+
+#endif
@@ -0,0 +1,535 @@
+//////////////////////////////////////////////////////////////////////////////
+/// @file simulator.cpp
+/// @author Kai R.
+/// @brief Host tool: runs the unchanged firmware (src/main.cpp setup()/loop()
+///        and all libraries) in virtual time against models of the RTC, the
+///        DCF77 receiver, the display and the buttons. Days of device time
+///        take seconds, so power management strategies (receiver sleep time,
+///        timeouts, sleep modes) can be compared quantitatively.
+///
+///        Build:   pio run -e simulator
+///        Usage:   .pio/build/simulator/program [options]
+///          --days d               simulated time (default 1)
+///          --start "Y-M-D h:m:s"  true time at the start (default 2023-01-07 12:00:00)
+///          --rtc-offset ms        RTC time - true time at the start (default 0)
+///          --drift ppm            RTC second longer by ppm (default 0)
+///          --lock s               receiver lock time after switching on (default 60)
+///          --delay ms             receiver delay of the second marks (default 0)
+///          --spikes n             spikes per minute in the receiver output (default 0)
+///          --fading p             probability of a 5-30 s fading period per minute (default 0)
+///          --day-fading p         the same from 06:00 to 22:00 (default: --fading)
+///          --stuck p              probability that the receiver gives no pulses after switching on (default 0)
+///          --vcc h:V              supply voltage V at h hours, linear between the points (default 3.0 V)
+///          --seed n               random generator of the disturbances (default 1)
+///          --press t[+p]:dt|bl[:ms]  press a button at t seconds (every p seconds), default 200 ms
+///          --timer0 us            Timer0 overflow period = idle wake-up (default 2048: prescaler 8 at 1 MHz)
+///          --timeline file        timeline of the events ("-" = stdout)
+///          --display              every display update in the timeline
+///          --stats s              interval of the STATS lines in the timeline (default 3600, 0 = off)
+///          --serial file          bytes sent by Serial (trace channel, capture) or the time messages
+///                                 (SERIAL_TIME)
+///          --dcf77-out file       edges of the DCF77 output (DCF77_OUTPUT) in the capture format of
+///                                 lib/capture, decoded by tools/replay
+///
+///        Timeline: one line per event
+///          <seconds since start> <true date time> <event> <details>
+///          RECEIVER_ON, RECEIVER_OFF, RTC_WRITE, BACKLIGHT_ON, BACKLIGHT_OFF,
+///          RTC_EEPROM (RTC_RV3028), BUTTON, DISPLAY, DISPLAY_ON, DISPLAY_OFF and STATS (times, wake-ups and bus traffic of the
+///          interval, the last one at the end of the simulation). BACKLIGHT_ON is repeated with the new
+///          PWM duty cycle if the brightness changes. tools/energy_model.py evaluates the timeline.
+///
+///        DCF77_OUTPUT: the pulses at the output are compared with the RTC second (start of the
+///        pulse) and with 100/200 ms (width). The summary shows the largest deviations.
+///
+///        SERIAL_TIME: the line is sampled like a UART receiver (4800 baud, in the middle of the bits).
+///        The messages are checked (sync, checksum, time = RTC second at the start bit). The summary
+///        shows the largest deviations of the start bit and the PPS edge from the RTC second and of the
+///        edges of the line from the bit grid of their character. The interrupt latency of the MCU is
+///        not simulated.
+///
+/// @date 2023-01-07
+/// @version 1.0
+///
+/// @date 2023-01-28
+/// Time with the display off (night mode).
+///
+/// @date 2023-02-04
+/// --day-fading, --stuck, --vcc. I2C traffic, backlight duty cycle, STATS at the end.
+///
+/// @date 2023-02-11
+/// The RTC model follows the backend of the firmware: RV-3028 with RTC_RV3028, otherwise DS3231.
+/// DCF77 output: timing of the pulses, --dcf77-out.
+///
+/// @date 2023-02-11
+/// Serial time messages and PPS: decoding and timing.
+///
+/// @date 2023-02-18
+/// Awake time with the boosted CPU clock in the summary.
+///
+/// @date 2023-02-25
+/// Boosted time below the supply voltage for 8 MHz in the summary (must be 0).
+///
+/// @copyright Copyright (c) 2023
+///
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <Arduino.h>
+#include "display.hpp"
+#include "timecalc.hpp"
+#include "simulation.hpp"
+#include "dcf77_model.hpp"
+#include "dcf77out.hpp"
+#include "lcd_model.hpp"
+#include "serialtime.hpp"
+#ifdef RTC_RV3028
+#include "rv3028_model.hpp"
+#else
+#include "ds3231_model.hpp"
+#endif
+
+namespace {
+// Pins as in src/main.cpp
+constexpr uint8_t DCF77_PIN{2};
+constexpr uint8_t RTC_SQW_PIN{3};
+#if defined(DEV_BOARD)
+constexpr uint8_t DCF77_ON_OFF_PIN{6};
+#else
+constexpr uint8_t DCF77_ON_OFF_PIN{14};
+#endif
+
+constexpr uint32_t DEFAULT_PRESS_MS{200};
+
+struct Options {
+  double days{1};
+  TimeCalc::DateTime start{23, 1, 7, 12, 0, 0};
+  double rtcOffsetMs{0};
+  double driftPpm{0};
+  Sim::Dcf77Config dcf77{60, 0, 0, 0, -1, 0, 1};
+  uint32_t timer0{2048};
+  const char *timeline{nullptr};
+  bool display{false};
+  uint32_t statsInterval{3600};
+  const char *serial{nullptr};
+  const char *dcf77Out{nullptr};
+  std::vector<std::pair<double, double>> vcc;   // Hours, V
+};
+
+uint64_t backlightSince{0};
+uint64_t backlightOnTime{0};
+bool backlightOn{false};
+int backlightDuty{0};
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Phase of a time in the RTC second.
+///
+/// @param rtcMicros    RTC time in microseconds (whole seconds may be left out)
+/// @return int64_t     -0.5 ... 0.5 s
+//////////////////////////////////////////////////////////////////////////////
+int64_t secondPhase(int64_t rtcMicros) {
+  int64_t phase = ((rtcMicros % static_cast<int64_t>(Sim::SECOND)) + Sim::SECOND) % Sim::SECOND;
+  return phase >= static_cast<int64_t>(Sim::SECOND / 2) ? phase - Sim::SECOND : phase;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Pulses of the DCF77 output: start relative to the RTC second,
+///        width relative to 100/200 ms (true time). The edges are written
+///        in the capture format (varint of duration ms << 1 | level).
+///
+//////////////////////////////////////////////////////////////////////////////
+struct Dcf77OutMonitor {
+  FILE *file{nullptr};
+  bool level{false};
+  uint64_t riseAt{0};
+  uint64_t lastEdgeMs{0};
+  uint32_t pulses[2]{0, 0};   // 100 ms, 200 ms
+  uint32_t invalid{0};        // Neither 100 nor 200 ms (+- 20 ms)
+  int64_t maxStartError{0};   // Microseconds
+  int64_t maxWidthError{0};
+
+  void edge(Sim::Simulation &sim, int64_t rtcErrorMicros, bool high) {
+    if (high == level) { return; }
+    level = high;
+    uint64_t now = sim.now();
+    if (high) {
+      riseAt = now;
+      int64_t phase = secondPhase(static_cast<int64_t>(now % Sim::SECOND) + rtcErrorMicros);
+      maxStartError = std::max(maxStartError, std::abs(phase));
+    } else {
+      int64_t width = static_cast<int64_t>(now - riseAt);
+      int64_t nominal = width < static_cast<int64_t>(150 * Sim::MILLISECOND) ? 100 * Sim::MILLISECOND
+                                                                              : 200 * Sim::MILLISECOND;
+      int64_t error = std::abs(width - nominal);
+      if (error > static_cast<int64_t>(20 * Sim::MILLISECOND)) {
+        ++invalid;
+      } else {
+        ++pulses[nominal == static_cast<int64_t>(200 * Sim::MILLISECOND)];
+        maxWidthError = std::max(maxWidthError, error);
+      }
+    }
+    if (file) {
+      uint64_t ms = (now + Sim::MILLISECOND / 2) / Sim::MILLISECOND;
+      uint64_t value = ((ms - lastEdgeMs) << 1) | (high ? 1 : 0);
+      lastEdgeMs = ms;
+      while (value >= 0x80) {
+        fputc(static_cast<int>((value & 0x7F) | 0x80), file);
+        value >>= 7;
+      }
+      fputc(static_cast<int>(value), file);
+    }
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Time messages and PPS pulses (SERIAL_TIME). The TX line is sampled
+///        in the middle of the bits after a start bit, like a UART receiver.
+///        A message is valid if sync, stop bits and checksum are correct and
+///        its time is the RTC second in which its start bit begins.
+///
+//////////////////////////////////////////////////////////////////////////////
+struct SerialTimeMonitor {
+  static constexpr double BIT_MICROS{1e6 / SerialTime::BAUD_RATE};
+  static constexpr uint8_t BITS_PER_CHAR{10};
+
+  FILE *file{nullptr};
+  bool receiving{false};
+  uint64_t charStart{0};
+  uint8_t data{0};
+  bool framing{false};
+  int64_t messageRtc{0};   // RTC time at the start bit of the message
+  uint8_t message[SerialTime::MESSAGE_SIZE];
+  uint8_t count{0};
+  uint32_t messages{0};
+  uint32_t invalid{0};
+  int64_t maxStartError{0};   // Microseconds
+  double maxEdgeError{0};
+  uint32_t ppsPulses{0};
+  int64_t maxPpsError{0};
+  bool ppsHigh{false};
+
+  void tx(Sim::Simulation &sim, int64_t rtcMicros, bool high) {
+    if (receiving) {   // Edge within a character: distance to the bit grid
+      double offset = static_cast<double>(sim.now() - charStart) / BIT_MICROS;
+      maxEdgeError = std::max(maxEdgeError, std::abs(offset - static_cast<int>(offset + 0.5)) * BIT_MICROS);
+      return;
+    }
+    if (high) { return; }
+    receiving = true;
+    charStart = sim.now();
+    data = 0;
+    framing = false;
+    if (count == 0) {
+      messageRtc = rtcMicros;
+      maxStartError = std::max(maxStartError, std::abs(secondPhase(rtcMicros)));
+    }
+    for (uint8_t i = 0; i < BITS_PER_CHAR; ++i) {
+      sim.at(charStart + static_cast<uint64_t>((i + 0.5) * BIT_MICROS), [this, i] { sample(i); });
+    }
+  }
+
+  void sample(uint8_t i) {
+    bool level = Host::getPin(SerialTime::TX_PIN);
+    if (i == 0) {
+      framing = level;
+    } else if (i < BITS_PER_CHAR - 1) {
+      data |= level << (i - 1);
+    } else {
+      receiving = false;
+      received(framing || !level);
+    }
+  }
+
+  void received(bool error) {
+    if (file) { fputc(data, file); }
+    if (error || (count == 0 && data != SerialTime::SYNC)) {
+      ++invalid;
+      count = 0;
+      return;
+    }
+    message[count++] = data;
+    if (count < SerialTime::MESSAGE_SIZE) { return; }
+    count = 0;
+    uint8_t checksum = 0;
+    for (uint8_t i = 1; i < SerialTime::MESSAGE_SIZE - 1; ++i) { checksum ^= message[i]; }
+    uint32_t time = message[1] | (message[2] << 8) | (message[3] << 16) | (static_cast<uint32_t>(message[4]) << 24);
+    int64_t second = (messageRtc + static_cast<int64_t>(Sim::SECOND / 2)) / static_cast<int64_t>(Sim::SECOND);
+    if (checksum != message[SerialTime::MESSAGE_SIZE - 1] || time != second) {
+      ++invalid;
+    } else {
+      ++messages;
+    }
+  }
+
+  void pps(int64_t rtcMicros, bool high) {
+    if (high == ppsHigh) { return; }
+    ppsHigh = high;
+    if (!high) { return; }
+    ++ppsPulses;
+    maxPpsError = std::max(maxPpsError, std::abs(secondPhase(rtcMicros)));
+  }
+};
+
+void usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [--days d] [--start \"Y-M-D h:m:s\"] [--rtc-offset ms] [--drift ppm] [--lock s] [--delay ms]\n"
+          "       [--spikes n] [--fading p] [--day-fading p] [--stuck p] [--vcc h:V] [--seed n] [--press t[+p]:dt|bl[:ms]]\n"
+          "       [--timer0 us]\n"
+          "       [--timeline file] [--display] [--stats s] [--serial file] [--dcf77-out file]\n",
+          name);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// @brief Schedules a button press: t[+period]:dt|bl[:ms]
+///
+/// @param sim
+/// @param spec
+/// @return true    Valid
+//////////////////////////////////////////////////////////////////////////////
+bool schedulePress(Sim::Simulation &sim, const char *spec) {
+  double t = 0;
+  double period = 0;
+  char name[3] = "";
+  unsigned ms = DEFAULT_PRESS_MS;
+  if (sscanf(spec, "%lf+%lf:%2[a-z]:%u", &t, &period, name, &ms) < 3 &&
+      sscanf(spec, "%lf:%2[a-z]:%u", &t, name, &ms) < 2) {
+    return false;
+  }
+  uint8_t pin;
+  if (strcmp(name, "dt") == 0) {
+    pin = BUTTON_DT_PIN;
+  } else if (strcmp(name, "bl") == 0) {
+    pin = BUTTON_BL_PIN;
+  } else {
+    return false;
+  }
+  uint64_t at = static_cast<uint64_t>(t * Sim::SECOND);
+  uint64_t every = static_cast<uint64_t>(period * Sim::SECOND);
+  uint64_t length = ms * Sim::MILLISECOND;
+  std::string button(name);
+  // Each press schedules the next one.
+  auto press = std::make_shared<std::function<void(uint64_t)>>();
+  *press = [&sim, pin, length, every, button, press](uint64_t time) {
+    sim.at(time, [&sim, pin, length, every, button, press, time] {
+      sim.log("BUTTON", "%s pressed %u ms", button.c_str(), static_cast<unsigned>(length / Sim::MILLISECOND));
+      Host::setPin(pin, LOW);
+      sim.after(length, [pin] { Host::setPin(pin, HIGH); });
+      if (every) { (*press)(time + every); }
+    });
+  };
+  (*press)(at);
+  return true;
+}
+
+bool parseStart(const char *text, TimeCalc::DateTime &dt) {
+  unsigned y, mo, d, h, mi, s;
+  if (sscanf(text, "%u-%u-%u %u:%u:%u", &y, &mo, &d, &h, &mi, &s) != 6 || y < 2000 || y > 2099) { return false; }
+  dt = TimeCalc::DateTime{static_cast<uint8_t>(y - 2000), static_cast<uint8_t>(mo), static_cast<uint8_t>(d),
+                          static_cast<uint8_t>(h),        static_cast<uint8_t>(mi), static_cast<uint8_t>(s)};
+  return true;
+}
+
+void printDuration(const char *name, uint64_t micros, uint64_t total) {
+  printf("%-24s %12.1f s  %6.2f %%\n", name, micros / static_cast<double>(Sim::SECOND),
+         total ? 100.0 * micros / total : 0.0);
+}
+}   // namespace
+
+int main(int argc, char *argv[]) {
+  Options o;
+  std::vector<const char *> presses;
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    bool ok = true;
+    if (strcmp(arg, "--display") == 0) {
+      o.display = true;
+      continue;
+    }
+    if (!value) {
+      ok = false;
+    } else if (strcmp(arg, "--days") == 0) {
+      ok = sscanf(value, "%lf", &o.days) == 1;
+    } else if (strcmp(arg, "--start") == 0) {
+      ok = parseStart(value, o.start);
+    } else if (strcmp(arg, "--rtc-offset") == 0) {
+      ok = sscanf(value, "%lf", &o.rtcOffsetMs) == 1;
+    } else if (strcmp(arg, "--drift") == 0) {
+      ok = sscanf(value, "%lf", &o.driftPpm) == 1;
+    } else if (strcmp(arg, "--lock") == 0) {
+      ok = sscanf(value, "%u", &o.dcf77.lockSeconds) == 1;
+    } else if (strcmp(arg, "--delay") == 0) {
+      ok = sscanf(value, "%u", &o.dcf77.delayMs) == 1;
+    } else if (strcmp(arg, "--spikes") == 0) {
+      ok = sscanf(value, "%lf", &o.dcf77.spikes) == 1;
+    } else if (strcmp(arg, "--fading") == 0) {
+      ok = sscanf(value, "%lf", &o.dcf77.fading) == 1;
+    } else if (strcmp(arg, "--day-fading") == 0) {
+      ok = sscanf(value, "%lf", &o.dcf77.fadingDay) == 1;
+    } else if (strcmp(arg, "--stuck") == 0) {
+      ok = sscanf(value, "%lf", &o.dcf77.stuck) == 1;
+    } else if (strcmp(arg, "--vcc") == 0) {
+      double hours, volts;
+      ok = sscanf(value, "%lf:%lf", &hours, &volts) == 2 && hours >= 0 && volts > 0;
+      if (ok) { o.vcc.emplace_back(hours, volts); }
+    } else if (strcmp(arg, "--seed") == 0) {
+      ok = sscanf(value, "%u", &o.dcf77.seed) == 1;
+    } else if (strcmp(arg, "--press") == 0) {
+      presses.push_back(value);
+    } else if (strcmp(arg, "--timer0") == 0) {
+      ok = sscanf(value, "%u", &o.timer0) == 1 && o.timer0 > 0;
+    } else if (strcmp(arg, "--timeline") == 0) {
+      o.timeline = value;
+    } else if (strcmp(arg, "--stats") == 0) {
+      ok = sscanf(value, "%u", &o.statsInterval) == 1;
+    } else if (strcmp(arg, "--serial") == 0) {
+      o.serial = value;
+    } else if (strcmp(arg, "--dcf77-out") == 0) {
+      o.dcf77Out = value;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      usage(argv[0]);
+      return 2;
+    }
+    ++i;
+  }
+
+  FILE *timeline = nullptr;
+  if (o.timeline) {
+    timeline = strcmp(o.timeline, "-") == 0 ? stdout : fopen(o.timeline, "w");
+    if (!timeline) {
+      fprintf(stderr, "%s: cannot write\n", o.timeline);
+      return 1;
+    }
+  }
+  FILE *serial = o.serial ? fopen(o.serial, "wb") : nullptr;
+  if (o.serial && !serial) {
+    fprintf(stderr, "%s: cannot write\n", o.serial);
+    return 1;
+  }
+  Dcf77OutMonitor dcf77Out;
+  dcf77Out.file = o.dcf77Out ? fopen(o.dcf77Out, "wb") : nullptr;
+  if (o.dcf77Out && !dcf77Out.file) {
+    fprintf(stderr, "%s: cannot write\n", o.dcf77Out);
+    return 1;
+  }
+
+  uint32_t startEpoch = TimeCalc::toEpoch(o.start);
+  Sim::Simulation sim(startEpoch, o.timer0);
+  sim.setTimeline(timeline);
+  Host::setMachine(&sim);
+  Host::setPin(BUTTON_DT_PIN, HIGH);   // Released (pull-up)
+  Host::setPin(BUTTON_BL_PIN, HIGH);
+#ifdef RTC_RV3028
+  Sim::Rv3028Model rtc(sim, RTC_SQW_PIN, static_cast<int64_t>(o.rtcOffsetMs * Sim::MILLISECOND), o.driftPpm);
+#else
+  Sim::Ds3231Model rtc(sim, RTC_SQW_PIN, static_cast<int64_t>(o.rtcOffsetMs * Sim::MILLISECOND), o.driftPpm);
+#endif
+  Sim::Dcf77Model dcf77(sim, DCF77_PIN, DCF77_ON_OFF_PIN, o.dcf77);
+  Sim::LcdModel lcdModel(sim, SS, PIN_RS);
+  lcdModel.setLogging(o.display);
+  sim.onAnalogWritten([&sim](uint8_t pin, int duty) {
+    if (pin != PIN_BACKLIGHT || duty == backlightDuty) { return; }
+    backlightDuty = duty;
+    if (duty > 0) {
+      if (!backlightOn) { backlightSince = sim.now(); }
+      backlightOn = true;
+      sim.log("BACKLIGHT_ON", "duty %d", duty);
+    } else {
+      backlightOn = false;
+      backlightOnTime += sim.now() - backlightSince;
+      sim.log("BACKLIGHT_OFF");
+    }
+  });
+  if (serial) {
+    sim.onSerial([serial](uint8_t data) { fputc(data, serial); });
+  }
+  SerialTimeMonitor serialTime;
+#ifdef SERIAL_TIME
+  serialTime.file = serial;
+  sim.onPinWritten([&sim, &rtc, &serialTime](uint8_t pin, uint8_t level) {
+    if (pin != SerialTime::TX_PIN && pin != SerialTime::PPS_PIN) { return; }
+    int64_t rtcMicros =
+        static_cast<int64_t>(sim.trueEpoch()) * Sim::SECOND + sim.now() % Sim::SECOND + rtc.errorMicros();
+    if (pin == SerialTime::TX_PIN) {
+      serialTime.tx(sim, rtcMicros, level == HIGH);
+    } else {
+      serialTime.pps(rtcMicros, level == HIGH);
+    }
+  });
+#endif
+#ifdef DCF77_OUTPUT
+  sim.onPinWritten([&sim, &rtc, &dcf77Out](uint8_t pin, uint8_t level) {
+    if (pin == DCF77Out::PIN) { dcf77Out.edge(sim, rtc.errorMicros(), (level == HIGH) != DCF77Out::ACTIVE_LOW); }
+  });
+#endif
+  for (const char *spec : presses) {
+    if (!schedulePress(sim, spec)) {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  sim.setStatsInterval(static_cast<uint64_t>(o.statsInterval) * Sim::SECOND);
+  for (const auto &point : o.vcc) {
+    sim.addVccPoint(static_cast<uint64_t>(point.first * TimeCalc::SECONDS_PER_HOUR * Sim::SECOND), point.second);
+  }
+
+  auto wallStart = std::chrono::steady_clock::now();
+  uint64_t end = static_cast<uint64_t>(o.days * TimeCalc::SECONDS_PER_DAY * Sim::SECOND);
+  setup();
+  while (sim.now() < end) { loop(); }
+  if (o.statsInterval) { sim.logStats(); }
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+  Sim::Stats s = sim.snapshot();
+  uint64_t total = sim.now();
+  if (backlightOn) { backlightOnTime += total - backlightSince; }
+  TimeCalc::DateTime t = TimeCalc::fromEpoch(sim.trueEpoch());
+  printf("%-24s %12.1f s  until 20%02u-%02u-%02u %02u:%02u:%02u\n", "simulated", total / static_cast<double>(Sim::SECOND),
+         t.year, t.month, t.day, t.hour, t.minute, t.second);
+  printDuration("receiver on", dcf77.onTime(), total);
+  printf("%-24s %12u\n", "receiver switch-ons", dcf77.switchOns());
+  printf("%-24s %12u\n", "rtc writes", rtc.timeWrites());
+  printf("%-24s %12.3f ms\n", "rtc error at end", rtc.errorMicros() / 1000.0);
+  printf("%-24s %12u  \"%s\"\n", "display updates", s.displayUpdates, lcdModel.text());
+  printDuration("backlight on", backlightOnTime, total);
+  printDuration("display off", lcdModel.offTime(), total);
+  printDuration("awake", s.time[Sim::AWAKE], total);
+  printDuration("  boosted clock", s.boostTime, total);
+  printDuration("    below 2.7 V", s.lowVccBoostTime, total);
+  printDuration("idle", s.time[Sim::IDLE], total);
+  printDuration("power down", s.time[Sim::PWR_DOWN], total);
+  printf("%-24s %12u  (Timer0 %u, Timer1 %u)\n", "wake-ups idle", s.wakeups[Sim::IDLE],
+         s.timerWakeups, s.timer1Wakeups);
+  printf("%-24s %12u\n", "wake-ups power down", s.wakeups[Sim::PWR_DOWN]);
+  printf("%-24s %12u\n", "spi bytes", s.spiBytes);
+  printf("%-24s %12u  (%u transfers)\n", "i2c bytes", s.i2cBytes, s.i2cTransfers);
+  printf("%-24s %12u\n", "serial bytes", s.serialBytes);
+#ifdef DCF77_OUTPUT
+  printf("%-24s %12u  (100 ms %u, 200 ms %u, invalid %u)\n", "dcf77 out pulses",
+         dcf77Out.pulses[0] + dcf77Out.pulses[1] + dcf77Out.invalid, dcf77Out.pulses[0], dcf77Out.pulses[1],
+         dcf77Out.invalid);
+  printf("%-24s %12.3f ms  (start to RTC second)\n", "dcf77 out max start", dcf77Out.maxStartError / 1000.0);
+  printf("%-24s %12.3f ms  (width to 100/200 ms)\n", "dcf77 out max width", dcf77Out.maxWidthError / 1000.0);
+#endif
+#ifdef SERIAL_TIME
+  printf("%-24s %12u  (invalid %u)\n", "serial time messages", serialTime.messages, serialTime.invalid);
+  printf("%-24s %12.3f ms  (start bit to RTC second)\n", "serial time max start", serialTime.maxStartError / 1000.0);
+  printf("%-24s %12.3f ms  (edges to the bit grid)\n", "serial time max edge", serialTime.maxEdgeError / 1000.0);
+  printf("%-24s %12u\n", "pps pulses", serialTime.ppsPulses);
+  printf("%-24s %12.3f ms  (rising edge to RTC second)\n", "pps max start", serialTime.maxPpsError / 1000.0);
+#endif
+  printf("%-24s %12.2f s\n", "wall time", wall);
+
+  if (dcf77Out.file) { fclose(dcf77Out.file); }
+  if (serial) { fclose(serial); }
+  if (timeline && timeline != stdout) { fclose(timeline); }
+  return 0;
+}
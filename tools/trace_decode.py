@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""Decoder for the binary trace channel of the DCF77 clock (lib/trace).
+
+Reads the records from a serial port (requires pyserial) or from a file
+with the captured raw bytes and prints one line per record.
+
+Record (8 bytes): SYNC(0xA5) event arg value(lo,hi) time(lo,hi) checksum
+checksum = XOR of event ... time(hi). After a corrupted byte the decoder
+searches for the next SYNC byte with a valid checksum.
+
+Usage:
+    trace_decode.py /dev/ttyUSB0 [--baud 9600]
+    trace_decode.py capture.bin
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+SYNC = 0xA5
+RECORD_SIZE = 8
+MAX_SECONDS = 59   # DCF77Sequence in lib/dcf77/dcf77.hpp
+LEAP_SECOND = 60
+
+
+def bcd(value):
+    return (value >> 4) * 10 + (value & 0x0F)
+
+
+def signed16(value):
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def fmt_edge(arg, value):
+    return "%s after %u ms" % ("signal start" if arg else "signal end  ", value)
+
+
+def fmt_bit(arg, value):
+    return "second %2u bit %u" % (arg, value)
+
+
+def fmt_frame(arg, value):
+    if arg == MAX_SECONDS:
+        result = "complete"
+    elif arg == LEAP_SECOND:
+        result = "complete (leap second)"
+    else:
+        result = "error"
+    return "%s, %u seconds" % (result, value)
+
+
+def fmt_decode(arg, value):
+    return "%02u:%02u start bit %s time %s date %s" % (
+        bcd(value >> 8), bcd(value & 0xFF),
+        "ok" if arg & 1 else "ERR", "ok" if arg & 2 else "ERR", "ok" if arg & 4 else "ERR")
+
+
+def fmt_rtc_write(arg, value):
+    return "second %u set, offset before %d ms" % (arg, signed16(value))
+
+
+def fmt_rtc_phase(arg, value):
+    return "phase error %d us" % signed16(value)
+
+
+def fmt_rtc_time(arg, value):
+    return "%02u:%02u:%02u" % (bcd(value >> 8), bcd(value & 0xFF), bcd(arg))
+
+
+def fmt_lost(arg, value):
+    return "%u records lost" % value
+
+
+def fmt_stack(arg, value):
+    return "%u bytes never used by the stack" % value
+
+
+def fmt_threshold(arg, value):
+    return "short %u ms, long %u ms, minute %u ms" % (value >> 8, value & 0xFF, arg * 10)
+
+
+RECEIVER_OFF_REASONS = ("window end", "synchronized", "timeout", "verified")
+
+
+def fmt_receiver_off(arg, value):
+    reason = RECEIVER_OFF_REASONS[arg] if arg < len(RECEIVER_OFF_REASONS) else "reason %u" % arg
+    return "%s, on again in %u min" % (reason, value)
+
+
+def fmt_receiver_cycle(arg, value):
+    return "power-cycle, %s, %u s after the start of the attempt" % (
+        "no complete frames" if arg else "no second marks", value)
+
+
+POWER_LEVELS = ("normal", "saving", "critical")
+
+
+def fmt_power_level(arg, value):
+    level = POWER_LEVELS[arg] if arg < len(POWER_LEVELS) else "level %u" % arg
+    return "power level %s, VCC %u mV" % (level, value)
+
+
+def fmt_partial(arg, value):
+    fields = [name for i, name in enumerate(("minutes", "hours", "date")) if arg & (1 << i)]
+    return "RTC minute with %u seconds, fields %s%s" % (
+        value, " ".join(fields) if fields else "-", ", time assembled" if arg & 8 else "")
+
+
+VERIFY_RESULTS = ("RTC confirmed", "second marks missing", "minutes/hours differ", "phase error")
+
+
+def fmt_verify(arg, value):
+    result = VERIFY_RESULTS[arg] if arg < len(VERIFY_RESULTS) else "result %u" % arg
+    return "verify: %s, offset %d us" % (result, signed16(value))
+
+
+# Keep in sync with enum class Trace::Event (lib/trace/trace.hpp)
+EVENTS = {
+    1: ("EDGE", fmt_edge),
+    2: ("BIT", fmt_bit),
+    3: ("FRAME", fmt_frame),
+    4: ("DECODE", fmt_decode),
+    5: ("RTC_WRITE", fmt_rtc_write),
+    6: ("RTC_PHASE", fmt_rtc_phase),
+    7: ("RTC_TIME", fmt_rtc_time),
+    8: ("LOST", fmt_lost),
+    9: ("STACK", fmt_stack),
+    10: ("THRESHOLD", fmt_threshold),
+    11: ("RECEIVER_OFF", fmt_receiver_off),
+    12: ("RECEIVER_CYCLE", fmt_receiver_cycle),
+    13: ("POWER_LEVEL", fmt_power_level),
+    14: ("PARTIAL", fmt_partial),
+    15: ("VERIFY", fmt_verify),
+}
+
+
+class Decoder:
+    """Splits a byte stream into records and unwraps the 16 bit time."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.last_time = None
+        self.time = 0
+        self.skipped = 0
+
+    def feed(self, data):
+        self.buffer += data
+        while len(self.buffer) >= RECORD_SIZE:
+            if self.buffer[0] != SYNC or not self._checksum_ok():
+                del self.buffer[0]
+                self.skipped += 1
+                continue
+            event, arg, value, time = struct.unpack_from("<BBHH", self.buffer, 1)
+            del self.buffer[:RECORD_SIZE]
+            yield self._unwrap(time), event, arg, value
+
+    def _checksum_ok(self):
+        checksum = 0
+        for byte in self.buffer[1:RECORD_SIZE - 1]:
+            checksum ^= byte
+        return checksum == self.buffer[RECORD_SIZE - 1]
+
+    def _unwrap(self, time):
+        if self.last_time is not None:
+            self.time += (time - self.last_time) & 0xFFFF
+        else:
+            self.time = time
+        self.last_time = time
+        return self.time
+
+
+def format_record(time, event, arg, value):
+    name, fmt = EVENTS.get(event, ("EVENT_%u" % event, lambda a, v: "arg %u value %u" % (a, v)))
+    return "%10.3f %-9s %s" % (time / 1000.0, name, fmt(arg, value))
+
+
+def open_input(path, baud):
+    if os.path.isfile(path):
+        return open(path, "rb")
+    try:
+        import serial
+    except ImportError:
+        sys.exit("pyserial is required to read from a serial port")
+    return serial.Serial(path, baud, timeout=1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", help="serial port or file with raw trace bytes")
+    parser.add_argument("--baud", type=int, default=9600, help="baud rate (Trace::BAUD_RATE)")
+    args = parser.parse_args()
+
+    decoder = Decoder()
+    with open_input(args.input, args.baud) as stream:
+        try:
+            while True:
+                data = stream.read(64)
+                if not data:
+                    if os.path.isfile(args.input):
+                        break
+                    continue
+                for record in decoder.feed(data):
+                    print(format_record(*record), flush=True)
+        except KeyboardInterrupt:
+            pass
+    if decoder.skipped:
+        print("%u bytes skipped (resync)" % decoder.skipped, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()